@@ -0,0 +1,305 @@
+#include "Advisor.h"
+#include "Event.h"
+#include "Link.h"
+#include "ReducedLoad.h"
+#include "Topology.h"
+#include "TopologyGenerator.h"
+
+#include "cxxopts.hpp"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Microbenchmarks of the primitives on the hot path of the simulation.
+ *
+ * Each benchmark is repeated until it has run for at least --min-time
+ * seconds, and one line per benchmark is written as CSV (name, nanoseconds
+ * per operation, number of operations) or JSON lines.
+ *
+ * The reduced load approximation of a 500-node network must also converge
+ * within --reduced-load-limit milliseconds, or the program exits with 2.
+ */
+
+namespace {
+/* Keeps results alive so that the compiler does not remove the work */
+volatile unsigned long sink;
+
+struct Options {
+    double min_time;
+    std::string filter;
+    bool json;
+    double reduced_load_limit;
+};
+
+/**
+ * Runs `op' in batches of growing size until the time limit is reached and
+ * reports the time per call.
+ *
+ * \return the nanoseconds per call, or 0 if the benchmark was filtered out.
+ */
+double
+run(const Options& options, const std::string& name,
+    const std::function<void(unsigned long)>& op) {
+    if (name.find(options.filter) == std::string::npos) {
+        return 0;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    unsigned long iterations = 1;
+    double seconds = 0;
+    while (true) {
+        const auto start = Clock::now();
+        op(iterations);
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= options.min_time || iterations >= 1ul << 40) {
+            break;
+        }
+        // Aim a bit past the limit to avoid another round
+        const double scale = seconds > 0
+            ? 1.5 * options.min_time / seconds
+            : 100;
+        iterations *= std::min(std::max(scale, 2.0), 100.0);
+    }
+
+    const double ns = seconds * 1e9 / iterations;
+    if (options.json) {
+        std::cout << "{\"name\": \"" << name << "\", \"ns_per_op\": " << ns
+            << ", \"iterations\": " << iterations << "}" << std::endl;
+    }
+    else {
+        std::cout << name << "," << ns << "," << iterations << std::endl;
+    }
+    return ns;
+}
+
+/**
+ * Locks each wavelength of each link with the given probability.
+ */
+void
+occupy(Advisor::Graph& g, const double occupancy, std::mt19937& rgen) {
+    std::bernoulli_distribution busy{occupancy};
+    for (auto e : boost::make_iterator_range(boost::edges(g))) {
+        Link& link = g[e];
+        for (const auto wl : Link::Wavelengths{link.wavelengths()}) {
+            if (busy(rgen)) {
+                link.lock(wl);
+            }
+        }
+    }
+}
+
+void
+bench_link(const Options& options) {
+    for (const unsigned w : {8u, 64u}) {
+        const std::string suffix = "/W=" + std::to_string(w);
+        Link link{w};
+        for (unsigned wl = 1; wl <= w; wl += 2) {
+            link.lock(wl);
+        }
+
+        run(options, "link_can_use" + suffix, [&](unsigned long n) {
+            unsigned long usable = 0;
+            for (unsigned long i = 0; i < n; i++) {
+                usable += link.can_use(i % w + 1);
+            }
+            sink = usable;
+        });
+        run(options, "link_lock_release" + suffix, [&](unsigned long n) {
+            for (unsigned long i = 0; i < n; i++) {
+                // Only the even wavelengths are free
+                const Link::wavelength_t wl = 2 * (i % (w / 2)) + 2;
+                link.lock(wl);
+                link.release(wl);
+            }
+        });
+        run(options, "link_available_wavelengths" + suffix,
+            [&](unsigned long n) {
+                unsigned long total = 0;
+                for (unsigned long i = 0; i < n; i++) {
+                    total += link.available_wavelengths().size();
+                }
+                sink = total;
+            });
+    }
+}
+
+void
+bench_path_between(const Options& options) {
+    const char* samples[] = {"two_nodes", "ten_nodes", "sample"};
+    for (const char* sample : samples) {
+        Topology topology;
+        const std::string filename =
+            std::string{SAMPLES_DIR} + "/" + sample + ".txt";
+        if (!topology.load(filename)) {
+            std::cerr << "Error reading " << topology.error() << std::endl;
+            continue;
+        }
+
+        for (const double occupancy : {0.0, 0.5, 0.9}) {
+            std::mt19937 rgen{1};
+            Advisor::Graph g = topology.make_graph(8, false);
+            occupy(g, occupancy, rgen);
+            Advisor advisor{g, 5, 1, 1};
+
+            // The same pairs in every batch
+            std::vector<std::pair<Advisor::vertex_t, Advisor::vertex_t>> pairs;
+            for (unsigned i = 0; i < 1024; i++) {
+                pairs.push_back(advisor.get_nodes());
+            }
+
+            const std::string name = std::string{"path_between/"} + sample
+                + "/occupancy=" + std::to_string(occupancy).substr(0, 3);
+            run(options, name, [&](unsigned long n) {
+                unsigned long found = 0;
+                for (unsigned long i = 0; i < n; i++) {
+                    const auto& p = pairs[i % pairs.size()];
+                    found += advisor.path_between(p.first, p.second).second;
+                }
+                sink = found;
+            });
+        }
+    }
+}
+
+/**
+ * Solves the reduced load approximation of a random network with 500 nodes
+ * and 1000 links of 16 wavelengths, at a light and a heavy load.
+ *
+ * \return false if any solution took longer than the limit.
+ */
+bool
+bench_reduced_load(const Options& options) {
+    TopologyGenerator generator{TopologyGenerator::ERDOS_RENYI, 500, 1, 1};
+    generator.set_edges(1000);
+    std::vector<std::uint32_t> endpoints;
+    generator.generate(endpoints);
+    Topology topology;
+    topology.assign(std::move(endpoints));
+    const Advisor::Graph g = topology.make_graph(16, false);
+
+    bool fast_enough = true;
+    const std::pair<ReducedLoad::Model, const char*> models[] = {
+        {ReducedLoad::CONVERSION, "conversion"},
+        {ReducedLoad::CONTINUITY, "continuity"}};
+    for (const auto& model : models) {
+        ReducedLoad rl{g, model.first};
+        for (const double lambda : {1000.0, 5000.0}) {
+            const std::string name = std::string{"reduced_load/"}
+                + model.second + "/V=500/lambda="
+                + std::to_string(static_cast<int>(lambda));
+            const double ns = run(options, name, [&](unsigned long n) {
+                double total = 0;
+                for (unsigned long i = 0; i < n; i++) {
+                    total += rl.solve(lambda, 1).blocking;
+                }
+                sink = total;
+            });
+            if (ns > options.reduced_load_limit * 1e6) {
+                std::cerr << name << " took " << ns / 1e6 << " ms, more than "
+                    << options.reduced_load_limit << " ms" << std::endl;
+                fast_enough = false;
+            }
+        }
+    }
+    return fast_enough;
+}
+
+void
+bench_random(const Options& options) {
+    Advisor::Graph g;
+    for (unsigned v = 0; v < 9; v++) {
+        boost::add_edge(v, v + 1, Link(8), g);
+    }
+    Advisor advisor{g, 5, 1, 1};
+
+    run(options, "get_nodes", [&](unsigned long n) {
+        unsigned long total = 0;
+        for (unsigned long i = 0; i < n; i++) {
+            total += advisor.get_nodes().first;
+        }
+        sink = total;
+    });
+    run(options, "get_arrival", [&](unsigned long n) {
+        double total = 0;
+        for (unsigned long i = 0; i < n; i++) {
+            total += advisor.get_arrival();
+        }
+        sink = total;
+    });
+    run(options, "get_duration", [&](unsigned long n) {
+        double total = 0;
+        for (unsigned long i = 0; i < n; i++) {
+            total += advisor.get_duration();
+        }
+        sink = total;
+    });
+}
+
+void
+bench_event_queue(const Options& options) {
+    for (const unsigned size : {16u, 1024u, 65536u}) {
+        std::mt19937 rgen{1};
+        std::exponential_distribution<double> delay{1};
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> pq;
+        for (unsigned i = 0; i < size; i++) {
+            pq.push(Event{Event::END, delay(rgen)});
+        }
+
+        // One pop and one push at a later time, as in the simulation
+        run(options, "event_queue_pop_push/size=" + std::to_string(size),
+            [&](unsigned long n) {
+                for (unsigned long i = 0; i < n; i++) {
+                    const double now = pq.top().time;
+                    pq.pop();
+                    pq.push(Event{Event::END, now + delay(rgen)});
+                }
+            });
+    }
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    Options bench_options{0.2, "", false, 200};
+    bool help = false;
+
+    cxxopts::Options options{argv[0], ""};
+    options.add_options()
+        ("min-time", "Minimum time to run each benchmark in seconds",
+         cxxopts::value(bench_options.min_time))
+        ("filter", "Only run benchmarks whose name contains this",
+         cxxopts::value(bench_options.filter))
+        ("json", "Write JSON lines instead of CSV",
+         cxxopts::value(bench_options.json))
+        ("reduced-load-limit", "Longest time in milliseconds the reduced "
+         "load approximation may take to converge",
+         cxxopts::value(bench_options.reduced_load_limit))
+        ("h,help", "Show this help",
+         cxxopts::value(help));
+    options.parse(argc, argv);
+
+    if (help) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    if (!bench_options.json) {
+        std::cout << "name,ns_per_op,iterations" << std::endl;
+    }
+    bench_link(bench_options);
+    bench_path_between(bench_options);
+    bench_random(bench_options);
+    bench_event_queue(bench_options);
+    if (!bench_reduced_load(bench_options)) {
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,312 @@
+#include "Advisor.h"
+#include "Simulator.h"
+#include "Topology.h"
+#include "TopologyGenerator.h"
+
+#include "cxxopts.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * End-to-end scaling benchmark.
+ *
+ * Runs a full simulation for every combination of network size, number of
+ * wavelengths and arrival rate, each in its own process so that its peak
+ * memory can be measured, and writes one CSV line per combination. With
+ * --compare, the results are compared with a baseline written earlier and
+ * the combinations whose throughput dropped by more than --threshold are
+ * reported.
+ */
+
+namespace {
+const char* HEADER = "nodes,edges,wavelengths,lambda,connections,events,"
+    "generate_s,graph_s,simulate_s,events_per_s,peak_rss_kb,blocking,status";
+
+struct Point {
+    unsigned nodes;
+    unsigned wavelengths;
+    double lambda;
+};
+
+double
+seconds_since(const std::chrono::steady_clock::time_point& start) {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+/**
+ * Runs one combination and writes the CSV fields up to events_per_s, a `|'
+ * and the blocking probability to `fd'. Runs in the child process.
+ */
+void
+run_point(const Point& p, const unsigned connections, const int fd) {
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+    // Random networks with an average degree of 4
+    TopologyGenerator generator{TopologyGenerator::ERDOS_RENYI, p.nodes, 1, 1};
+    const unsigned long max_edges = p.nodes * (p.nodes - 1ul) / 2;
+    generator.set_edges(std::min(2ul * p.nodes, max_edges));
+    std::vector<std::uint32_t> endpoints;
+    generator.generate(endpoints);
+    Topology topology;
+    topology.assign(std::move(endpoints));
+    const double generate_s = seconds_since(start);
+
+    start = Clock::now();
+    Advisor::Graph graph = topology.make_graph(p.wavelengths, false);
+    Advisor advisor{graph, p.lambda, 1, 1};
+    const double graph_s = seconds_since(start);
+
+    start = Clock::now();
+    Simulator simulator{advisor, connections};
+    const Simulator::Result result = simulator.run();
+    const double simulate_s = seconds_since(start);
+
+    std::ostringstream oss;
+    oss << p.nodes << ',' << topology.num_edges() << ',' << p.wavelengths
+        << ',' << p.lambda << ',' << result.connections << ','
+        << result.events << ',' << generate_s << ',' << graph_s << ','
+        << simulate_s << ',' << result.events / simulate_s << '|'
+        << result.blocking();
+    const std::string line = oss.str();
+    if (::write(fd, line.data(), line.size()) < 0) {
+        std::_Exit(1);
+    }
+}
+
+/**
+ * Runs one combination in a child process.
+ *
+ * \return the CSV line of the combination.
+ */
+std::string
+measure(const Point& p, const unsigned connections,
+        const unsigned time_limit) {
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return "";
+    }
+    std::cout.flush();
+
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        ::close(fds[0]);
+        ::alarm(time_limit);
+        run_point(p, connections, fds[1]);
+        ::close(fds[1]);
+        std::_Exit(0);
+    }
+    ::close(fds[1]);
+
+    std::string output;
+    char buffer[256];
+    ssize_t n;
+    while ((n = ::read(fds[0], buffer, sizeof(buffer))) > 0) {
+        output.append(buffer, n);
+    }
+    ::close(fds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    ::wait4(pid, &status, 0, &usage);
+
+    std::ostringstream oss;
+    const std::size_t bar = output.find('|');
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0
+            && bar != std::string::npos) {
+        oss << output.substr(0, bar) << ',' << usage.ru_maxrss << ','
+            << output.substr(bar + 1) << ",ok";
+    }
+    else {
+        const bool timeout = WIFSIGNALED(status)
+            && WTERMSIG(status) == SIGALRM;
+        oss << p.nodes << ",," << p.wavelengths << ',' << p.lambda
+            << ",,,,,,," << usage.ru_maxrss << ",,"
+            << (timeout ? "timeout" : "failed");
+    }
+    return oss.str();
+}
+
+std::vector<std::string>
+split(const std::string& s, const char delimiter) {
+    std::vector<std::string> fields;
+    std::istringstream iss{s};
+    std::string field;
+    while (std::getline(iss, field, delimiter)) {
+        fields.push_back(field);
+    }
+    if (!s.empty() && s.back() == delimiter) {
+        fields.push_back("");
+    }
+    return fields;
+}
+
+template<typename T>
+std::vector<T>
+parse_list(const std::string& s) {
+    std::vector<T> values;
+    for (const std::string& field : split(s, ',')) {
+        std::istringstream iss{field};
+        T value;
+        if (iss >> value) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+using Key = std::tuple<std::string, std::string, std::string>;
+
+/**
+ * Reads events/s (or -1 if the point did not finish) by nodes, wavelengths
+ * and lambda.
+ */
+bool
+read_results(const std::string& filename, std::map<Key, double>& results) {
+    std::ifstream ifs{filename};
+    std::string line;
+    if (!std::getline(ifs, line) || line != HEADER) {
+        return false;
+    }
+    while (std::getline(ifs, line)) {
+        const auto f = split(line, ',');
+        if (f.size() != 13) {
+            return false;
+        }
+        const Key key{f[0], f[2], f[3]};
+        results[key] = f[12] == "ok" ? std::stod(f[9]) : -1;
+    }
+    return true;
+}
+
+/**
+ * Prints the change in throughput of every combination in both files.
+ *
+ * \return the number of combinations slower than the threshold.
+ */
+unsigned
+compare(const std::map<Key, double>& baseline,
+        const std::map<Key, double>& current,
+        const double threshold) {
+    unsigned slower = 0;
+    for (const auto& entry : current) {
+        const auto it = baseline.find(entry.first);
+        if (it == baseline.end()) {
+            continue;
+        }
+        const double before = it->second;
+        const double after = entry.second;
+
+        std::cout << "nodes=" << std::get<0>(entry.first)
+            << " wavelengths=" << std::get<1>(entry.first)
+            << " lambda=" << std::get<2>(entry.first) << ": ";
+        if (after < 0 && before >= 0) {
+            std::cout << "did not finish  SLOWER" << std::endl;
+            slower++;
+            continue;
+        }
+        if (before < 0 || after < 0) {
+            std::cout << "did not finish" << std::endl;
+            continue;
+        }
+
+        const double change = after / before - 1;
+        std::cout << before << " -> " << after << " events/s ("
+            << (change >= 0 ? "+" : "") << change * 100 << " %)";
+        if (change < -threshold) {
+            std::cout << "  SLOWER";
+            slower++;
+        }
+        std::cout << std::endl;
+    }
+    return slower;
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    std::string nodes_list = "10,100,1000,10000,100000";
+    std::string wavelengths_list = "4,16,64,320";
+    std::string lambda_list = "5,50";
+    unsigned connections = 2000;
+    unsigned time_limit = 60;
+    std::string output;
+    std::string baseline;
+    double threshold = 0.25;
+    bool help = false;
+
+    cxxopts::Options options{argv[0], ""};
+    options.add_options()
+        ("nodes", "Comma-separated network sizes",
+         cxxopts::value(nodes_list))
+        ("wavelengths", "Comma-separated numbers of wavelengths",
+         cxxopts::value(wavelengths_list))
+        ("lambda", "Comma-separated arrival rates (mean duration is 1)",
+         cxxopts::value(lambda_list))
+        ("t,total", "Connections to observe in each simulation",
+         cxxopts::value(connections))
+        ("time-limit", "Seconds before a simulation is abandoned",
+         cxxopts::value(time_limit))
+        ("o,output", "Write the results to this file instead of the "
+         "standard output",
+         cxxopts::value(output))
+        ("compare", "Compare the results with this baseline",
+         cxxopts::value(baseline))
+        ("threshold", "Relative drop in events/s reported as a slowdown",
+         cxxopts::value(threshold))
+        ("h,help", "Show this help",
+         cxxopts::value(help));
+    options.parse(argc, argv);
+
+    if (help) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    std::ofstream ofs;
+    if (!output.empty()) {
+        ofs.open(output);
+    }
+    std::ostream& os = output.empty() ? std::cout : ofs;
+
+    os << HEADER << std::endl;
+    for (const unsigned nodes : parse_list<unsigned>(nodes_list)) {
+        for (const unsigned w : parse_list<unsigned>(wavelengths_list)) {
+            for (const double lambda : parse_list<double>(lambda_list)) {
+                const Point p{nodes, w, lambda};
+                os << measure(p, connections, time_limit) << std::endl;
+            }
+        }
+    }
+
+    if (baseline.empty()) {
+        return 0;
+    }
+    if (output.empty()) {
+        std::cerr << "--compare needs --output" << std::endl;
+        return 1;
+    }
+    ofs.close();
+
+    std::map<Key, double> before, after;
+    if (!read_results(baseline, before) || !read_results(output, after)) {
+        std::cerr << "Error reading results" << std::endl;
+        return 1;
+    }
+    return compare(before, after, threshold) == 0 ? 0 : 2;
+}
@@ -0,0 +1,109 @@
+#include "Topology.h"
+#include "TopologyGenerator.h"
+
+#include "cxxopts.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Generates the edges of a network for the simulator.
+ *
+ * Usage:
+ *   make-topology <model> <num vertices> [options]
+ */
+int
+main(int argc, char* argv[]) {
+    unsigned long edges = 0;
+    double alpha = 0.4;
+    double beta = 0.1;
+    unsigned rows = 0;
+    unsigned attachments = 2;
+    std::uint64_t seed = 0;
+    unsigned threads = 0;
+    std::string output;
+    bool binary = false;
+
+    bool help = false;
+
+    cxxopts::Options options{argv[0], " <model> <num vertices>\n\n"
+        "Models: erdos-renyi, waxman, grid, torus, ring, bus, preferential"};
+    options.add_options()
+        ("e,edges", "Number of edges (erdos-renyi)",
+         cxxopts::value(edges))
+        ("alpha", "Distance scale (waxman)",
+         cxxopts::value(alpha))
+        ("beta", "Link density (waxman)",
+         cxxopts::value(beta))
+        ("rows", "Number of rows (grid, torus; 0 for the squarest)",
+         cxxopts::value(rows))
+        ("m,attachments", "Edges added with each node (preferential)",
+         cxxopts::value(attachments))
+        ("s,seed", "Random seed (0 picks a random seed)",
+         cxxopts::value(seed))
+        ("threads", "Number of threads (0 for one per core)",
+         cxxopts::value(threads))
+        ("o,output", "Output file instead of the standard output",
+         cxxopts::value(output))
+        ("b,binary", "Write the binary format (requires --output)",
+         cxxopts::value(binary))
+        ("h,help", "Show this help",
+         cxxopts::value(help));
+    options.parse(argc, argv);
+
+    if (help) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    TopologyGenerator::Model model;
+    if (argc < 3 || !TopologyGenerator::parse_model(argv[1], model)) {
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+    if (binary && output.empty()) {
+        std::cerr << "The binary format needs --output" << std::endl;
+        return 1;
+    }
+    if (seed == 0) {
+        seed = std::chrono::system_clock::now().time_since_epoch().count();
+        std::cerr << "seed: " << seed << std::endl;
+    }
+
+    TopologyGenerator generator{model,
+                                static_cast<unsigned>(std::stoul(argv[2])),
+                                seed, threads};
+    generator.set_edges(edges);
+    generator.set_waxman(alpha, beta);
+    generator.set_rows(rows);
+    generator.set_attachments(attachments);
+
+    std::vector<std::uint32_t> endpoints;
+    if (!generator.generate(endpoints)) {
+        std::cerr << "Error: " << generator.error() << std::endl;
+        return 1;
+    }
+    Topology topology;
+    topology.assign(std::move(endpoints));
+
+    bool ok;
+    if (binary) {
+        ok = topology.write_binary(output);
+    }
+    else if (!output.empty()) {
+        std::ofstream ofs{output, std::ios::out | std::ios::binary};
+        ok = topology.write_text(ofs);
+    }
+    else {
+        ok = topology.write_text(std::cout);
+    }
+    if (!ok) {
+        std::cerr << "Error writing the topology" << std::endl;
+        return 1;
+    }
+    return 0;
+}
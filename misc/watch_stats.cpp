@@ -0,0 +1,112 @@
+#include "StatsPage.h"
+
+#include "cxxopts.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <signal.h>
+
+/*
+ * Shows the progress that a simulation run with --stats-page publishes,
+ * refreshing the screen like top.
+ *
+ * Usage:
+ *   watch-stats <stats page> [options]
+ */
+namespace {
+/**
+ * \return true if the process exists.
+ */
+bool
+running(const std::uint32_t pid) {
+    return pid != 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+void
+show(std::ostream& os, const StatsPage::Snapshot& s, const bool stalled) {
+    const char* state = s.finished ? "finished"
+        : !running(s.pid) ? "not running"
+        : stalled ? "stalled"
+        : s.warming_up ? "warming up"
+        : "measuring";
+
+    os << "pid: " << s.pid << " (" << state << ")" << std::endl;
+    os << "replication: " << s.replication + 1 << " of " << s.replications
+        << std::endl;
+    os << "elapsed: " << std::fixed << std::setprecision(1) << s.elapsed
+        << " s" << std::endl;
+    os << "simulated time: " << std::setprecision(3) << s.now << std::endl;
+    os << std::defaultfloat << std::setprecision(6);
+    os << "events: " << s.events << " (" << s.events_per_second
+        << " per second)" << std::endl;
+    os << "connections: " << s.connections << ", blocked: " << s.blocked
+        << ", active: " << s.active << std::endl;
+    os << "blocking: " << s.blocking * 100 << " % +- "
+        << s.ci_half_width * 100 << " %" << std::endl;
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    double interval = 1;
+    bool once = false;
+    bool help = false;
+
+    cxxopts::Options options{argv[0], " <stats page>"};
+    options.add_options()
+        ("n,interval", "Seconds between refreshes",
+         cxxopts::value(interval))
+        ("once", "Show the current values once, without clearing the "
+         "screen",
+         cxxopts::value(once))
+        ("h,help", "Show this help",
+         cxxopts::value(help));
+    options.parse(argc, argv);
+
+    if (help) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    if (argc != 2) {
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+
+    StatsPage page;
+    if (!page.open(argv[1])) {
+        std::cerr << "Error reading " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // Stalled if nothing was published since the last refresh
+    std::uint64_t last_update = 0;
+    bool first = true;
+    while (true) {
+        StatsPage::Snapshot s;
+        if (!page.read(s)) {
+            std::cerr << "Error reading " << argv[1] << std::endl;
+            return 1;
+        }
+        const std::uint64_t update = page.updates();
+        const bool stalled = !first && update == last_update;
+        last_update = update;
+        first = false;
+
+        if (!once) {
+            // Clear the screen and move to the top left corner
+            std::cout << "\033[2J\033[H";
+        }
+        show(std::cout, s, stalled);
+        if (once || s.finished || !running(s.pid)) {
+            break;
+        }
+        std::this_thread::sleep_for(
+                std::chrono::duration<double>(interval));
+    }
+    return 0;
+}
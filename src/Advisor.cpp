@@ -1,12 +1,88 @@
 #include "Advisor.h"
 
+#include "Counters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
 using Graph = Advisor::Graph;
 using vertex_t = Advisor::vertex_t;
 using edge_t = Advisor::edge_t;
 
+namespace {
+/**
+ * BFS visitor that counts one of Counters per event.
+ */
+template<Counters::Counter C, typename Tag>
+struct CountVisits {
+    using event_filter = Tag;
+
+    template<typename T, typename G>
+    void
+    operator()(const T&, const G&) {
+        Counters::add(C);
+    }
+};
+
+/**
+ * FIFO queue for breadth_first_search that keeps its elements in a vector
+ * owned by the caller. Every vertex is pushed at most once per search, so
+ * the vector never grows past the number of vertices.
+ */
+template<typename T>
+class BufferQueue {
+public:
+    using value_type = T;
+    using size_type = typename std::vector<T>::size_type;
+
+    BufferQueue(std::vector<T>& buffer)
+        : buffer(buffer)
+        , head{0}
+    {
+        buffer.clear();
+    }
+
+    void
+    push(const T& t) {
+        buffer.push_back(t);
+    }
+
+    void
+    pop() {
+        head++;
+    }
+
+    T&
+    top() {
+        return buffer[head];
+    }
+
+    const T&
+    top() const {
+        return buffer[head];
+    }
+
+    bool
+    empty() const {
+        return head == buffer.size();
+    }
+
+    size_type
+    size() const {
+        return buffer.size() - head;
+    }
+
+private:
+    std::vector<T>& buffer;
+    size_type head;
+};
+}
+
 /* Constructors, Destructor, and Assignment operators {{{ */
 // Default constructor
 Advisor::Advisor()
+    : tried{0}
 { }
 
 Advisor::Advisor(const Graph& nodes,
@@ -18,8 +94,18 @@ Advisor::Advisor(const Graph& nodes,
     , u_dist{0, static_cast<vertex_t>(boost::num_vertices(nodes) - 1)}
     , arrival_dist{lambda}
     , duration_dist{duration_mean}
+    , tried{0}
 { }
 
+Advisor::Advisor(const Graph& nodes,
+        const Advisor::event_t lambda,
+        const Advisor::event_t duration_mean,
+        const unsigned seed)
+    : Advisor(nodes, lambda, duration_mean)
+{
+    rgen.seed(seed);
+}
+
 // Copy constructor
 Advisor::Advisor(const Advisor& other)
     : lambda{other.lambda}
@@ -28,6 +114,7 @@ Advisor::Advisor(const Advisor& other)
     , u_dist{other.u_dist}
     , arrival_dist{other.arrival_dist}
     , duration_dist{other.duration_dist}
+    , tried{other.tried}
 { }
 
 // Move constructor
@@ -39,6 +126,7 @@ Advisor::Advisor(Advisor&& other)
     , u_dist{std::move(other.u_dist)}
     , arrival_dist{std::move(other.arrival_dist)}
     , duration_dist{std::move(other.duration_dist)}
+    , tried{other.tried}
 { }
 
 // Destructor
@@ -54,6 +142,7 @@ Advisor::operator=(const Advisor& other) {
     u_dist = other.u_dist;
     arrival_dist = other.arrival_dist;
     duration_dist = other.duration_dist;
+    tried = other.tried;
     return *this;
 }
 
@@ -67,6 +156,7 @@ Advisor::operator=(Advisor&& other) {
     u_dist = std::move(other.u_dist);
     arrival_dist = std::move(other.arrival_dist);
     duration_dist = std::move(other.duration_dist);
+    tried = other.tried;
     return *this;
 }
 /* }}} */
@@ -81,6 +171,13 @@ Advisor::get_nodes() {
     return std::make_pair(a, b);
 }
 
+std::pair<vertex_t, vertex_t>
+Advisor::get_nodes(std::discrete_distribution<std::size_t>& pair_dist) {
+    const std::size_t num_vertices = boost::num_vertices(nodes);
+    const std::size_t i = pair_dist(rgen);
+    return std::make_pair(i / num_vertices, i % num_vertices);
+}
+
 Advisor::event_t
 Advisor::get_arrival() {
     return arrival_dist(rgen);
@@ -93,33 +190,67 @@ Advisor::get_duration() {
 
 std::pair<std::vector<edge_t>, Link::wavelength_t>
 Advisor::path_between(vertex_t a, vertex_t b) {
+    std::vector<edge_t> path;
+    const Link::wavelength_t wl = path_between(a, b, path);
+    return std::make_pair(path, wl);
+}
+
+template<typename EdgeIterator>
+void
+Advisor::gather_candidates(EdgeIterator first, EdgeIterator last) {
+    candidates.clear();
+    // Room for every wavelength, whether used or not, so that the buffer
+    // does not grow as the network empties
+    std::size_t wavelengths = 0;
+    for (auto it = first; it != last; it++) {
+        wavelengths += nodes[*it].wavelengths().size();
+    }
+    candidates.reserve(wavelengths);
+    for (auto it = first; it != last; it++) {
+        nodes[*it].for_each_available([this](const Link::wavelength_t wl) {
+            candidates.push_back(wl);
+        });
+    }
+    // First fit: the lowest wavelength that has a path is used
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+}
+
+Link::wavelength_t
+Advisor::path_between(vertex_t a, vertex_t b, std::vector<edge_t>& path) {
     using FilteredGraph = boost::filtered_graph<
         Graph,
         EdgeFilter<Graph>,
         boost::keep_all
     >;
 
+    path.clear();
+
     // Search for all available wavelengths that a has
-    std::unordered_set<Link::wavelength_t> possible_wavelengths;
+    Counters::add(Counters::SEARCHES);
     boost::graph_traits<Graph>::out_edge_iterator e_b, e_e;
     // Look at all edges connected to a
     std::tie(e_b, e_e) = boost::out_edges(a, nodes);
-    for (auto it = e_b; it != e_e; it++) {
-        for (const Link::wavelength_t wl : nodes[*it].available_wavelengths()) {
-            possible_wavelengths.insert(wl);
-        }
-    }
+    gather_candidates(e_b, e_e);
 
-    for (const Link::wavelength_t wl : possible_wavelengths) {
+    const std::size_t num_vertices = boost::num_vertices(nodes);
+    predecessors.resize(num_vertices);
+    colors.resize(num_vertices);
+    bfs_queue.reserve(num_vertices);
+    vertex_path.reserve(num_vertices);
+    auto color_map = boost::make_iterator_property_map(
+        colors.begin(), boost::get(boost::vertex_index, nodes));
+
+    tried = 0;
+    for (const Link::wavelength_t wl : candidates) {
         bool has_path = true;
+        Counters::add(Counters::BFS);
+        Counters::maximum(Counters::WAVELENGTHS_PER_SEARCH, ++tried);
 
-        std::vector<vertex_t> predecessors;
-        predecessors.resize(boost::num_vertices(nodes));
         // Initialize predecessors to the node itself
-        boost::graph_traits<Graph>::vertex_iterator v_b, v_e;
-        std::tie(v_b, v_e) = boost::vertices(nodes);
-        for (auto it = v_b; it != v_e; it++) {
-            predecessors[*it] = *it;
+        for (vertex_t v = 0; v < num_vertices; v++) {
+            predecessors[v] = v;
         }
 
         // Make a filtered graph without unavailable nodes
@@ -127,40 +258,46 @@ Advisor::path_between(vertex_t a, vertex_t b) {
         FilteredGraph fg{nodes, edge_filter, boost::keep_all{}};
 
         // Do a BFS on the filtered graph, recording parents
-        auto vis = boost::visitor(
-            boost::make_bfs_visitor(
+        auto vis = boost::make_bfs_visitor(
+            std::make_pair(
                 boost::record_predecessors(
                     &predecessors[0],
-                    boost::on_tree_edge{})
-                )
+                    boost::on_tree_edge{}),
+                std::make_pair(
+                    CountVisits<Counters::VERTICES_VISITED,
+                                boost::on_discover_vertex>{},
+                    CountVisits<Counters::EDGES_VISITED,
+                                boost::on_examine_edge>{}))
             );
-        boost::breadth_first_search(fg, a, vis);
+        BufferQueue<vertex_t> queue{bfs_queue};
+        boost::breadth_first_search(fg, a, queue, vis, color_map);
 
         // No path
         if (predecessors[b] == b) {
             continue;
         }
 
-        std::vector<vertex_t> path;
+        // Vertices from b back to a
+        vertex_path.clear();
         vertex_t p = b;
         do {
-            path.insert(path.begin(), p);
+            vertex_path.push_back(p);
             p = predecessors[p];
         } while (p != a);
         // Add the source
-        path.insert(path.begin(), p);
+        vertex_path.push_back(p);
 
         // Make path of edges (rather than vertices)
-        std::vector<edge_t> path_edges;
-        for (unsigned i = 0; i < path.size() - 1; i++) {
-            vertex_t src = path[i];
-            vertex_t tgt = path[i + 1];
+        path.clear();
+        for (std::size_t i = vertex_path.size() - 1; i > 0; i--) {
+            vertex_t src = vertex_path[i];
+            vertex_t tgt = vertex_path[i - 1];
 
             edge_t edge;
             // Ignoring whether it was found or not since the vertices are
             // based on results from BFS. The edge better exist...
             std::tie(edge, std::ignore) = boost::edge(src, tgt, nodes);
-            path_edges.push_back(edge);
+            path.push_back(edge);
             const Link& link = nodes[edge];
 
             if (!link.can_use(wl)) {
@@ -170,17 +307,17 @@ Advisor::path_between(vertex_t a, vertex_t b) {
         }
 
         if (has_path) {
-            return std::make_pair(path_edges, wl);
+            return wl;
         }
     }
 
-    return std::make_pair(std::vector<edge_t>(), Link::NONE);
+    path.clear();
+    return Link::NONE;
 }
 
 bool
 Advisor::has_path_between(vertex_t a, vertex_t b) {
-    auto wl = path_between(a, b).second;
-    return wl != Link::NONE;
+    return path_between(a, b, probe_path) != Link::NONE;
 }
 
 std::pair<std::vector<edge_t>, Link::wavelength_t>
@@ -194,10 +331,16 @@ Advisor::make_connection(vertex_t a, vertex_t b) {
         return std::make_pair(std::vector<edge_t>(), Link::NONE);
     }
 
+    add_connection(path, wl);
+    return std::make_pair(path, wl);
+}
+
+void
+Advisor::add_connection(const std::vector<edge_t>& path,
+                        const Link::wavelength_t wl) {
     for (const edge_t& edge : path) {
         nodes[edge].lock(wl);
     }
-    return std::make_pair(path, wl);
 }
 
 void
@@ -207,3 +350,106 @@ Advisor::remove_connection(const std::vector<edge_t>& path,
         nodes[edge].release(wl);
     }
 }
+
+std::vector<std::tuple<edge_t, Link::wavelength_t, Advisor::event_t>>
+Advisor::warm_start(const std::vector<double>& offered_loads) {
+    std::vector<std::tuple<edge_t, Link::wavelength_t, Advisor::event_t>>
+        connections;
+
+    boost::graph_traits<Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(nodes);
+    unsigned i = 0;
+    for (auto it = e_b; it != e_e && i < offered_loads.size(); it++, i++) {
+        Link& link = nodes[*it];
+        const double load = offered_loads[i];
+        if (load <= 0) {
+            continue;
+        }
+
+        // In the order path_between tries them from an end of this link
+        const edge_t edge = *it;
+        gather_candidates(&edge, &edge + 1);
+        const std::vector<Link::wavelength_t>& free = candidates;
+
+        // Truncated Poisson, in log space to avoid overflow
+
+        std::vector<double> log_p(free.size() + 1);
+        for (unsigned n = 0; n <= free.size(); n++) {
+            log_p[n] = n * std::log(load) - std::lgamma(n + 1.0);
+        }
+        const double max_log = *std::max_element(log_p.begin(), log_p.end());
+        std::vector<double> p(log_p.size());
+        for (unsigned n = 0; n < p.size(); n++) {
+            p[n] = std::exp(log_p[n] - max_log);
+        }
+        std::discrete_distribution<unsigned> busy_dist{p.begin(), p.end()};
+        const unsigned busy = busy_dist(rgen);
+
+        // The lowest ones, as first fit in `path_between' would have used
+        for (unsigned n = 0; n < busy; n++) {
+            link.lock(free[n]);
+            connections.emplace_back(*it, free[n], get_duration());
+        }
+    }
+
+    return connections;
+}
+
+void
+Advisor::save(Checkpoint& checkpoint) const {
+    // The standard text representation is exact and portable
+    std::ostringstream oss;
+    oss << rgen << ' ' << u_dist << ' ' << arrival_dist << ' '
+        << duration_dist;
+    checkpoint.put_string(oss.str());
+
+    checkpoint.put<std::uint64_t>(boost::num_edges(nodes));
+    boost::graph_traits<Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(nodes);
+    for (auto it = e_b; it != e_e; it++) {
+        const Link::Wavelengths& used = nodes[*it].used_wavelengths();
+        checkpoint.put<std::uint32_t>(used.size());
+        for (const Link::wavelength_t wl : used) {
+            checkpoint.put<std::uint32_t>(wl);
+        }
+    }
+}
+
+bool
+Advisor::restore(Checkpoint& checkpoint) {
+    std::string state;
+    if (!checkpoint.get_string(state)) {
+        return false;
+    }
+    std::istringstream iss{state};
+    iss >> rgen >> u_dist >> arrival_dist >> duration_dist;
+    if (!iss) {
+        return false;
+    }
+
+    std::uint64_t num_edges;
+    if (!checkpoint.get(num_edges) || num_edges != boost::num_edges(nodes)) {
+        return false;
+    }
+    boost::graph_traits<Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(nodes);
+    for (auto it = e_b; it != e_e; it++) {
+        Link& link = nodes[*it];
+        for (const Link::wavelength_t wl : Link::Wavelengths{
+                link.used_wavelengths()}) {
+            link.release(wl);
+        }
+
+        std::uint32_t count;
+        if (!checkpoint.get(count)) {
+            return false;
+        }
+        for (std::uint32_t i = 0; i < count; i++) {
+            std::uint32_t wl;
+            if (!checkpoint.get(wl) || !link.lock(wl)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
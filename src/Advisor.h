@@ -1,6 +1,7 @@
 #ifndef ADVISOR_H_
 #define ADVISOR_H_
 
+#include "Checkpoint.h"
 #include "Link.h"
 
 #include <boost/graph/graph_traits.hpp>
@@ -10,6 +11,7 @@
 #include <boost/graph/filtered_graph.hpp>
 
 #include <random>
+#include <tuple>
 #include <vector>
 
 /**
@@ -17,19 +19,24 @@
  */
 template<typename Graph>
 struct EdgeFilter {
-    EdgeFilter() { }
+    EdgeFilter()
+        : g{nullptr}
+        , wl{Link::NONE}
+    { }
     EdgeFilter(const Graph& g, const Link::wavelength_t wl)
-        : g{g}
+        : g{&g}
         , wl{wl}
     { }
 
     template<typename Edge>
     bool operator()(const Edge& e) const {
-        const Link& link = g[e];
+        const Link& link = (*g)[e];
         return link.can_use(wl);
     }
 
-    Graph g;
+    // Filtered graphs copy the filter into every iterator, so it must not
+    // own the graph
+    const Graph* g;
     Link::wavelength_t wl;
 };
 
@@ -50,6 +57,15 @@ public:
             const Advisor::event_t lambda,
             const Advisor::event_t duration_mean);
 
+    /**
+     * Same as above, but seeds the random number generator with the given
+     * value so that the sequence of events is reproducible.
+     */
+    Advisor(const Graph& nodes,
+            const Advisor::event_t lambda,
+            const Advisor::event_t duration_mean,
+            const unsigned seed);
+
     // Copy constructor
     Advisor(const Advisor& other);
 
@@ -71,6 +87,14 @@ public:
     std::pair<vertex_t, vertex_t>
     get_nodes();
 
+    /**
+     * Picks two nodes using the given distribution over the pairs instead
+     * of uniformly. The pair (a, b) has index a * V + b, where V is the
+     * number of nodes.
+     */
+    std::pair<vertex_t, vertex_t>
+    get_nodes(std::discrete_distribution<std::size_t>& pair_dist);
+
     /**
      * The time until the start of the next connection.
      * The duration is distributed exponentially with parameter `lambda'.
@@ -91,12 +115,33 @@ public:
     get_duration();
 
     /**
+     * Wavelengths are assigned first fit: the wavelengths available on a
+     * link of a are tried in increasing order, and the first one with a path
+     * to b on which it is free on every link is used.
+     *
      * \return the path and the wavelength available between a and b.
      *         Wavelength is Link::NONE if no path is available.
      */
     std::pair<std::vector<edge_t>, Link::wavelength_t>
     path_between(vertex_t a, vertex_t b);
 
+    /**
+     * Same as above, but writes the path to `path', reusing its storage.
+     * Once the buffers have grown to the size of the network, this does not
+     * allocate.
+     *
+     * \return the wavelength, or Link::NONE if no path is available.
+     */
+    Link::wavelength_t
+    path_between(vertex_t a, vertex_t b, std::vector<edge_t>& path);
+
+    /**
+     * \return the number of wavelengths the last call to `path_between'
+     *         searched, one breadth-first search each.
+     */
+    unsigned
+    wavelengths_tried() const;
+
     /**
      * \return true if there is a path between nodes a and b, false otherwise.
      */
@@ -111,6 +156,14 @@ public:
     std::pair<std::vector<edge_t>, Link::wavelength_t>
     make_connection(vertex_t a, vertex_t b);
 
+    /**
+     * Locks the wavelength on every link of a path found by `path_between'.
+     * `make_connection' is `path_between' followed by this.
+     */
+    void
+    add_connection(const std::vector<edge_t>& path,
+                   const Link::wavelength_t wl);
+
     /**
      * Finishes the connection between nodes a and b using the given
      * wavelength.
@@ -119,7 +172,57 @@ public:
     remove_connection(const std::vector<edge_t>& path,
                       const Link::wavelength_t wl);
 
+    /**
+     * Fills the links with connections as if the network had been running
+     * for a long time. The number of busy wavelengths on each link is drawn
+     * independently from the stationary distribution of an isolated link
+     * (truncated Poisson), and the lowest free wavelengths are made busy, as
+     * first fit (see `path_between') mostly keeps them.
+     * Each busy wavelength is a connection over that link only, with a
+     * remaining duration drawn from the duration distribution (which is
+     * memoryless).
+     *
+     * \param[in] offered_loads the load offered to each link, in the order
+     *                          of boost::edges.
+     *
+     * \return the edge, wavelength and remaining duration of each
+     *         connection made.
+     */
+    std::vector<std::tuple<edge_t, Link::wavelength_t, Advisor::event_t>>
+    warm_start(const std::vector<double>& offered_loads);
+
+    /**
+     * Appends the state of the random number generator and the wavelengths
+     * in use on every link to a checkpoint.
+     */
+    void
+    save(Checkpoint& checkpoint) const;
+
+    /**
+     * Restores a state saved by `save' on an Advisor built from the same
+     * network and parameters, so that it continues exactly where the saved
+     * one was.
+     *
+     * \return true on success, false if the checkpoint does not match.
+     */
+    bool
+    restore(Checkpoint& checkpoint);
+
+    /**
+     * \return the network, including the current state of the links.
+     */
+    const Graph&
+    graph() const;
+
 private:
+    /**
+     * Fills `candidates' with the wavelengths available on any of the
+     * edges, in the order `path_between' tries them.
+     */
+    template<typename EdgeIterator>
+    void
+    gather_candidates(EdgeIterator first, EdgeIterator last);
+
     Advisor::event_t lambda;
     Advisor::event_t duration_mean;
     Graph nodes;
@@ -128,6 +231,25 @@ private:
     std::uniform_int_distribution<vertex_t> u_dist;
     std::exponential_distribution<Advisor::event_t> arrival_dist;
     std::exponential_distribution<Advisor::event_t> duration_dist;
+    /* Buffers of path_between, kept between calls to avoid allocating */
+    std::vector<Link::wavelength_t> candidates;
+    std::vector<vertex_t> predecessors;
+    std::vector<boost::default_color_type> colors;
+    std::vector<vertex_t> bfs_queue;
+    std::vector<vertex_t> vertex_path;
+    std::vector<edge_t> probe_path;
+    unsigned tried;
 };
 
+/* Inlined methods */
+inline const Advisor::Graph&
+Advisor::graph() const {
+    return nodes;
+}
+
+inline unsigned
+Advisor::wavelengths_tried() const {
+    return tried;
+}
+
 #endif /* end of include guard */
@@ -0,0 +1,166 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+namespace {
+std::atomic<bool> tracking{false};
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> frees{0};
+std::atomic<std::uint64_t> bytes{0};
+std::atomic<std::int64_t> live{0};
+std::atomic<std::int64_t> peak{0};
+
+#ifdef EBM_ALLOCATION_TRACKER
+// Every block starts with a header holding the bytes it was counted with,
+// or 0 if it was allocated while tracking was off. The header keeps the
+// alignment malloc guarantees.
+const std::size_t HEADER = alignof(std::max_align_t);
+
+std::size_t
+count_allocation(void* p) {
+    const std::size_t size = ::malloc_usable_size(p);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    const std::int64_t now =
+        live.fetch_add(size, std::memory_order_relaxed) + size;
+    std::int64_t highest = peak.load(std::memory_order_relaxed);
+    while (now > highest
+            && !peak.compare_exchange_weak(highest, now,
+                                           std::memory_order_relaxed)) {
+    }
+    return size;
+}
+
+void
+count_free(const std::size_t size) {
+    frees.fetch_add(1, std::memory_order_relaxed);
+    live.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void*
+allocate(std::size_t size) {
+    void* p;
+    while ((p = std::malloc(size + HEADER)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            return nullptr;
+        }
+        handler();
+    }
+    *static_cast<std::size_t*>(p) = tracking.load(std::memory_order_relaxed)
+        ? count_allocation(p)
+        : 0;
+    return static_cast<char*>(p) + HEADER;
+}
+
+void
+deallocate(void* block) {
+    if (block == nullptr) {
+        return;
+    }
+    void* p = static_cast<char*>(block) - HEADER;
+    // Whether or not tracking is still on, so that `live' stays exact
+    const std::size_t size = *static_cast<std::size_t*>(p);
+    if (size != 0) {
+        count_free(size);
+    }
+    std::free(p);
+}
+#endif
+}
+
+AllocationTracker::Totals::Totals()
+    : allocations{0}
+    , frees{0}
+    , bytes{0}
+    , live{0}
+    , peak{0}
+{ }
+
+AllocationTracker::Totals
+AllocationTracker::Totals::since(const Totals& before) const {
+    Totals t = *this;
+    t.allocations -= before.allocations;
+    t.frees -= before.frees;
+    t.bytes -= before.bytes;
+    return t;
+}
+
+void
+AllocationTracker::enable(const bool on) {
+    tracking.store(on && compiled_in(), std::memory_order_relaxed);
+}
+
+bool
+AllocationTracker::enabled() {
+    return tracking.load(std::memory_order_relaxed);
+}
+
+AllocationTracker::Totals
+AllocationTracker::totals() {
+    Totals t;
+    t.allocations = allocations.load(std::memory_order_relaxed);
+    t.frees = frees.load(std::memory_order_relaxed);
+    t.bytes = bytes.load(std::memory_order_relaxed);
+    t.live = live.load(std::memory_order_relaxed);
+    t.peak = peak.load(std::memory_order_relaxed);
+    return t;
+}
+
+void
+AllocationTracker::reset_peak() {
+    peak.store(live.load(std::memory_order_relaxed),
+               std::memory_order_relaxed);
+}
+
+#ifdef EBM_ALLOCATION_TRACKER
+/* Replacements of the global allocation functions */
+void*
+operator new(std::size_t size) {
+    void* p = allocate(size);
+    if (p == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return p;
+}
+
+void*
+operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void*
+operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void*
+operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void
+operator delete(void* p) noexcept {
+    deallocate(p);
+}
+
+void
+operator delete[](void* p) noexcept {
+    deallocate(p);
+}
+
+void
+operator delete(void* p, const std::nothrow_t&) noexcept {
+    deallocate(p);
+}
+
+void
+operator delete[](void* p, const std::nothrow_t&) noexcept {
+    deallocate(p);
+}
+#endif
@@ -0,0 +1,86 @@
+#ifndef ALLOCATION_TRACKER_H_
+#define ALLOCATION_TRACKER_H_
+
+#include <cstdint>
+
+/**
+ * Counts heap allocations made through the global operator new and delete,
+ * which this module replaces for the whole program.
+ *
+ * The replacements are compiled in only when EBM_ALLOCATION_TRACKER is
+ * defined (configure with -DWITH_ALLOCATION_TRACKER=ON). Otherwise the
+ * program keeps the standard allocator, `enable' does nothing and the totals
+ * stay 0.
+ *
+ * Tracking is off by default, in which case the replacements only call
+ * malloc and free. Once enabled, every allocation updates a few relaxed
+ * atomics: the number of allocations, the bytes allocated, the bytes
+ * currently live and the largest number of live bytes. Bytes are those
+ * actually reserved by malloc, including a small header in front of every
+ * block, so a little more than requested.
+ *
+ * The header records whether a block was counted. Only counted blocks are
+ * counted again when freed, even if tracking has been turned off since, so
+ * the live bytes are exactly those of counted blocks not freed yet and never
+ * go negative.
+ */
+class AllocationTracker {
+public:
+    struct Totals {
+        Totals();
+
+        /**
+         * \return the allocations, frees and bytes made since `before'. The
+         *         live and peak bytes are those of this object.
+         */
+        Totals
+        since(const Totals& before) const;
+
+        std::uint64_t allocations;
+        /* Frees of blocks that were counted when allocated */
+        std::uint64_t frees;
+        std::uint64_t bytes;
+        std::int64_t live;
+        std::int64_t peak;
+    };
+
+    /**
+     * \return true if the replacements of operator new and delete are
+     *         compiled in.
+     */
+    static bool
+    compiled_in() {
+#ifdef EBM_ALLOCATION_TRACKER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Starts or stops counting, if compiled in.
+     */
+    static void
+    enable(const bool on = true);
+
+    /**
+     * \return true if allocations are being counted.
+     */
+    static bool
+    enabled();
+
+    /**
+     * \return the counts so far.
+     */
+    static Totals
+    totals();
+
+    /**
+     * Lowers the peak to the number of bytes live now, so that the peak of a
+     * later part of the run can be measured.
+     */
+    static void
+    reset_peak();
+};
+
+#endif /* end of include guard */
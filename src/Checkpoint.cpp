@@ -0,0 +1,165 @@
+#include "Checkpoint.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace {
+const char MAGIC[8] = {'E', 'B', 'M', 'C', 'H', 'K', 'P', 'T'};
+}
+
+const std::uint32_t Checkpoint::VERSION = 3;
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+Checkpoint::Checkpoint()
+    : pos{0}
+{ }
+
+// Destructor
+Checkpoint::~Checkpoint()
+{ }
+/* }}} */
+
+void
+Checkpoint::put_string(const std::string& s) {
+    put<std::uint64_t>(s.size());
+    data.append(s);
+}
+
+bool
+Checkpoint::get_string(std::string& s) {
+    std::uint64_t size;
+    if (!get(size) || data.size() - pos < size) {
+        return false;
+    }
+    s.assign(data, pos, size);
+    pos += size;
+    return true;
+}
+
+bool
+Checkpoint::write(const std::string& filename) const {
+    std::ofstream ofs{filename, std::ios::out | std::ios::binary};
+    ofs.write(MAGIC, sizeof(MAGIC));
+    ofs.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+    ofs.write(data.data(), data.size());
+    ofs.close();
+    return static_cast<bool>(ofs);
+}
+
+bool
+Checkpoint::read(const std::string& filename) {
+    std::ifstream ifs{filename, std::ios::in | std::ios::binary};
+    char magic[sizeof(MAGIC)];
+    std::uint32_t version;
+    if (!ifs.read(magic, sizeof(magic))
+            || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), magic)
+            || !ifs.read(reinterpret_cast<char*>(&version), sizeof(version))
+            || version != VERSION) {
+        return false;
+    }
+
+    data.assign(std::istreambuf_iterator<char>{ifs},
+                std::istreambuf_iterator<char>{});
+    pos = 0;
+    return !ifs.bad();
+}
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+Checkpoint::Writer::Writer()
+    : pending{nullptr}
+    , spare{nullptr}
+    , stopping{false}
+    , failed{false}
+    , written_{0}
+{ }
+
+// Destructor
+Checkpoint::Writer::~Writer() {
+    stop();
+    delete pending;
+    delete spare;
+}
+/* }}} */
+
+void
+Checkpoint::Writer::start(const std::string& filename) {
+    stop();
+    this->filename = filename;
+    stopping = false;
+    failed = false;
+    written_ = 0;
+    writer = std::thread{&Checkpoint::Writer::write_loop, this};
+}
+
+void
+Checkpoint::Writer::submit(Checkpoint&& checkpoint) {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        // Reuse the buffer of a checkpoint that was already written
+        if (pending == nullptr) {
+            pending = spare != nullptr ? spare : new Checkpoint;
+            spare = nullptr;
+        }
+        std::swap(pending->data, checkpoint.data);
+        pending->pos = 0;
+    }
+    // Hand back an empty buffer that keeps its capacity
+    checkpoint.data.clear();
+    checkpoint.pos = 0;
+    cv.notify_all();
+}
+
+bool
+Checkpoint::Writer::stop() {
+    if (!writer.joinable()) {
+        return !failed;
+    }
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    writer.join();
+    return !failed;
+}
+
+unsigned long
+Checkpoint::Writer::written() const {
+    std::lock_guard<std::mutex> lock{mutex};
+    return written_;
+}
+
+void
+Checkpoint::Writer::write_loop() {
+    const std::string temporary = filename + ".tmp";
+
+    std::unique_lock<std::mutex> lock{mutex};
+    while (true) {
+        cv.wait(lock, [this] { return pending != nullptr || stopping; });
+        if (pending == nullptr) {
+            break;
+        }
+
+        Checkpoint* checkpoint = pending;
+        pending = nullptr;
+        lock.unlock();
+        const bool ok = checkpoint->write(temporary)
+            && std::rename(temporary.c_str(), filename.c_str()) == 0;
+        lock.lock();
+
+        failed = failed || !ok;
+        if (ok) {
+            written_++;
+        }
+        if (spare == nullptr) {
+            spare = checkpoint;
+        }
+        else {
+            delete checkpoint;
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/**
+ * A snapshot of the state of a simulation, serialized into memory.
+ *
+ * Values are appended with `put' and read back in the same order with `get';
+ * they are stored in the byte order of the machine, after a header with a
+ * magic string and a version.
+ */
+class Checkpoint {
+public:
+    static const std::uint32_t VERSION;
+
+    /**
+     * Writes checkpoints to a file on a background thread.
+     *
+     * Each checkpoint is written to a temporary file that then replaces the
+     * file, so that the file always holds a complete checkpoint even if the
+     * process is killed while writing. If a checkpoint is submitted while
+     * the previous one is still being written, it replaces any other
+     * checkpoint waiting to be written; the simulation never waits for the
+     * disk.
+     */
+    class Writer {
+    public:
+        /* Constructors, Destructor, and Assignment operators {{{ */
+        // Default constructor
+        Writer();
+
+        Writer(const Writer&) = delete;
+
+        // Destructor
+        ~Writer();
+
+        Writer&
+        operator=(const Writer&) = delete;
+        /* }}} */
+
+        /**
+         * Starts the background thread that writes to `filename'.
+         */
+        void
+        start(const std::string& filename);
+
+        /**
+         * Queues a checkpoint for writing.
+         */
+        void
+        submit(Checkpoint&& checkpoint);
+
+        /**
+         * Writes the checkpoint that is waiting, if any, and stops the
+         * background thread.
+         *
+         * \return true if every checkpoint was written, false otherwise.
+         */
+        bool
+        stop();
+
+        /**
+         * \return the number of checkpoints written so far.
+         */
+        unsigned long
+        written() const;
+
+    private:
+        void
+        write_loop();
+
+        std::string filename;
+        std::thread writer;
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        Checkpoint* pending;
+        Checkpoint* spare;
+        bool stopping;
+        bool failed;
+        unsigned long written_;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    Checkpoint();
+
+    // Destructor
+    ~Checkpoint();
+    /* }}} */
+
+    /**
+     * Appends a value of a trivially copyable type.
+     */
+    template<typename T>
+    void
+    put(const T& value);
+
+    void
+    put_string(const std::string& s);
+
+    /**
+     * Reads the next value.
+     *
+     * \return true on success, false if there is not enough data left.
+     */
+    template<typename T>
+    bool
+    get(T& value);
+
+    bool
+    get_string(std::string& s);
+
+    /**
+     * \return true if every value has been read.
+     */
+    bool
+    at_end() const;
+
+    /**
+     * \return true on success, false otherwise.
+     */
+    bool
+    write(const std::string& filename) const;
+
+    /**
+     * Reads a checkpoint written by `write', ready for `get'.
+     *
+     * \return true on success, false if the file cannot be read or is not a
+     *         checkpoint of this version.
+     */
+    bool
+    read(const std::string& filename);
+
+private:
+    std::string data;
+    std::size_t pos;
+};
+
+/* Inlined methods */
+template<typename T>
+void
+Checkpoint::put(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable values can be stored");
+    const std::size_t size = data.size();
+    data.resize(size + sizeof(T));
+    std::memcpy(&data[size], &value, sizeof(T));
+}
+
+template<typename T>
+bool
+Checkpoint::get(T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable values can be stored");
+    if (data.size() - pos < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, &data[pos], sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+inline bool
+Checkpoint::at_end() const {
+    return pos == data.size();
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,121 @@
+#include "ControlVariate.h"
+
+#include <cmath>
+
+ControlVariate::Estimate::Estimate()
+    : raw{0}
+    , raw_std_error{0}
+    , corrected{0}
+    , std_error{0}
+    , variance_reduction{0}
+    , batches{0}
+{ }
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+ControlVariate::ControlVariate(const Advisor::event_t lambda,
+                               const Advisor::event_t duration_mean,
+                               const unsigned batch_size)
+    : lambda{lambda}
+    , duration_mean{duration_mean}
+    , batch_size{batch_size == 0 ? 1 : batch_size}
+    , count{0}
+    , blocked{0}
+    , interarrival_sum{0}
+    , duration_sum{0}
+{ }
+
+// Destructor
+ControlVariate::~ControlVariate()
+{ }
+/* }}} */
+
+void
+ControlVariate::arrival(const Advisor::event_t interarrival,
+                        const bool blocked,
+                        const Advisor::event_t duration) {
+    count++;
+    interarrival_sum += lambda * interarrival - 1;
+    if (blocked) {
+        this->blocked++;
+    }
+    else {
+        duration_sum += duration_mean * duration - 1;
+    }
+
+    if (count == batch_size) {
+        batches.push_back(Batch{static_cast<double>(this->blocked) / count,
+                                interarrival_sum / count,
+                                duration_sum / count});
+        count = 0;
+        this->blocked = 0;
+        interarrival_sum = 0;
+        duration_sum = 0;
+    }
+}
+
+ControlVariate::Estimate
+ControlVariate::estimate() const {
+    Estimate est;
+    est.batches = batches.size();
+    if (batches.empty()) {
+        return est;
+    }
+
+    const double n = batches.size();
+    double y = 0, x1 = 0, x2 = 0;
+    for (const Batch& b : batches) {
+        y += b.blocking;
+        x1 += b.interarrival;
+        x2 += b.duration;
+    }
+    y /= n;
+    x1 /= n;
+    x2 /= n;
+    est.raw = y;
+    est.corrected = y;
+
+    // Centered sums of squares and cross products
+    double s_yy = 0, s_11 = 0, s_22 = 0, s_12 = 0, s_1y = 0, s_2y = 0;
+    for (const Batch& b : batches) {
+        const double dy = b.blocking - y;
+        const double d1 = b.interarrival - x1;
+        const double d2 = b.duration - x2;
+        s_yy += dy * dy;
+        s_11 += d1 * d1;
+        s_22 += d2 * d2;
+        s_12 += d1 * d2;
+        s_1y += d1 * dy;
+        s_2y += d2 * dy;
+    }
+
+    if (n < 2) {
+        return est;
+    }
+    const double raw_var = s_yy / (n - 1) / n;
+    est.raw_std_error = std::sqrt(raw_var);
+
+    // Two controls plus the mean need at least four batches
+    const double det = s_11 * s_22 - s_12 * s_12;
+    if (n < 4 || det <= 0) {
+        est.std_error = est.raw_std_error;
+        return est;
+    }
+
+    // Least squares coefficients of the controls
+    const double b1 = (s_22 * s_1y - s_12 * s_2y) / det;
+    const double b2 = (s_11 * s_2y - s_12 * s_1y) / det;
+    // The controls have expectation zero
+    est.corrected = y - b1 * x1 - b2 * x2;
+
+    const double s_ee = s_yy - b1 * s_1y - b2 * s_2y;
+    // Inflation due to estimating the coefficients from the same batches
+    const double inflation = (s_22 * x1 * x1 - 2 * s_12 * x1 * x2
+                              + s_11 * x2 * x2) / det;
+    const double var = s_ee / (n - 3) * (1 / n + inflation);
+    est.std_error = var > 0 ? std::sqrt(var) : 0;
+    if (raw_var > 0) {
+        est.variance_reduction = 1 - var / raw_var;
+    }
+
+    return est;
+}
@@ -0,0 +1,100 @@
+#ifndef CONTROL_VARIATE_H_
+#define CONTROL_VARIATE_H_
+
+#include "Advisor.h"
+
+#include <vector>
+
+/**
+ * Reduces the variance of the blocking probability by correcting it with
+ * quantities whose expectations are known exactly.
+ *
+ * The measured connections are divided into batches. In each batch, the
+ * blocking probability is recorded along with two controls:
+ *
+ * - the mean normalized inter-arrival time (lambda * t - 1), and
+ * - the mean normalized duration of accepted connections (mu * d - 1).
+ *
+ * Both have an expectation of exactly zero; durations are drawn only after a
+ * connection has been accepted, and thus do not depend on whether the
+ * connection was accepted. Batches with short inter-arrival times or long
+ * durations put more load on the links, and thus show more blocking. The
+ * optimal linear combination of the controls is estimated from the batches
+ * and is subtracted from the blocking probability.
+ */
+class ControlVariate {
+public:
+    struct Estimate {
+        Estimate();
+
+        /* Batch means without correction */
+        double raw;
+        double raw_std_error;
+        /* With the controls applied */
+        double corrected;
+        double std_error;
+        /* 1 - (corrected variance) / (raw variance) */
+        double variance_reduction;
+        unsigned batches;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    /**
+     * \param[in] lambda the arrival rate of connections.
+     *
+     * \param[in] duration_mean the parameter of the exponential distribution
+     *                          of durations (i.e. the departure rate).
+     *
+     * \param[in] batch_size the number of connections in each batch.
+     */
+    ControlVariate(const Advisor::event_t lambda,
+                   const Advisor::event_t duration_mean,
+                   const unsigned batch_size);
+
+    // Destructor
+    ~ControlVariate();
+    /* }}} */
+
+    /**
+     * Records one arrival.
+     *
+     * \param[in] interarrival the time since the previous arrival.
+     *
+     * \param[in] blocked whether or not the connection was blocked.
+     *
+     * \param[in] duration the duration of the connection. Ignored if the
+     *                     connection was blocked.
+     */
+    void
+    arrival(const Advisor::event_t interarrival,
+            const bool blocked,
+            const Advisor::event_t duration);
+
+    /**
+     * \return the estimate using all the completed batches. Incomplete
+     *         batches are ignored.
+     */
+    ControlVariate::Estimate
+    estimate() const;
+
+private:
+    struct Batch {
+        double blocking;
+        double interarrival;
+        double duration;
+    };
+
+    Advisor::event_t lambda;
+    Advisor::event_t duration_mean;
+    unsigned batch_size;
+
+    /* The batch that is currently being filled */
+    unsigned count;
+    unsigned blocked;
+    double interarrival_sum;
+    double duration_sum;
+
+    std::vector<Batch> batches;
+};
+
+#endif /* end of include guard */
@@ -0,0 +1,123 @@
+#include "Counters.h"
+
+#include <algorithm>
+
+namespace {
+const char* COUNTER_NAMES[] = {
+    "searches",
+    "bfs",
+    "vertices_visited",
+    "edges_visited",
+    "locks",
+    "releases",
+};
+
+const char* MAXIMUM_NAMES[] = {
+    "max_wavelengths_per_search",
+    "max_queue_depth",
+};
+}
+
+thread_local Counters::Local* Counters::local = nullptr;
+std::vector<std::unique_ptr<Counters::Local>> Counters::blocks;
+std::mutex Counters::mutex;
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+Counters::Counters() {
+    std::fill(values, values + NUM_COUNTERS, 0);
+    std::fill(maxima, maxima + NUM_MAXIMA, 0);
+}
+
+// Copy constructor
+Counters::Counters(const Counters& other) {
+    std::copy(other.values, other.values + NUM_COUNTERS, values);
+    std::copy(other.maxima, other.maxima + NUM_MAXIMA, maxima);
+}
+
+// Destructor
+Counters::~Counters()
+{ }
+
+// Assignment operator
+Counters&
+Counters::operator=(const Counters& other) {
+    std::copy(other.values, other.values + NUM_COUNTERS, values);
+    std::copy(other.maxima, other.maxima + NUM_MAXIMA, maxima);
+    return *this;
+}
+/* }}} */
+
+Counters::Local::Local() {
+    for (auto& v : values) {
+        v.store(0, std::memory_order_relaxed);
+    }
+    for (auto& v : maxima) {
+        v.store(0, std::memory_order_relaxed);
+    }
+}
+
+Counters
+Counters::collect() {
+    Counters total;
+    std::lock_guard<std::mutex> lock{mutex};
+    for (const auto& block : blocks) {
+        for (unsigned i = 0; i < NUM_COUNTERS; i++) {
+            total.values[i] +=
+                block->values[i].load(std::memory_order_relaxed);
+        }
+        for (unsigned i = 0; i < NUM_MAXIMA; i++) {
+            total.maxima[i] = std::max(
+                    total.maxima[i],
+                    block->maxima[i].load(std::memory_order_relaxed));
+        }
+    }
+    return total;
+}
+
+void
+Counters::reset() {
+    std::lock_guard<std::mutex> lock{mutex};
+    for (const auto& block : blocks) {
+        for (auto& v : block->values) {
+            v.store(0, std::memory_order_relaxed);
+        }
+        for (auto& v : block->maxima) {
+            v.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void
+Counters::write(std::ostream& os) const {
+    const double searches = std::max<unsigned long>(values[SEARCHES], 1);
+    os << "searches: " << values[SEARCHES]
+        << ", wavelengths tried per search: " << values[BFS] / searches
+        << " (max " << maxima[WAVELENGTHS_PER_SEARCH] << ")" << std::endl;
+    os << "bfs: " << values[BFS]
+        << ", vertices visited: " << values[VERTICES_VISITED]
+        << ", edges visited: " << values[EDGES_VISITED] << std::endl;
+    os << "locks: " << values[LOCKS]
+        << ", releases: " << values[RELEASES] << std::endl;
+    os << "max queue depth: " << maxima[QUEUE_DEPTH] << std::endl;
+}
+
+void
+Counters::write_json(std::ostream& os) const {
+    for (unsigned i = 0; i < NUM_COUNTERS; i++) {
+        os << (i == 0 ? "" : ", ") << '"' << COUNTER_NAMES[i] << "\": "
+            << values[i];
+    }
+    for (unsigned i = 0; i < NUM_MAXIMA; i++) {
+        os << ", \"" << MAXIMUM_NAMES[i] << "\": " << maxima[i];
+    }
+}
+
+Counters::Local*
+Counters::attach() {
+    std::unique_ptr<Local> block{new Local};
+    local = block.get();
+    std::lock_guard<std::mutex> lock{mutex};
+    blocks.push_back(std::move(block));
+    return local;
+}
@@ -0,0 +1,180 @@
+#ifndef COUNTERS_H_
+#define COUNTERS_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+/**
+ * Counts operations on the hot path: searches for paths, the vertices and
+ * edges they visit, wavelengths tried, locks and releases, and the largest
+ * size of the event queue.
+ *
+ * Counting is compiled in only when EBM_COUNTERS is defined (configure with
+ * -DWITH_COUNTERS=ON). Otherwise `add' and `maximum' are empty and cost
+ * nothing.
+ *
+ * Each thread counts into its own block, which only that thread writes to, so
+ * counting takes no locks and no atomic read-modify-write. `collect' sums the
+ * blocks of all threads, including threads that have finished.
+ */
+class Counters {
+public:
+    enum Counter {
+        /* Calls to Advisor::path_between */
+        SEARCHES,
+        /* Breadth-first searches, one per wavelength tried */
+        BFS,
+        VERTICES_VISITED,
+        EDGES_VISITED,
+        LOCKS,
+        RELEASES,
+        NUM_COUNTERS
+    };
+
+    enum Maximum {
+        /* Wavelengths tried in a single search */
+        WAVELENGTHS_PER_SEARCH,
+        QUEUE_DEPTH,
+        NUM_MAXIMA
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    Counters();
+
+    // Copy constructor
+    Counters(const Counters& other);
+
+    // Destructor
+    ~Counters();
+
+    // Assignment operator
+    Counters&
+    operator=(const Counters& other);
+    /* }}} */
+
+    /**
+     * \return true if counting was compiled in.
+     */
+    static constexpr bool
+    enabled() {
+#ifdef EBM_COUNTERS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Adds to a counter of the calling thread.
+     */
+    static void
+    add(const Counter c, const unsigned long n = 1);
+
+    /**
+     * Raises a maximum of the calling thread to `value' if it is larger.
+     */
+    static void
+    maximum(const Maximum m, const unsigned long value);
+
+    /**
+     * \return the sum of the counters (and the largest maxima) of all
+     *         threads.
+     */
+    static Counters
+    collect();
+
+    /**
+     * Sets the counters of all threads to zero. Must not be called while
+     * other threads are counting.
+     */
+    static void
+    reset();
+
+    unsigned long
+    get(const Counter c) const;
+
+    unsigned long
+    get(const Maximum m) const;
+
+    /**
+     * Writes one counter per line in a human readable form.
+     */
+    void
+    write(std::ostream& os) const;
+
+    /**
+     * Writes the counters as the members of a JSON object, without the
+     * enclosing braces, so that they can be added to another object.
+     */
+    void
+    write_json(std::ostream& os) const;
+
+private:
+    struct Local {
+        Local();
+
+        std::atomic<unsigned long> values[NUM_COUNTERS];
+        std::atomic<unsigned long> maxima[NUM_MAXIMA];
+    };
+
+    /**
+     * Creates and registers the block of the calling thread.
+     */
+    static Local*
+    attach();
+
+    /* Block of the calling thread, null until it first counts */
+    static thread_local Local* local;
+
+    /* Blocks of all threads that have counted, guarded by `mutex' */
+    static std::vector<std::unique_ptr<Local>> blocks;
+    static std::mutex mutex;
+
+    unsigned long values[NUM_COUNTERS];
+    unsigned long maxima[NUM_MAXIMA];
+};
+
+/* Inlined methods */
+// Only the owning thread writes to its block, so a relaxed load and store is
+// enough and compiles to a plain add.
+inline void
+Counters::add(const Counter c, const unsigned long n) {
+#ifdef EBM_COUNTERS
+    Local* l = local != nullptr ? local : attach();
+    auto& v = l->values[c];
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#else
+    (void)c;
+    (void)n;
+#endif
+}
+
+inline void
+Counters::maximum(const Maximum m, const unsigned long value) {
+#ifdef EBM_COUNTERS
+    Local* l = local != nullptr ? local : attach();
+    auto& v = l->maxima[m];
+    if (value > v.load(std::memory_order_relaxed)) {
+        v.store(value, std::memory_order_relaxed);
+    }
+#else
+    (void)m;
+    (void)value;
+#endif
+}
+
+inline unsigned long
+Counters::get(const Counter c) const {
+    return values[c];
+}
+
+inline unsigned long
+Counters::get(const Maximum m) const {
+    return maxima[m];
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,229 @@
+#include "Dimensioning.h"
+
+#include "Erlang.h"
+#include "Shard.h"
+#include "Simulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+/* Bounds of the per-link blocking target searched */
+const double MIN_LINK_TARGET = 1e-12;
+const double MAX_LINK_TARGET = 0.5;
+/* Number of bisection steps over the per-link target */
+const unsigned SEARCH_STEPS = 30;
+/* Number of updates of the reduced loads for one per-link target */
+const unsigned SETTLE_STEPS = 50;
+/* Blocked connections needed before the standard error is trusted to show
+ * that a target is missed */
+const unsigned long MIN_BLOCKED = 10;
+
+/**
+ * \return the upper end of a confidence interval of about two standard
+ *         errors for the blocking of `partial'. Few blocked connections say
+ *         little about the spread, so the interval is at least the upper
+ *         bound for a Poisson count of blocked connections (b + 2 +
+ *         2 sqrt(b + 1), e.g. 4 when none were seen).
+ */
+double
+upper_bound(const Shard::Partial& partial) {
+    if (partial.connections == 0) {
+        return 1;
+    }
+    const double b = partial.blocked;
+    const double poisson = (b + 2 + 2 * std::sqrt(b + 1))
+        / partial.connections;
+    return std::max(partial.blocking() + 2 * partial.std_error(), poisson);
+}
+}
+
+const unsigned Dimensioning::MAX_ROUNDS;
+
+Dimensioning::Assignment::Assignment()
+    : total{0}
+    , analytic_blocking{0}
+    , simulated_blocking{0}
+    , std_error{0}
+    , upper_bound{1}
+    , connections_simulated{0}
+    , feasible{false}
+{ }
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+Dimensioning::Dimensioning(const Advisor::Graph& topology,
+                           const bool has_converter,
+                           const Advisor::event_t lambda,
+                           const Advisor::event_t duration_mean,
+                           const unsigned max_capacity,
+                           const unsigned threads)
+    : topology{topology}
+    , has_converter{has_converter}
+    , lambda{lambda}
+    , duration_mean{duration_mean}
+    , max_capacity{std::max(max_capacity, 1u)}
+    , approximation{topology,
+                    has_converter ? ReducedLoad::CONVERSION
+                                  : ReducedLoad::CONTINUITY,
+                    threads}
+    , chunk{0}
+    , max_chunks{0}
+    , seed{1}
+{ }
+
+// Destructor
+Dimensioning::~Dimensioning()
+{ }
+/* }}} */
+
+void
+Dimensioning::set_simulation(const unsigned long budget,
+                             const unsigned max_chunks,
+                             const unsigned seed) {
+    // Every round may use all its chunks
+    const unsigned long runs = static_cast<unsigned long>(max_chunks)
+        * MAX_ROUNDS;
+    chunk = runs == 0 ? 0 : budget / runs;
+    this->max_chunks = chunk == 0 ? 0 : max_chunks;
+    this->seed = seed;
+}
+
+const std::vector<Advisor::edge_t>&
+Dimensioning::edges() const {
+    return approximation.edges();
+}
+
+Advisor::Graph
+Dimensioning::make_graph(const std::vector<unsigned>& capacities) const {
+    // Copies keep the order of the edges
+    Advisor::Graph g{topology};
+    boost::graph_traits<Advisor::Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(g);
+    unsigned i = 0;
+    for (auto it = e_b; it != e_e; it++, i++) {
+        g[*it] = Link(capacities[i], has_converter);
+    }
+    return g;
+}
+
+std::pair<std::vector<unsigned>, double>
+Dimensioning::capacities_for(const double link_target) {
+    const unsigned long num_links = edges().size();
+    std::vector<unsigned> capacities(num_links, 1);
+    std::vector<unsigned> next(num_links);
+    const std::vector<double> targets(num_links, link_target);
+
+    approximation.set_capacities(capacities);
+    auto sol = approximation.solve(lambda, duration_mean);
+    for (unsigned step = 0; step < SETTLE_STEPS; step++) {
+        const auto offered = approximation.offered_loads(sol);
+        erlang_b_capacity(offered.data(), targets.data(), next.data(),
+                          num_links);
+        for (unsigned& c : next) {
+            c = std::min(std::max(c, 1u), max_capacity);
+        }
+        if (next == capacities) {
+            break;
+        }
+
+        capacities = next;
+        approximation.set_capacities(capacities);
+        sol = approximation.solve(lambda, duration_mean);
+    }
+
+    return std::make_pair(capacities, sol.blocking);
+}
+
+Dimensioning::Assignment
+Dimensioning::analytic(const double target) {
+    Assignment best;
+
+    // Nothing can do better than the largest capacity everywhere
+    best.capacities.assign(edges().size(), max_capacity);
+    approximation.set_capacities(best.capacities);
+    best.analytic_blocking = approximation.solve(lambda, duration_mean)
+        .blocking;
+    best.feasible = best.analytic_blocking <= target;
+
+    if (best.feasible) {
+        // Search over the per-link target in log space. A larger per-link
+        // target means fewer wavelengths
+        double lo = std::log(MIN_LINK_TARGET);
+        double hi = std::log(MAX_LINK_TARGET);
+        for (unsigned step = 0; step < SEARCH_STEPS; step++) {
+            const double mid = (lo + hi) / 2;
+            auto result = capacities_for(std::exp(mid));
+            if (result.second <= target) {
+                lo = mid;
+                best.capacities = result.first;
+                best.analytic_blocking = result.second;
+            }
+            else {
+                hi = mid;
+            }
+        }
+    }
+
+    best.total = 0;
+    for (const unsigned c : best.capacities) {
+        best.total += c;
+    }
+    return best;
+}
+
+void
+Dimensioning::simulate(Assignment& assignment, const double target) {
+    const Advisor::Graph g = make_graph(assignment.capacities);
+
+    Shard::Partial partial;
+    for (unsigned r = 0; r < max_chunks; r++) {
+        Advisor advisor{g, lambda, duration_mean, seed + r};
+        partial.add(Simulator{advisor, chunk}.run());
+
+        // Early stop once the interval is clearly on one side
+        if (partial.replications >= 3) {
+            const double m = partial.blocking();
+            if (upper_bound(partial) < target
+                    || (partial.blocked >= MIN_BLOCKED
+                        && m - 2 * partial.std_error() > target)) {
+                break;
+            }
+        }
+    }
+
+    assignment.simulated_blocking = partial.blocking();
+    assignment.std_error = partial.std_error();
+    assignment.upper_bound = upper_bound(partial);
+    assignment.connections_simulated += partial.connections;
+    assignment.feasible = assignment.upper_bound <= target;
+}
+
+Dimensioning::Assignment
+Dimensioning::solve(const double target) {
+    double analytic_target = target;
+    unsigned long simulated = 0;
+
+    Assignment assignment;
+    for (unsigned round = 0; round < MAX_ROUNDS; round++) {
+        assignment = analytic(analytic_target);
+        if (!assignment.feasible || chunk == 0 || max_chunks == 0) {
+            break;
+        }
+
+        assignment.connections_simulated = simulated;
+        simulate(assignment, target);
+        simulated = assignment.connections_simulated;
+        // Not shown to be missed either; more wavelengths would not make
+        // the remaining budget verify it
+        if (assignment.feasible
+                || assignment.simulated_blocking <= target) {
+            break;
+        }
+
+        // The approximation is optimistic here, so ask it for less
+        const double ratio = target / assignment.simulated_blocking;
+        analytic_target *= std::min(std::max(ratio, 0.1), 0.9);
+    }
+
+    return assignment;
+}
@@ -0,0 +1,139 @@
+#ifndef DIMENSIONING_H_
+#define DIMENSIONING_H_
+
+#include "Advisor.h"
+#include "ReducedLoad.h"
+
+#include <vector>
+
+/**
+ * Finds a cheap number of wavelengths for each link such that the network
+ * blocking probability is at most a given target.
+ *
+ * The coarse search is analytic: for a per-link blocking target b, each link
+ * gets the smallest capacity for which Erlang B of its reduced load is at
+ * most b, and the reduced loads are updated until the capacities settle.
+ * The largest b for which the reduced load approximation of the network
+ * meets the target gives the assignment, so that lightly loaded links get
+ * fewer wavelengths than heavily loaded ones.
+ *
+ * The assignment is then verified by simulation in chunks of connections,
+ * stopping as soon as the confidence interval is clearly on one side of the
+ * target. It is only accepted if the upper end of the interval is at most the
+ * target; with few blocked connections, the interval is widened to a Poisson
+ * bound on their number, so that seeing none in n connections only shows a
+ * blocking below about 4 / n. If the simulation shows that the target is
+ * missed, the analytic target is tightened by the observed ratio and the
+ * search is repeated.
+ */
+class Dimensioning {
+public:
+    /* Largest number of times the analytic target is tightened, each
+     * followed by a simulation */
+    static const unsigned MAX_ROUNDS = 4;
+
+    struct Assignment {
+        Assignment();
+
+        /* Indexed like `edges()' */
+        std::vector<unsigned> capacities;
+        unsigned long total;
+        double analytic_blocking;
+        /* Only set if the assignment was simulated */
+        double simulated_blocking;
+        double std_error;
+        /* Upper end of the confidence interval of the simulated blocking */
+        double upper_bound;
+        unsigned long connections_simulated;
+        /* Whether the target was met (by simulation if it was run, in which
+         * case the upper bound must be at most the target) */
+        bool feasible;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    /**
+     * \param[in] max_capacity the largest number of wavelengths a link can
+     *                         have.
+     */
+    Dimensioning(const Advisor::Graph& topology,
+                 const bool has_converter,
+                 const Advisor::event_t lambda,
+                 const Advisor::event_t duration_mean,
+                 const unsigned max_capacity,
+                 const unsigned threads = 0);
+
+    // Destructor
+    ~Dimensioning();
+    /* }}} */
+
+    /**
+     * Enables verification by simulation.
+     *
+     * \param[in] budget the largest number of connections simulated by the
+     *                   whole search, over all its rounds. Each run
+     *                   simulates budget / (max_chunks * MAX_ROUNDS) of them.
+     *
+     * \param[in] max_chunks the largest number of runs for one assignment.
+     *
+     * \param[in] seed the seed of the first run. Run r uses seed + r.
+     */
+    void
+    set_simulation(const unsigned long budget,
+                   const unsigned max_chunks,
+                   const unsigned seed);
+
+    /**
+     * \return the assignment for the given target blocking probability.
+     */
+    Dimensioning::Assignment
+    solve(const double target);
+
+    /**
+     * \return the edges of the topology in the order of the capacities.
+     */
+    const std::vector<Advisor::edge_t>&
+    edges() const;
+
+    /**
+     * \return a copy of the topology with the given number of wavelengths on
+     *         each link.
+     */
+    Advisor::Graph
+    make_graph(const std::vector<unsigned>& capacities) const;
+
+private:
+    /**
+     * \return the capacities for the given per-link blocking target, and the
+     *         network blocking of the approximation with those capacities.
+     */
+    std::pair<std::vector<unsigned>, double>
+    capacities_for(const double link_target);
+
+    /**
+     * Analytic search for the largest per-link target that meets
+     * `target'.
+     */
+    Dimensioning::Assignment
+    analytic(const double target);
+
+    /**
+     * Simulates the assignment until its blocking is clearly above or
+     * below `target', or the budget runs out. The assignment is feasible if
+     * its blocking was shown to be below `target'.
+     */
+    void
+    simulate(Assignment& assignment, const double target);
+
+    Advisor::Graph topology;
+    bool has_converter;
+    Advisor::event_t lambda;
+    Advisor::event_t duration_mean;
+    unsigned max_capacity;
+    ReducedLoad approximation;
+
+    unsigned chunk;
+    unsigned max_chunks;
+    unsigned seed;
+};
+
+#endif /* end of include guard */
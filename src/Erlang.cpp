@@ -0,0 +1,137 @@
+#include "Erlang.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+/**
+ * \return true if no capacity has a blocking probability of at most
+ *         `target': blocking is never negative, and only 0 without load.
+ */
+bool
+unreachable(const double load, const double target) {
+    return target < 0 || (target == 0 && load > 0);
+}
+}
+
+double
+erlang_b(const double load, const unsigned capacity) {
+    double result = 1;
+    for (unsigned k = 1; k <= capacity; k++) {
+        result = erlang_b_step(load, k, result);
+    }
+    return result;
+}
+
+void
+erlang_b(const double* loads,
+         const unsigned* capacities,
+         double* out,
+         const std::size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    const unsigned max_capacity = *std::max_element(capacities,
+                                                    capacities + n);
+    std::vector<double> result(n, 1.0);
+    // 1 while a system is below its capacity, 0 afterwards
+    std::vector<double> active(n);
+
+    for (unsigned k = 1; k <= max_capacity; k++) {
+        const double kd = k;
+        for (std::size_t i = 0; i < n; i++) {
+            active[i] = k <= capacities[i] ? 1.0 : 0.0;
+        }
+        // Blending with the mask instead of branching keeps the loop free
+        // of control flow, so that it is vectorized
+        for (std::size_t i = 0; i < n; i++) {
+            const double prev = result[i];
+            const double next = loads[i] * prev / (kd + loads[i] * prev);
+            result[i] = prev + active[i] * (next - prev);
+        }
+    }
+
+    std::copy(result.begin(), result.end(), out);
+}
+
+unsigned
+erlang_b_capacity(const double load, const double target) {
+    if (unreachable(load, target)) {
+        return std::numeric_limits<unsigned>::max();
+    }
+
+    double result = 1;
+    unsigned k = 0;
+    while (result > target) {
+        k++;
+        result = erlang_b_step(load, k, result);
+    }
+    return k;
+}
+
+void
+erlang_b_capacity(const double* loads,
+                  const double* targets,
+                  unsigned* out,
+                  const std::size_t n) {
+    std::vector<double> current(n, 1.0);
+    // Whether out[i] is final
+    std::vector<unsigned char> done(n);
+    std::fill(out, out + n, 0);
+
+    std::size_t remaining = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        if (unreachable(loads[i], targets[i])) {
+            out[i] = std::numeric_limits<unsigned>::max();
+            done[i] = 1;
+        }
+        else {
+            done[i] = current[i] <= targets[i];
+            remaining += !done[i];
+        }
+    }
+
+    for (unsigned k = 1; remaining > 0; k++) {
+        const double kd = k;
+        remaining = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            const bool finished = done[i] != 0;
+            const double next = loads[i] * current[i]
+                / (kd + loads[i] * current[i]);
+            current[i] = finished ? current[i] : next;
+            out[i] = finished ? out[i] : k;
+            done[i] = finished || current[i] <= targets[i];
+            remaining += !done[i];
+        }
+    }
+}
+
+double
+erlang_b_load(const unsigned capacity, const double target) {
+    if (target >= 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (capacity == 0 || target <= 0) {
+        return 0;
+    }
+
+    // B is increasing in the load, so bracket and bisect
+    double lo = 0;
+    double hi = capacity;
+    while (erlang_b(hi, capacity) <= target) {
+        lo = hi;
+        hi *= 2;
+    }
+    for (unsigned i = 0; i < 200 && hi - lo > 1e-12 * hi; i++) {
+        const double mid = (lo + hi) / 2;
+        if (erlang_b(mid, capacity) <= target) {
+            lo = mid;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
@@ -0,0 +1,82 @@
+#ifndef ERLANG_H_
+#define ERLANG_H_
+
+#include <cstddef>
+
+/*
+ * Closed-form results for a single M/M/c/c system (e.g. one link).
+ *
+ * All functions use the recursion
+ *
+ *     B(a, 0) = 1
+ *     B(a, k) = a B(a, k - 1) / (k + a B(a, k - 1))
+ *
+ * which, unlike the textbook formula, never overflows and keeps full
+ * relative precision for any offered load and capacity.
+ */
+
+/**
+ * One step of the recursion, from k - 1 to k servers.
+ */
+constexpr double
+erlang_b_step(const double load, const unsigned k, const double prev) {
+    return load * prev / (k + load * prev);
+}
+
+/**
+ * Same as `erlang_b', but evaluated at compile time if the arguments are
+ * constants. Meant for tables of small capacities since the recursion depth
+ * is the capacity.
+ */
+constexpr double
+erlang_b_static(const double load, const unsigned capacity) {
+    return capacity == 0
+        ? 1.0
+        : erlang_b_step(load, capacity, erlang_b_static(load, capacity - 1));
+}
+
+/**
+ * \return the blocking probability of `capacity' servers with an offered
+ *         load of `load' Erlangs.
+ */
+double
+erlang_b(const double load, const unsigned capacity);
+
+/**
+ * Batched version of `erlang_b'. Computes out[i] = B(loads[i],
+ * capacities[i]) for all i < n. All the systems step through the recursion
+ * together without branches, so the loop over the systems is vectorized by
+ * the compiler.
+ */
+void
+erlang_b(const double* loads,
+         const unsigned* capacities,
+         double* out,
+         const std::size_t n);
+
+/**
+ * \return the smallest capacity whose blocking probability is at most
+ *         `target' for the given offered load. If no capacity can reach
+ *         the target (i.e. the target is negative, or 0 with a positive
+ *         load), the largest value of unsigned is returned.
+ */
+unsigned
+erlang_b_capacity(const double load, const double target);
+
+/**
+ * Batched version of `erlang_b_capacity'.
+ */
+void
+erlang_b_capacity(const double* loads,
+                  const double* targets,
+                  unsigned* out,
+                  const std::size_t n);
+
+/**
+ * \return the largest offered load that `capacity' servers can carry with a
+ *         blocking probability of at most `target'.
+ */
+double
+erlang_b_load(const unsigned capacity, const double target);
+
+#endif /* end of include guard */
@@ -38,7 +38,7 @@ Event::Event(const Advisor::vertex_t src,
     , dst{dst}
     , type{type}
     , time{time}
-    , path{path}
+    , path{std::move(path)}
     , wavelength{wl}
 { }
 
@@ -0,0 +1,168 @@
+#include "EventLatency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+const char* const KIND_NAMES[] = {"START accepted", "START blocked", "END"};
+}
+
+const unsigned EventLatency::Histogram::SUB_BUCKET_BITS;
+const std::size_t EventLatency::Histogram::SUB_BUCKETS;
+const std::size_t EventLatency::Histogram::NUM_BUCKETS;
+
+EventLatency::Histogram::Histogram()
+    : counts(NUM_BUCKETS, 0)
+    , count_{0}
+    , max_{0}
+    , sum{0}
+{ }
+
+void
+EventLatency::Histogram::merge(const Histogram& other) {
+    for (std::size_t b = 0; b < NUM_BUCKETS; b++) {
+        counts[b] += other.counts[b];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+    sum += other.sum;
+}
+
+void
+EventLatency::Histogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    count_ = 0;
+    max_ = 0;
+    sum = 0;
+}
+
+double
+EventLatency::Histogram::mean() const {
+    return count_ == 0 ? 0 : static_cast<double>(sum) / count_;
+}
+
+std::uint64_t
+EventLatency::Histogram::value_at(const double q) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    // Rank of the value, from 1
+    const double clamped = std::min(std::max(q, 0.0), 1.0);
+    const std::uint64_t rank = std::max<std::uint64_t>(
+            std::ceil(clamped * count_), 1);
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < NUM_BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= rank) {
+            return std::min(highest(b), max_);
+        }
+    }
+    return max_;
+}
+
+std::uint64_t
+EventLatency::Histogram::highest(const std::size_t b) {
+    if (b < 2 * SUB_BUCKETS) {
+        return b;
+    }
+    const unsigned shift = b / SUB_BUCKETS - 1;
+    const std::uint64_t lowest =
+        static_cast<std::uint64_t>(b % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    return lowest + ((std::uint64_t{1} << shift) - 1);
+}
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+EventLatency::EventLatency()
+    : period_ticks{0}
+    , period_ns{0}
+    , start_ticks{0}
+{ }
+
+// Copy constructor
+EventLatency::EventLatency(const EventLatency& other)
+    : period_ticks{other.period_ticks}
+    , period_ns{other.period_ns}
+    , start_ticks{other.start_ticks}
+    , start_time{other.start_time}
+{
+    std::copy(other.histograms, other.histograms + NUM_KINDS, histograms);
+}
+
+// Destructor
+EventLatency::~EventLatency()
+{ }
+
+// Assignment operator
+EventLatency&
+EventLatency::operator=(const EventLatency& other) {
+    std::copy(other.histograms, other.histograms + NUM_KINDS, histograms);
+    period_ticks = other.period_ticks;
+    period_ns = other.period_ns;
+    start_ticks = other.start_ticks;
+    start_time = other.start_time;
+    return *this;
+}
+/* }}} */
+
+void
+EventLatency::start() {
+    start_time = std::chrono::steady_clock::now();
+    start_ticks = ticks();
+}
+
+void
+EventLatency::stop() {
+    const std::uint64_t end_ticks = ticks();
+    const auto end_time = std::chrono::steady_clock::now();
+    period_ticks += end_ticks - start_ticks;
+    period_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            end_time - start_time).count();
+}
+
+double
+EventLatency::ns_per_tick() const {
+    if (period_ticks == 0 || period_ns == 0) {
+        return 1;
+    }
+    return static_cast<double>(period_ns) / period_ticks;
+}
+
+double
+EventLatency::quantile(const Kind kind, const double q) const {
+    return histograms[kind].value_at(q) * ns_per_tick();
+}
+
+void
+EventLatency::write(std::ostream& os) const {
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+
+    os << std::left << std::setw(16) << "event" << std::right
+        << std::setw(12) << "count" << std::setw(12) << "mean (ns)"
+        << std::setw(12) << "p50 (ns)" << std::setw(12) << "p99 (ns)"
+        << std::setw(12) << "p99.9 (ns)" << std::setw(12) << "max (ns)"
+        << std::endl;
+    os << std::fixed << std::setprecision(0);
+    const double scale = ns_per_tick();
+    for (unsigned k = 0; k < NUM_KINDS; k++) {
+        const Kind kind = static_cast<Kind>(k);
+        const Histogram& h = histograms[k];
+        os << std::left << std::setw(16) << name(kind) << std::right
+            << std::setw(12) << h.count()
+            << std::setw(12) << h.mean() * scale
+            << std::setw(12) << quantile(kind, 0.5)
+            << std::setw(12) << quantile(kind, 0.99)
+            << std::setw(12) << quantile(kind, 0.999)
+            << std::setw(12) << h.max() * scale << std::endl;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+const char*
+EventLatency::name(const Kind kind) {
+    return KIND_NAMES[kind];
+}
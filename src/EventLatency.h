@@ -0,0 +1,228 @@
+#ifndef EVENT_LATENCY_H_
+#define EVENT_LATENCY_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Distributions of the time the simulator takes to process one event, kept
+ * separately for accepted arrivals, blocked arrivals and departures.
+ *
+ * Times are read from the time stamp counter where there is one (x86) and
+ * from the steady clock otherwise, and recorded as raw ticks so that timing
+ * an event costs two reads of the counter and an increment. Ticks are
+ * converted to nanoseconds when reporting, with the rate of the counter
+ * measured against the steady clock over the calls to `start' and `stop'.
+ */
+class EventLatency {
+public:
+    enum Kind {
+        START_ACCEPTED,
+        START_BLOCKED,
+        END,
+        NUM_KINDS
+    };
+
+    /**
+     * Log-linear histogram of non-negative integers, in the manner of
+     * HdrHistogram: values below 64 have their own bucket, and every power of
+     * two above is split into 32 buckets, so a value is known to within about
+     * 3% whatever its magnitude.
+     */
+    class Histogram {
+    public:
+        static const unsigned SUB_BUCKET_BITS = 5;
+        static const std::size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static const std::size_t NUM_BUCKETS =
+            (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        Histogram();
+
+        void
+        record(const std::uint64_t value);
+
+        /**
+         * Adds the values recorded in `other'.
+         */
+        void
+        merge(const Histogram& other);
+
+        void
+        reset();
+
+        std::uint64_t
+        count() const;
+
+        std::uint64_t
+        max() const;
+
+        double
+        mean() const;
+
+        /**
+         * \param[in] q a fraction between 0 and 1.
+         *
+         * \return the largest value in the bucket holding the smallest value
+         *         that is at least a fraction `q' of the values, or 0 if
+         *         nothing was recorded.
+         */
+        std::uint64_t
+        value_at(const double q) const;
+
+        /**
+         * \return the bucket `value' is counted in.
+         */
+        static std::size_t
+        bucket(const std::uint64_t value);
+
+        /**
+         * \return the largest value counted in bucket `b'.
+         */
+        static std::uint64_t
+        highest(const std::size_t b);
+
+    private:
+        std::vector<std::uint64_t> counts;
+        std::uint64_t count_;
+        std::uint64_t max_;
+        /* Not exact if the sum overflows, which takes centuries of ticks */
+        std::uint64_t sum;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    EventLatency();
+
+    // Copy constructor
+    EventLatency(const EventLatency& other);
+
+    // Destructor
+    ~EventLatency();
+
+    // Assignment operator
+    EventLatency&
+    operator=(const EventLatency& other);
+    /* }}} */
+
+    /**
+     * \return the current value of the counter events are timed with.
+     */
+    static std::uint64_t
+    ticks();
+
+    /**
+     * Starts a period over which the rate of the counter is measured.
+     */
+    void
+    start();
+
+    /**
+     * Ends the period started by `start'.
+     */
+    void
+    stop();
+
+    /**
+     * Records the time taken by one event, in ticks.
+     */
+    void
+    record(const Kind kind, const std::uint64_t elapsed);
+
+    const Histogram&
+    histogram(const Kind kind) const;
+
+    /**
+     * \return the nanoseconds per tick over the periods between `start' and
+     *         `stop', or 1 if there were none.
+     */
+    double
+    ns_per_tick() const;
+
+    /**
+     * \return the time in nanoseconds that a fraction `q' of the events of
+     *         the given kind took at most.
+     */
+    double
+    quantile(const Kind kind, const double q) const;
+
+    /**
+     * Writes a table of the count, median, 99th and 99.9th percentiles and
+     * maximum of each kind, in nanoseconds.
+     */
+    void
+    write(std::ostream& os) const;
+
+    /**
+     * \return the name of a kind, e.g. "START accepted".
+     */
+    static const char*
+    name(const Kind kind);
+
+private:
+    Histogram histograms[NUM_KINDS];
+    /* Ticks and nanoseconds in the periods between `start' and `stop' */
+    std::uint64_t period_ticks;
+    std::uint64_t period_ns;
+    std::uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+};
+
+/* Inlined methods */
+inline void
+EventLatency::Histogram::record(const std::uint64_t value) {
+    counts[bucket(value)]++;
+    count_++;
+    sum += value;
+    if (value > max_) {
+        max_ = value;
+    }
+}
+
+inline std::uint64_t
+EventLatency::Histogram::count() const {
+    return count_;
+}
+
+inline std::uint64_t
+EventLatency::Histogram::max() const {
+    return max_;
+}
+
+inline std::size_t
+EventLatency::Histogram::bucket(const std::uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return value;
+    }
+    // Position of the highest bit, at least SUB_BUCKET_BITS + 1
+    const unsigned top = 63 - __builtin_clzll(value);
+    const unsigned shift = top - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+inline std::uint64_t
+EventLatency::ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline void
+EventLatency::record(const Kind kind, const std::uint64_t elapsed) {
+    histograms[kind].record(elapsed);
+}
+
+inline const EventLatency::Histogram&
+EventLatency::histogram(const Kind kind) const {
+    return histograms[kind];
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,110 @@
+#include "Ladder.h"
+
+#include "Event.h"
+
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+/**
+ * A connection ending in the network with `level' + 1 wavelengths.
+ */
+struct LadderEvent {
+    bool
+    operator>(const LadderEvent& other) const {
+        return event > other.event;
+    }
+
+    Event event;
+    unsigned level;
+};
+
+Advisor::Graph
+with_wavelengths(const Advisor::Graph& topology,
+                 const unsigned num_wavelengths,
+                 const bool has_converter) {
+    Advisor::Graph g{topology};
+    boost::graph_traits<Advisor::Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(g);
+    for (auto it = e_b; it != e_e; it++) {
+        g[*it] = Link(num_wavelengths, has_converter);
+    }
+    return g;
+}
+}
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+Ladder::Ladder(const Advisor::Graph& topology,
+               const unsigned max_wavelengths,
+               const bool has_converter,
+               const Advisor::event_t lambda,
+               const Advisor::event_t duration_mean,
+               const unsigned seed)
+    : source{topology, lambda, duration_mean, seed}
+{
+    levels.reserve(max_wavelengths);
+    for (unsigned w = 1; w <= max_wavelengths; w++) {
+        levels.emplace_back(with_wavelengths(topology, w, has_converter),
+                            lambda, duration_mean);
+    }
+}
+
+// Destructor
+Ladder::~Ladder()
+{ }
+/* }}} */
+
+std::vector<Simulator::Result>
+Ladder::run(const unsigned limit, const unsigned ignore_first) {
+    std::vector<Simulator::Result> results(levels.size());
+    // 10% of the limit by default
+    unsigned to_ignore = ignore_first == 0 ? limit * 0.1 : ignore_first;
+    unsigned arrivals = 0;
+    Advisor::event_t now = 0;
+
+    std::priority_queue<LadderEvent,
+                        std::vector<LadderEvent>,
+                        std::greater<LadderEvent>> pq;
+    Advisor::event_t next_arrival = source.get_arrival();
+
+    while (arrivals < to_ignore + limit) {
+        // Departures scheduled before the next arrival
+        if (!pq.empty() && pq.top().event.time < next_arrival) {
+            const LadderEvent& end = pq.top();
+            levels[end.level].remove_connection(end.event.path,
+                                                end.event.wavelength);
+            pq.pop();
+            continue;
+        }
+
+        now = next_arrival;
+        Advisor::vertex_t src, dst;
+        std::tie(src, dst) = source.get_nodes();
+        const Advisor::event_t end_time = now + source.get_duration();
+        const bool measured = arrivals >= to_ignore;
+
+        for (unsigned l = 0; l < levels.size(); l++) {
+            std::vector<Advisor::edge_t> path;
+            Link::wavelength_t wl;
+            std::tie(path, wl) = levels[l].make_connection(src, dst);
+
+            // Wavelength is Link::NONE on failure
+            if (wl != Link::NONE) {
+                pq.push(LadderEvent{
+                        Event{src, dst, Event::END, end_time, path, wl}, l});
+            }
+            else if (measured) {
+                results[l].blocked++;
+            }
+            if (measured) {
+                results[l].connections++;
+            }
+        }
+
+        arrivals++;
+        next_arrival = now + source.get_arrival();
+    }
+
+    return results;
+}
@@ -0,0 +1,62 @@
+#ifndef LADDER_H_
+#define LADDER_H_
+
+#include "Advisor.h"
+#include "Simulator.h"
+
+#include <vector>
+
+/**
+ * Simulates the same network with every wavelength count from 1 to
+ * `max_wavelengths' at once. All capacities see the same stream of
+ * arrivals, node pairs and durations (i.e. common random numbers), and only
+ * the routing and the occupancy of the links are kept separately for each
+ * capacity. This gives the whole blocking-versus-capacity curve for about the
+ * cost of the random number generation and event handling of one run.
+ */
+class Ladder {
+public:
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    /**
+     * \param[in] topology the network. The links in this graph are replaced
+     *                     by links with 1 to `max_wavelengths' wavelengths.
+     *
+     * \param[in] max_wavelengths the largest number of wavelengths to
+     *                            simulate.
+     *
+     * \param[in] has_converter whether or not the nodes have wavelength
+     *                          converters.
+     *
+     * \param[in] seed the seed of the shared random number stream.
+     */
+    Ladder(const Advisor::Graph& topology,
+           const unsigned max_wavelengths,
+           const bool has_converter,
+           const Advisor::event_t lambda,
+           const Advisor::event_t duration_mean,
+           const unsigned seed);
+
+    // Destructor
+    ~Ladder();
+    /* }}} */
+
+    /**
+     * Runs the simulation until `limit' connections have been observed.
+     *
+     * \param[in] ignore_first the number of connections to ignore. Default to
+     *                         10% of limit.
+     *
+     * \return the counters for each wavelength count, with the result for W
+     *         wavelengths at index W - 1.
+     */
+    std::vector<Simulator::Result>
+    run(const unsigned limit, const unsigned ignore_first = 0);
+
+private:
+    /* Only used as the source of the shared random numbers */
+    Advisor source;
+    /* One network state for each wavelength count */
+    std::vector<Advisor> levels;
+};
+
+#endif /* end of include guard */
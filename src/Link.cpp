@@ -1,5 +1,7 @@
 #include "Link.h"
 
+#include "Counters.h"
+
 using wavelength_t = Link::wavelength_t;
 using Wavelengths = Link::Wavelengths;
 
@@ -8,6 +10,10 @@ const Link::wavelength_t Link::NONE = 0;
 /* Constructors, Destructor, and Assignment operators {{{ */
 // Default constructor
 Link::Link()
+    : contiguous{true}
+    , num_used_{0}
+    , has_converter_{false}
+    , used_stale{false}
 { }
 
 Link::Link(const unsigned num_links, bool has_converter)
@@ -16,6 +22,7 @@ Link::Link(const unsigned num_links, bool has_converter)
     for (unsigned i = 1; i <= num_links; i++) {
         wavelengths_.insert(static_cast<wavelength_t>(i));
     }
+    index();
 }
 
 Link::Link(const int num_links, bool has_converter)
@@ -25,15 +32,24 @@ Link::Link(const int num_links, bool has_converter)
 // Copy constructor
 Link::Link(const Link& other)
     : wavelengths_{other.wavelengths_}
-    , used_{other.used_}
+    , order{other.order}
+    , contiguous{other.contiguous}
+    , used_bits{other.used_bits}
+    , num_used_{other.num_used_}
     , has_converter_{other.has_converter_}
+    , used_stale{true}
 { }
 
 // Move constructor
 Link::Link(Link&& other)
     : wavelengths_{std::move(other.wavelengths_)}
-    , used_{std::move(other.used_)}
+    , order{std::move(other.order)}
+    , contiguous{other.contiguous}
+    , used_bits{std::move(other.used_bits)}
+    , num_used_{other.num_used_}
     , has_converter_{std::move(other.has_converter_)}
+    , used_{std::move(other.used_)}
+    , used_stale{other.used_stale}
 { }
 
 // Destructor
@@ -44,8 +60,12 @@ Link::~Link()
 Link&
 Link::operator=(const Link& other) {
     wavelengths_ = other.wavelengths_;
-    used_ = other.used_;
+    order = other.order;
+    contiguous = other.contiguous;
+    used_bits = other.used_bits;
+    num_used_ = other.num_used_;
     has_converter_ = other.has_converter_;
+    used_stale = true;
     return *this;
 }
 
@@ -53,39 +73,49 @@ Link::operator=(const Link& other) {
 Link&
 Link::operator=(Link&& other) {
     wavelengths_ = std::move(other.wavelengths_);
-    used_ = std::move(other.used_);
+    order = std::move(other.order);
+    contiguous = other.contiguous;
+    used_bits = std::move(other.used_bits);
+    num_used_ = other.num_used_;
     has_converter_ = std::move(other.has_converter_);
+    used_ = std::move(other.used_);
+    used_stale = other.used_stale;
     return *this;
 }
 /* }}} */
 
-bool
-Link::can_use(const wavelength_t wl) const {
-    // A wavelength that doesn't exist
-    if (wavelengths_.count(wl) == 0) {
-        return false;
-    }
-
-    if (has_converter_ && used_.size() < wavelengths_.size()) {
-        return true;
-    }
-
-    return used_.count(wl) == 0;
-}
-
 bool
 Link::lock(const wavelength_t wl) {
     if (!can_use(wl)) {
         return false;
     }
 
-    used_.insert(wl);
+    // With a converter, an used wavelength can be locked again
+    const long i = position(wl);
+    std::uint64_t& word = used_bits[i / 64];
+    const std::uint64_t bit = std::uint64_t{1} << (i % 64);
+    if ((word & bit) == 0) {
+        word |= bit;
+        num_used_++;
+        used_stale = true;
+    }
+    Counters::add(Counters::LOCKS);
     return true;
 }
 
 void
 Link::release(const wavelength_t wl) {
-    used_.erase(wl);
+    const long i = position(wl);
+    if (i >= 0) {
+        std::uint64_t& word = used_bits[i / 64];
+        const std::uint64_t bit = std::uint64_t{1} << (i % 64);
+        if ((word & bit) != 0) {
+            word &= ~bit;
+            num_used_--;
+            used_stale = true;
+        }
+    }
+    Counters::add(Counters::RELEASES);
 }
 
 Wavelengths
@@ -93,10 +123,23 @@ Link::available_wavelengths() const {
     std::unordered_set<wavelength_t> available;
 
     for (const wavelength_t wl : wavelengths_) {
-        if (used_.count(wl) == 0) {
+        const long i = position(wl);
+        if ((used_bits[i / 64] >> (i % 64) & 1) == 0) {
             available.insert(wl);
         }
     }
 
     return available;
 }
+
+void
+Link::index() {
+    order.assign(wavelengths_.begin(), wavelengths_.end());
+    std::sort(order.begin(), order.end());
+    contiguous = order.empty()
+        || order.back() - order.front() + 1 == order.size();
+    used_bits.assign((order.size() + 63) / 64, 0);
+    num_used_ = 0;
+    used_.clear();
+    used_stale = false;
+}
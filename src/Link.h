@@ -2,6 +2,7 @@
 #define NODE_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <iterator>
 #include <unordered_set>
 #include <vector>
@@ -46,7 +47,9 @@ public:
     Link(const T& wavelengths, bool has_converter = false)
         : wavelengths_{wavelengths.begin(), wavelengths.end()}
         , has_converter_{has_converter}
-    { }
+    {
+        index();
+    }
 
     // Copy constructor
     Link(const Link& other);
@@ -100,11 +103,34 @@ public:
     wavelengths() const;
 
     /**
-     * \return the set of used wavelengths.
+     * \return the set of used wavelengths. The set is rebuilt on the first
+     *         call after the link changed, so the hot path uses `num_used'
+     *         and `for_each_used' instead.
      */
     const Wavelengths&
     used_wavelengths() const;
 
+    /**
+     * \return the number of used wavelengths.
+     */
+    unsigned
+    num_used() const;
+
+    /**
+     * Calls `f' with every used wavelength, in increasing order.
+     */
+    template<typename F>
+    void
+    for_each_used(F f) const;
+
+    /**
+     * Calls `f' with every wavelength that is not used, in increasing order.
+     * Unlike `available_wavelengths', this does not allocate.
+     */
+    template<typename F>
+    void
+    for_each_available(F f) const;
+
     /**
      * \return the set of wavelengths that are not used.
      */
@@ -125,9 +151,30 @@ public:
     has_converter() const;
 
 private:
+    /**
+     * Numbers the wavelengths in increasing order and clears the used bits.
+     */
+    void
+    index();
+
+    /**
+     * \return the number of the wavelength, or -1 if the link does not have
+     *         it.
+     */
+    long
+    position(const wavelength_t wl) const;
+
     Wavelengths wavelengths_;
-    Wavelengths used_;
+    /* Wavelengths in increasing order; bit i of used_bits is order[i] */
+    std::vector<wavelength_t> order;
+    /* Whether order is first, first + 1, ... */
+    bool contiguous;
+    std::vector<std::uint64_t> used_bits;
+    unsigned num_used_;
     bool has_converter_;
+    /* Built from used_bits by used_wavelengths() */
+    mutable Wavelengths used_;
+    mutable bool used_stale;
 };
 
 /* Inlined methods */
@@ -138,9 +185,70 @@ Link::wavelengths() const {
 
 inline const Link::Wavelengths&
 Link::used_wavelengths() const {
+    if (used_stale) {
+        used_.clear();
+        for_each_used([this](const wavelength_t wl) { used_.insert(wl); });
+        used_stale = false;
+    }
     return used_;
 }
 
+inline unsigned
+Link::num_used() const {
+    return num_used_;
+}
+
+template<typename F>
+void
+Link::for_each_used(F f) const {
+    for (std::size_t w = 0; w < used_bits.size(); w++) {
+        std::uint64_t bits = used_bits[w];
+        while (bits != 0) {
+            f(order[w * 64 + __builtin_ctzll(bits)]);
+            bits &= bits - 1;
+        }
+    }
+}
+
+template<typename F>
+void
+Link::for_each_available(F f) const {
+    for (std::size_t i = 0; i < order.size(); i++) {
+        if ((used_bits[i / 64] >> (i % 64) & 1) == 0) {
+            f(order[i]);
+        }
+    }
+}
+
+inline long
+Link::position(const wavelength_t wl) const {
+    if (order.empty()) {
+        return -1;
+    }
+    if (contiguous) {
+        return wl >= order.front() && wl <= order.back()
+            ? static_cast<long>(wl - order.front())
+            : -1;
+    }
+    const auto it = std::lower_bound(order.begin(), order.end(), wl);
+    return it != order.end() && *it == wl ? it - order.begin() : -1;
+}
+
+inline bool
+Link::can_use(const wavelength_t wl) const {
+    const long i = position(wl);
+    // A wavelength that doesn't exist
+    if (i < 0) {
+        return false;
+    }
+
+    if (has_converter_ && num_used_ < order.size()) {
+        return true;
+    }
+
+    return (used_bits[i / 64] >> (i % 64) & 1) == 0;
+}
+
 inline unsigned
 Link::num_wavelengths() const {
     return wavelengths_.size();
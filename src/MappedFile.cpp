@@ -0,0 +1,53 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+MappedFile::MappedFile(const std::string& filename)
+    : fd{::open(filename.c_str(), O_RDONLY)}
+    , data_{nullptr}
+    , size_{0}
+    , good_{false}
+{
+    struct stat st;
+    // Directories and devices open but cannot be mapped as a whole
+    if (fd < 0 || ::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return;
+    }
+    size_ = st.st_size;
+    if (size_ == 0) {
+        good_ = true;
+        return;
+    }
+
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        size_ = 0;
+        return;
+    }
+    data_ = static_cast<const char*>(p);
+    good_ = true;
+    advise_sequential(true);
+}
+
+// Destructor
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+/* }}} */
+
+void
+MappedFile::advise_sequential(const bool sequential) const {
+    if (data_ != nullptr) {
+        ::madvise(const_cast<char*>(data_), size_,
+                  sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+    }
+}
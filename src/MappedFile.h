@@ -0,0 +1,68 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-only mapping of a whole file. Pages are shared with every other
+ * process mapping the same file.
+ */
+class MappedFile {
+public:
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    explicit MappedFile(const std::string& filename);
+
+    MappedFile(const MappedFile&) = delete;
+
+    // Destructor
+    ~MappedFile();
+
+    MappedFile&
+    operator=(const MappedFile&) = delete;
+    /* }}} */
+
+    /**
+     * \return true if the file is a regular file that could be opened and
+     *         mapped. An empty file is good but has no data.
+     */
+    bool
+    good() const;
+
+    /**
+     * Tells the kernel whether the data will be read sequentially (the
+     * default) or randomly.
+     */
+    void
+    advise_sequential(const bool sequential) const;
+
+    const char*
+    data() const;
+
+    std::size_t
+    size() const;
+
+private:
+    int fd;
+    const char* data_;
+    std::size_t size_;
+    bool good_;
+};
+
+/* Inlined methods */
+inline bool
+MappedFile::good() const {
+    return good_;
+}
+
+inline const char*
+MappedFile::data() const {
+    return data_;
+}
+
+inline std::size_t
+MappedFile::size() const {
+    return size_;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,77 @@
+#include "PageWriter.h"
+
+#include <utility>
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+PageWriter::PageWriter()
+    : pending{nullptr}
+    , pending_size{0}
+    , stopping{false}
+    , failed{false}
+{ }
+
+// Destructor
+PageWriter::~PageWriter() {
+    stop();
+}
+/* }}} */
+
+void
+PageWriter::start(Write write) {
+    stop();
+
+    this->write = std::move(write);
+    pending = nullptr;
+    stopping = false;
+    failed = false;
+    writer = std::thread{&PageWriter::write_loop, this};
+}
+
+void
+PageWriter::submit(const void* page, const std::size_t size) {
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this] { return pending == nullptr; });
+        pending = page;
+        pending_size = size;
+    }
+    cv.notify_all();
+}
+
+bool
+PageWriter::stop() {
+    if (!writer.joinable()) {
+        return !failed;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this] { return pending == nullptr; });
+        stopping = true;
+    }
+    cv.notify_all();
+    writer.join();
+    return !failed;
+}
+
+void
+PageWriter::write_loop() {
+    std::unique_lock<std::mutex> lock{mutex};
+    while (true) {
+        cv.wait(lock, [this] { return pending != nullptr || stopping; });
+        if (pending == nullptr) {
+            break;
+        }
+
+        const void* page = pending;
+        const std::size_t size = pending_size;
+        lock.unlock();
+        const bool ok = write(page, size);
+        lock.lock();
+
+        failed = failed || !ok;
+        pending = nullptr;
+        cv.notify_all();
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef PAGE_WRITER_H_
+#define PAGE_WRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * Writes pages on a background thread while the caller fills the next one.
+ *
+ * The caller fills one of two pages and hands it over with `submit', then
+ * fills the other one. `submit' only waits if the page handed over before is
+ * still being written, so the caller only waits if the disk cannot keep up.
+ * How a page is written (copied as is, formatted first) is up to the
+ * function given to `start'.
+ */
+class PageWriter {
+public:
+    /**
+     * Writes `size' units of `page' on the background thread, and returns
+     * false if that failed.
+     */
+    using Write = std::function<bool(const void* page, std::size_t size)>;
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    PageWriter();
+
+    PageWriter(const PageWriter&) = delete;
+
+    // Destructor
+    ~PageWriter();
+
+    PageWriter&
+    operator=(const PageWriter&) = delete;
+    /* }}} */
+
+    /**
+     * Starts the background thread, which calls `write' for every page.
+     */
+    void
+    start(Write write);
+
+    /**
+     * Hands `page' to the background thread, once the page submitted before
+     * has been written. The page must not be changed until the next call to
+     * `submit' or `stop' returns.
+     */
+    void
+    submit(const void* page, const std::size_t size);
+
+    /**
+     * Writes the page that is waiting, if any, and stops the background
+     * thread.
+     *
+     * \return true if every page was written since `start', false
+     *         otherwise.
+     */
+    bool
+    stop();
+
+    /**
+     * \return true between `start' and `stop'.
+     */
+    bool
+    running() const;
+
+private:
+    void
+    write_loop();
+
+    Write write;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable cv;
+    /* Page being written by the background thread, if any */
+    const void* pending;
+    std::size_t pending_size;
+    bool stopping;
+    bool failed;
+};
+
+/* Inlined methods */
+inline bool
+PageWriter::running() const {
+    return writer.joinable();
+}
+
+#endif /* end of include guard */
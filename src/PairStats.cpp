@@ -0,0 +1,87 @@
+#include "PairStats.h"
+
+#include <cmath>
+
+namespace {
+/**
+ * \return p (1 - p) for the blocking probability p of a pair, with p
+ *         estimated as (blocked + 1) / (attempts + 2) (Laplace's rule), so
+ *         that pairs that never or always blocked do not look certain.
+ */
+double
+smoothed_variance(const unsigned long blocked, const unsigned long attempts) {
+    const double p = (blocked + 1.0) / (attempts + 2.0);
+    return p * (1 - p);
+}
+}
+
+PairStats::Estimate::Estimate()
+    : blocking{0}
+    , std_error{0}
+    , pairs{0}
+{ }
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+PairStats::PairStats()
+    : num_vertices_{0}
+{ }
+
+PairStats::PairStats(const unsigned num_vertices)
+    : num_vertices_{num_vertices}
+    , attempts_(static_cast<std::size_t>(num_vertices) * num_vertices, 0)
+    , blocked_(static_cast<std::size_t>(num_vertices) * num_vertices, 0)
+{ }
+
+// Destructor
+PairStats::~PairStats()
+{ }
+/* }}} */
+
+PairStats::Estimate
+PairStats::estimate() const {
+    Estimate est;
+
+    double sum = 0;
+    double var_sum = 0;
+    for (std::size_t i = 0; i < attempts_.size(); i++) {
+        const unsigned long n = attempts_[i];
+        if (n == 0) {
+            continue;
+        }
+
+        // The estimate itself is not smoothed, only its variance, which
+        // would otherwise be 0 for the many pairs that never block
+        sum += static_cast<double>(blocked_[i]) / n;
+        var_sum += smoothed_variance(blocked_[i], n) / n;
+        est.pairs++;
+    }
+
+    if (est.pairs == 0) {
+        return est;
+    }
+
+    const double k = est.pairs;
+    est.blocking = sum / k;
+    est.std_error = std::sqrt(var_sum) / k;
+    return est;
+}
+
+std::vector<double>
+PairStats::neyman_weights() const {
+    std::vector<double> weights(attempts_.size(), 0);
+
+    for (std::size_t src = 0; src < num_vertices_; src++) {
+        for (std::size_t dst = 0; dst < num_vertices_; dst++) {
+            if (src == dst) {
+                continue;
+            }
+
+            const std::size_t i = src * num_vertices_ + dst;
+            weights[i] = std::sqrt(smoothed_variance(blocked_[i],
+                                                     attempts_[i]));
+        }
+    }
+
+    return weights;
+}
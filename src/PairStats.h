@@ -0,0 +1,116 @@
+#ifndef PAIR_STATS_H_
+#define PAIR_STATS_H_
+
+#include "Advisor.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Per (source, destination) pair counters for a stratified estimate of the
+ * network blocking probability.
+ *
+ * Connections are requested between uniformly chosen ordered pairs, so the
+ * network blocking probability is the plain average of the blocking
+ * probabilities of all V * (V - 1) pairs. Estimating each pair (stratum)
+ * separately and averaging removes the variance caused by the random choice
+ * of pairs, and allows sampling pairs with a high variance (e.g. long paths)
+ * more often without biasing the result.
+ *
+ * The counters are kept in flat V * V arrays indexed by src * V + dst,
+ * computed in std::size_t so that large networks do not overflow.
+ */
+class PairStats {
+public:
+    struct Estimate {
+        Estimate();
+
+        double blocking;
+        double std_error;
+        /* Number of pairs with at least one attempt */
+        unsigned long pairs;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    PairStats();
+
+    explicit PairStats(const unsigned num_vertices);
+
+    // Destructor
+    ~PairStats();
+    /* }}} */
+
+    /**
+     * Records an attempt to connect src and dst.
+     */
+    void
+    record(const Advisor::vertex_t src,
+           const Advisor::vertex_t dst,
+           const bool blocked);
+
+    /**
+     * \return the stratified estimate. Pairs without any attempts are left
+     *         out and the remaining pairs are weighted equally. The variance
+     *         of each pair uses a blocking probability smoothed with one
+     *         blocked and one accepted attempt, so that it is never 0.
+     */
+    PairStats::Estimate
+    estimate() const;
+
+    /**
+     * Weights for sampling pairs proportionally to the standard deviation
+     * of their blocking (Neyman allocation). The blocking probability of each
+     * pair is smoothed so that pairs that have not been observed yet, or have
+     * never blocked, still get sampled.
+     *
+     * \return one weight per pair, indexed by src * V + dst.
+     */
+    std::vector<double>
+    neyman_weights() const;
+
+    unsigned long
+    attempts(const Advisor::vertex_t src, const Advisor::vertex_t dst) const;
+
+    unsigned long
+    blocked(const Advisor::vertex_t src, const Advisor::vertex_t dst) const;
+
+    unsigned
+    num_vertices() const;
+
+private:
+    unsigned num_vertices_;
+    std::vector<unsigned long> attempts_;
+    std::vector<unsigned long> blocked_;
+};
+
+/* Inlined methods */
+inline void
+PairStats::record(const Advisor::vertex_t src,
+                  const Advisor::vertex_t dst,
+                  const bool blocked) {
+    const std::size_t i = static_cast<std::size_t>(src) * num_vertices_ + dst;
+    attempts_[i]++;
+    if (blocked) {
+        blocked_[i]++;
+    }
+}
+
+inline unsigned long
+PairStats::attempts(const Advisor::vertex_t src,
+                    const Advisor::vertex_t dst) const {
+    return attempts_[static_cast<std::size_t>(src) * num_vertices_ + dst];
+}
+
+inline unsigned long
+PairStats::blocked(const Advisor::vertex_t src,
+                   const Advisor::vertex_t dst) const {
+    return blocked_[static_cast<std::size_t>(src) * num_vertices_ + dst];
+}
+
+inline unsigned
+PairStats::num_vertices() const {
+    return num_vertices_;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,203 @@
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+struct CounterType {
+    const char* name;
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+const CounterType TYPES[] = {
+    {"task clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+const char* SECTION_NAMES[] = {
+    "run",
+    "routing",
+    "locking",
+    "queue",
+};
+
+int
+perf_event_open(perf_event_attr& attr, const int group_fd) {
+    // This thread, on any CPU
+    return ::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+}
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+PerfCounters::PerfCounters()
+    : leader{-1}
+    , num_open{0}
+{
+    for (unsigned c = 0; c < NUM_COUNTERS; c++) {
+        fds[c] = -1;
+        positions[c] = -1;
+    }
+    std::memset(starts, 0, sizeof(starts));
+    std::memset(totals, 0, sizeof(totals));
+    std::memset(calls_, 0, sizeof(calls_));
+}
+
+// Destructor
+PerfCounters::~PerfCounters() {
+    close();
+}
+/* }}} */
+
+bool
+PerfCounters::open() {
+    close();
+
+    error_.clear();
+    for (unsigned c = 0; c < NUM_COUNTERS; c++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = TYPES[c].type;
+        attr.config = TYPES[c].config;
+        attr.disabled = leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP
+            | PERF_FORMAT_TOTAL_TIME_ENABLED
+            | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fds[c] = perf_event_open(attr, leader);
+        if (fds[c] < 0) {
+            error_ += std::string{error_.empty() ? "" : ", "}
+                + TYPES[c].name + ": " + std::strerror(errno);
+            continue;
+        }
+        if (leader < 0) {
+            leader = fds[c];
+        }
+        positions[c] = num_open++;
+    }
+
+    if (leader < 0 || ::ioctl(leader, PERF_EVENT_IOC_ENABLE,
+                              PERF_IOC_FLAG_GROUP) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void
+PerfCounters::begin(const Section s) {
+    if (num_open > 0) {
+        read(starts[s]);
+    }
+}
+
+void
+PerfCounters::end(const Section s) {
+    std::uint64_t values[NUM_COUNTERS];
+    if (num_open == 0 || !read(values)) {
+        return;
+    }
+    for (unsigned c = 0; c < NUM_COUNTERS; c++) {
+        totals[s][c] += values[c] - starts[s][c];
+    }
+    calls_[s]++;
+}
+
+void
+PerfCounters::write(std::ostream& os) const {
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+
+    os << std::left << std::setw(10) << "section" << std::right
+        << std::setw(12) << "calls" << std::setw(14) << "ns/call";
+    if (available(CYCLES) && available(INSTRUCTIONS)) {
+        os << std::setw(14) << "cycles/call" << std::setw(8) << "IPC";
+    }
+    if (available(CACHE_MISSES)) {
+        os << std::setw(18) << "cache misses/call";
+    }
+    if (available(BRANCH_MISSES)) {
+        os << std::setw(19) << "branch misses/call";
+    }
+    os << std::endl;
+
+    os << std::fixed;
+    for (unsigned s = 0; s < NUM_SECTIONS; s++) {
+        if (calls_[s] == 0) {
+            continue;
+        }
+        const double n = calls_[s];
+        os << std::left << std::setw(10) << SECTION_NAMES[s] << std::right
+            << std::setw(12) << calls_[s] << std::setprecision(1)
+            << std::setw(14) << totals[s][TASK_CLOCK] / n;
+        if (available(CYCLES) && available(INSTRUCTIONS)) {
+            const double cycles = totals[s][CYCLES];
+            os << std::setw(14) << cycles / n << std::setprecision(2)
+                << std::setw(8)
+                << (cycles > 0 ? totals[s][INSTRUCTIONS] / cycles : 0);
+        }
+        os << std::setprecision(3);
+        if (available(CACHE_MISSES)) {
+            os << std::setw(18) << totals[s][CACHE_MISSES] / n;
+        }
+        if (available(BRANCH_MISSES)) {
+            os << std::setw(19) << totals[s][BRANCH_MISSES] / n;
+        }
+        os << std::endl;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+bool
+PerfCounters::read(std::uint64_t* values) const {
+    // nr, time_enabled, time_running, then a value per counter
+    std::uint64_t buffer[3 + NUM_COUNTERS];
+    const ssize_t size = (3 + num_open) * sizeof(std::uint64_t);
+    if (::read(leader, buffer, size) != size) {
+        return false;
+    }
+
+    const std::uint64_t enabled = buffer[1];
+    const std::uint64_t running = buffer[2];
+    for (unsigned c = 0; c < NUM_COUNTERS; c++) {
+        if (positions[c] < 0) {
+            values[c] = 0;
+            continue;
+        }
+        const std::uint64_t value = buffer[3 + positions[c]];
+        // Scale up if the group was not always on the PMU
+        values[c] = running > 0 && running < enabled
+            ? static_cast<std::uint64_t>(
+                    static_cast<double>(value) * enabled / running)
+            : value;
+    }
+    return true;
+}
+
+void
+PerfCounters::close() {
+    for (unsigned c = 0; c < NUM_COUNTERS; c++) {
+        if (fds[c] >= 0) {
+            ::close(fds[c]);
+        }
+        fds[c] = -1;
+        positions[c] = -1;
+    }
+    leader = -1;
+    num_open = 0;
+}
@@ -0,0 +1,193 @@
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * Hardware performance counters (Linux perf_event_open) accumulated over
+ * sections of code, e.g. the routing and the event queue of the simulator.
+ *
+ * The counters are opened as one group for the calling thread and count
+ * continuously; `begin' and `end' read the group (one system call each) and
+ * add the difference to the section. Sections may nest, but a section must
+ * not be entered again before it ends.
+ *
+ * Counters the machine or the kernel does not provide (e.g. in virtual
+ * machines, or with a restrictive kernel.perf_event_paranoid) are left out.
+ * If not even the task clock can be opened, `open' fails and `begin' and
+ * `end' do nothing.
+ */
+class PerfCounters {
+public:
+    enum Section {
+        /* The whole event loop */
+        RUN,
+        /* Finding paths */
+        ROUTING,
+        /* Locking and releasing wavelengths */
+        LOCKING,
+        /* Pushing to and popping from the event queue */
+        QUEUE,
+        NUM_SECTIONS
+    };
+
+    enum Counter {
+        /* Nanoseconds on the CPU, including the reads of the counters */
+        TASK_CLOCK,
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        NUM_COUNTERS
+    };
+
+    /**
+     * Counts a section until the end of the scope or until `close'. Does
+     * nothing when given null.
+     */
+    class Scope {
+    public:
+        Scope(PerfCounters* perf, const Section section);
+
+        Scope(const Scope&) = delete;
+
+        ~Scope();
+
+        Scope&
+        operator=(const Scope&) = delete;
+
+        void
+        close();
+
+    private:
+        PerfCounters* perf;
+        Section section;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+
+    // Destructor
+    ~PerfCounters();
+
+    PerfCounters&
+    operator=(const PerfCounters&) = delete;
+    /* }}} */
+
+    /**
+     * Opens and starts the counters for the calling thread.
+     *
+     * \return true if at least one counter could be opened, false otherwise.
+     */
+    bool
+    open();
+
+    /**
+     * \return true if the counter was opened.
+     */
+    bool
+    available(const Counter c) const;
+
+    void
+    begin(const Section s);
+
+    void
+    end(const Section s);
+
+    /**
+     * \return the total count of the counter over all runs of the section,
+     *         scaled up if the counters were multiplexed.
+     */
+    std::uint64_t
+    get(const Section s, const Counter c) const;
+
+    /**
+     * \return the number of times the section was run.
+     */
+    std::uint64_t
+    calls(const Section s) const;
+
+    /**
+     * Writes a table with a row per section that was run.
+     */
+    void
+    write(std::ostream& os) const;
+
+    /**
+     * \return why `open' failed, or the counters that are missing.
+     */
+    const std::string&
+    error() const;
+
+private:
+    /**
+     * Reads the current values of the group into `values'.
+     */
+    bool
+    read(std::uint64_t* values) const;
+
+    void
+    close();
+
+    int fds[NUM_COUNTERS];
+    /* The counter the others are read through */
+    int leader;
+    /* Position of each open counter in the group, in order of opening */
+    int positions[NUM_COUNTERS];
+    unsigned num_open;
+    std::uint64_t starts[NUM_SECTIONS][NUM_COUNTERS];
+    std::uint64_t totals[NUM_SECTIONS][NUM_COUNTERS];
+    std::uint64_t calls_[NUM_SECTIONS];
+    std::string error_;
+};
+
+/* Inlined methods */
+inline
+PerfCounters::Scope::Scope(PerfCounters* perf, const Section section)
+    : perf{perf}
+    , section{section}
+{
+    if (perf != nullptr) {
+        perf->begin(section);
+    }
+}
+
+inline
+PerfCounters::Scope::~Scope() {
+    close();
+}
+
+inline void
+PerfCounters::Scope::close() {
+    if (perf != nullptr) {
+        perf->end(section);
+        perf = nullptr;
+    }
+}
+
+inline bool
+PerfCounters::available(const Counter c) const {
+    return fds[c] >= 0;
+}
+
+inline std::uint64_t
+PerfCounters::get(const Section s, const Counter c) const {
+    return totals[s][c];
+}
+
+inline std::uint64_t
+PerfCounters::calls(const Section s) const {
+    return calls_[s];
+}
+
+inline const std::string&
+PerfCounters::error() const {
+    return error_;
+}
+
+#endif /* end of include guard */
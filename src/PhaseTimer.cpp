@@ -0,0 +1,152 @@
+#include "PhaseTimer.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include <sys/resource.h>
+#include <time.h>
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+PhaseTimer::PhaseTimer()
+    : current{0}
+    , cpu_start{0}
+    , timeline{nullptr}
+{ }
+
+// Copy constructor
+PhaseTimer::PhaseTimer(const PhaseTimer& other)
+    : phases_{other.phases_}
+    , current{other.current}
+    , wall_start{other.wall_start}
+    , cpu_start{other.cpu_start}
+    , allocations_start{other.allocations_start}
+    , timeline{other.timeline}
+{ }
+
+// Destructor
+PhaseTimer::~PhaseTimer()
+{ }
+
+// Assignment operator
+PhaseTimer&
+PhaseTimer::operator=(const PhaseTimer& other) {
+    phases_ = other.phases_;
+    current = other.current;
+    wall_start = other.wall_start;
+    cpu_start = other.cpu_start;
+    allocations_start = other.allocations_start;
+    timeline = other.timeline;
+    return *this;
+}
+/* }}} */
+
+void
+PhaseTimer::start(const std::string& name) {
+    stop();
+
+    current = 0;
+    while (current < phases_.size() && phases_[current].name != name) {
+        current++;
+    }
+    if (current == phases_.size()) {
+        phases_.push_back(Phase{name, 0, 0, 0, 0, 0});
+    }
+    if (AllocationTracker::enabled()) {
+        AllocationTracker::reset_peak();
+    }
+    allocations_start = AllocationTracker::totals();
+    wall_start = std::chrono::steady_clock::now();
+    cpu_start = cpu_time();
+}
+
+void
+PhaseTimer::stop() {
+    if (current >= phases_.size()) {
+        return;
+    }
+
+    const auto wall_end = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> wall = wall_end - wall_start;
+    phases_[current].wall += wall.count();
+    phases_[current].cpu += cpu_time() - cpu_start;
+    const AllocationTracker::Totals allocated =
+        AllocationTracker::totals().since(allocations_start);
+    phases_[current].allocations += allocated.allocations;
+    phases_[current].bytes += allocated.bytes;
+    phases_[current].peak = std::max(phases_[current].peak, allocated.peak);
+    if (timeline != nullptr) {
+        timeline->phase(phases_[current].name,
+                        Timeline::nanoseconds(wall_start),
+                        Timeline::nanoseconds(wall_end));
+    }
+    current = phases_.size();
+}
+
+void
+PhaseTimer::use_timeline(Timeline& timeline) {
+    this->timeline = &timeline;
+}
+
+const PhaseTimer::Phase*
+PhaseTimer::find(const std::string& name) const {
+    for (const Phase& phase : phases_) {
+        if (phase.name == name) {
+            return &phase;
+        }
+    }
+    return nullptr;
+}
+
+void
+PhaseTimer::write(std::ostream& os) const {
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+
+    bool allocations = false;
+    for (const Phase& phase : phases_) {
+        allocations = allocations || phase.allocations > 0;
+    }
+    allocations = allocations || AllocationTracker::enabled();
+
+    os << std::left << std::setw(14) << "phase" << std::right
+        << std::setw(12) << "wall (s)" << std::setw(12) << "cpu (s)";
+    if (allocations) {
+        os << std::setw(14) << "allocations" << std::setw(14) << "bytes"
+            << std::setw(14) << "peak bytes";
+    }
+    os << std::endl;
+    os << std::fixed << std::setprecision(3);
+    for (const Phase& phase : phases_) {
+        os << std::left << std::setw(14) << phase.name << std::right
+            << std::setw(12) << phase.wall << std::setw(12) << phase.cpu;
+        if (allocations) {
+            os << std::setw(14) << phase.allocations
+                << std::setw(14) << phase.bytes
+                << std::setw(14) << phase.peak;
+        }
+        os << std::endl;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+double
+PhaseTimer::cpu_time() {
+    struct timespec ts;
+    if (::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+long
+PhaseTimer::peak_rss() {
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    // Kilobytes on Linux
+    return usage.ru_maxrss;
+}
@@ -0,0 +1,117 @@
+#ifndef PHASE_TIMER_H_
+#define PHASE_TIMER_H_
+
+#include "AllocationTracker.h"
+#include "Timeline.h"
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Measures the wall clock and CPU time spent in each phase of a run.
+ *
+ * One phase is current at a time. Starting a phase ends the current one, and
+ * starting a phase again (e.g. once per replication) adds to its times. CPU
+ * time is that of the whole process, so it includes every thread.
+ *
+ * When the AllocationTracker is enabled, each phase also records the heap
+ * allocations made during it and the largest number of bytes live.
+ */
+class PhaseTimer {
+public:
+    struct Phase {
+        std::string name;
+        /* Seconds */
+        double wall;
+        double cpu;
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        std::int64_t peak;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    PhaseTimer();
+
+    // Copy constructor
+    PhaseTimer(const PhaseTimer& other);
+
+    // Destructor
+    ~PhaseTimer();
+
+    // Assignment operator
+    PhaseTimer&
+    operator=(const PhaseTimer& other);
+    /* }}} */
+
+    /**
+     * Ends the current phase, if any, and starts timing `name'.
+     */
+    void
+    start(const std::string& name);
+
+    /**
+     * Ends the current phase, if any.
+     */
+    void
+    stop();
+
+    /**
+     * Also records every phase as a span of the given timeline when it
+     * ends. The timeline must outlive the calls to `stop' and `start'.
+     */
+    void
+    use_timeline(Timeline& timeline);
+
+    /**
+     * \return the phases in the order they were first started.
+     */
+    const std::vector<Phase>&
+    phases() const;
+
+    /**
+     * \return the phase of the given name, or null if it was never started.
+     */
+    const Phase*
+    find(const std::string& name) const;
+
+    /**
+     * Writes a table of the phases, with the allocations if any were
+     * tracked.
+     */
+    void
+    write(std::ostream& os) const;
+
+    /**
+     * \return the CPU time used by the process so far, in seconds.
+     */
+    static double
+    cpu_time();
+
+    /**
+     * \return the largest resident set size of the process so far, in
+     *         kilobytes.
+     */
+    static long
+    peak_rss();
+
+private:
+    std::vector<Phase> phases_;
+    /* Index of the current phase in phases_, or phases_.size() if none */
+    std::size_t current;
+    std::chrono::steady_clock::time_point wall_start;
+    double cpu_start;
+    AllocationTracker::Totals allocations_start;
+    Timeline* timeline;
+};
+
+/* Inlined methods */
+inline const std::vector<PhaseTimer::Phase>&
+PhaseTimer::phases() const {
+    return phases_;
+}
+
+#endif /* end of include guard */
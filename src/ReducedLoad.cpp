@@ -0,0 +1,621 @@
+#include "ReducedLoad.h"
+
+#include "Erlang.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+/* Keeps the iterates away from 1, where the thinning divides by zero */
+const double MAX_VALUE = 1 - 1e-12;
+
+/* Route of a destination next to the source */
+const unsigned NO_PARENT = ~0u;
+
+/* Sources are split into this many blocks, whatever the number of threads */
+const unsigned NUM_BLOCKS = 16;
+
+/* Below this many routes, an iteration takes less time than waking threads */
+const unsigned long MIN_PARALLEL_ROUTES = 1 << 15;
+
+/**
+ * \return base to the power of exponent, by squaring.
+ */
+double
+power(double base, unsigned exponent) {
+    double result = 1;
+    while (exponent != 0) {
+        if (exponent & 1) {
+            result *= base;
+        }
+        base *= base;
+        exponent >>= 1;
+    }
+    return result;
+}
+
+/**
+ * Threads that run the parts of a loop. They are started once and woken
+ * for every loop, so that an iteration of the fixed point does not pay for
+ * creating threads.
+ */
+class Workers {
+public:
+    /**
+     * \param[in] threads the number of threads, including the caller of
+     *                    `run'.
+     */
+    explicit Workers(const unsigned threads)
+        : task{nullptr}
+        , n{0}
+        , next{0}
+        , generation{0}
+        , busy{0}
+        , stopping{false}
+    {
+        for (unsigned i = 1; i < threads; i++) {
+            helpers.emplace_back(&Workers::loop, this);
+        }
+    }
+
+    Workers(const Workers&) = delete;
+
+    ~Workers() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+    }
+
+    Workers&
+    operator=(const Workers&) = delete;
+
+    /**
+     * Calls f(i) for every i in [0, n), spread over the threads, and returns
+     * once all the calls are done.
+     */
+    void
+    run(const unsigned long n, const std::function<void(unsigned long)>& f) {
+        if (helpers.empty()) {
+            for (unsigned long i = 0; i < n; i++) {
+                f(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            task = &f;
+            this->n = n;
+            next = 0;
+            busy = helpers.size();
+            generation++;
+        }
+        wake.notify_all();
+        work();
+
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [this]() { return busy == 0; });
+    }
+
+private:
+    void
+    loop() {
+        unsigned long seen = 0;
+        std::unique_lock<std::mutex> lock{mutex};
+        while (true) {
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            lock.unlock();
+            work();
+            lock.lock();
+            if (--busy == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    void
+    work() {
+        for (unsigned long i = next++; i < n; i = next++) {
+            (*task)(i);
+        }
+    }
+
+    std::vector<std::thread> helpers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(unsigned long)>* task;
+    unsigned long n;
+    std::atomic<unsigned long> next;
+    unsigned long generation;
+    unsigned busy;
+    bool stopping;
+};
+
+/**
+ * Calls f(begin, end) on about equal parts of [0, n), each in its own
+ * thread.
+ */
+template<typename Function>
+void
+parallel_for(const unsigned long n, const unsigned threads, Function f) {
+    const unsigned long t = std::min<unsigned long>(threads, n);
+    if (t <= 1) {
+        f(0, n);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    const unsigned long chunk = (n + t - 1) / t;
+    for (unsigned long begin = 0; begin < n; begin += chunk) {
+        workers.emplace_back(f, begin, std::min(n, begin + chunk));
+    }
+    for (std::thread& w : workers) {
+        w.join();
+    }
+}
+
+struct TreeEdge {
+    Advisor::vertex_t parent;
+    Advisor::vertex_t vertex;
+    const Link* link;
+};
+
+/**
+ * Records the edges of the BFS tree, in the order their targets were
+ * discovered.
+ */
+struct TreeEdgeRecorder : public boost::default_bfs_visitor {
+    TreeEdgeRecorder(std::vector<TreeEdge>& tree)
+        : tree(tree)
+    { }
+
+    template<typename Edge, typename Graph>
+    void
+    tree_edge(const Edge& e, const Graph& g) const {
+        tree.push_back(TreeEdge{boost::source(e, g), boost::target(e, g),
+                                &g[e]});
+    }
+
+    std::vector<TreeEdge>& tree;
+};
+
+/**
+ * Solves the small dense system a x = b in place with partial pivoting.
+ *
+ * \return false if the system is (numerically) singular.
+ */
+bool
+solve_dense(std::vector<double>& a, std::vector<double>& b) {
+    const unsigned n = b.size();
+    for (unsigned col = 0; col < n; col++) {
+        unsigned pivot = col;
+        for (unsigned row = col + 1; row < n; row++) {
+            if (std::fabs(a[row * n + col]) > std::fabs(a[pivot * n + col])) {
+                pivot = row;
+            }
+        }
+        if (std::fabs(a[pivot * n + col]) < 1e-300) {
+            return false;
+        }
+        for (unsigned k = 0; k < n; k++) {
+            std::swap(a[col * n + k], a[pivot * n + k]);
+        }
+        std::swap(b[col], b[pivot]);
+
+        for (unsigned row = col + 1; row < n; row++) {
+            const double factor = a[row * n + col] / a[col * n + col];
+            for (unsigned k = col; k < n; k++) {
+                a[row * n + k] -= factor * a[col * n + k];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+
+    for (unsigned i = n; i-- > 0;) {
+        double sum = b[i];
+        for (unsigned k = i + 1; k < n; k++) {
+            sum -= a[i * n + k] * b[k];
+        }
+        b[i] = sum / a[i * n + i];
+    }
+    return true;
+}
+}
+
+struct ReducedLoad::Workspace {
+    struct Block {
+        /* Indexed like the routes of one source, so they stay in cache */
+        /* Probability that every link of the route is free */
+        std::vector<double> route_free;
+        /* Sum over the routes to the destination and below it in the tree */
+        std::vector<double> subtree;
+
+        /* Sums over the routes of the block */
+        std::vector<double> link_sums;
+        double blocking;
+    };
+
+    Workspace(const unsigned threads,
+              const unsigned num_blocks,
+              const unsigned long routes_per_source,
+              const unsigned long num_links)
+        : workers{threads}
+        , blocks(num_blocks)
+    {
+        for (Block& block : blocks) {
+            block.route_free.resize(routes_per_source);
+            block.subtree.resize(routes_per_source);
+            block.link_sums.resize(num_links);
+        }
+    }
+
+    Workers workers;
+    /* Added in the order of the blocks */
+    std::vector<Block> blocks;
+};
+
+ReducedLoad::Solution::Solution()
+    : blocking{0}
+    , iterations{0}
+    , residual{0}
+    , converged{false}
+{ }
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+ReducedLoad::ReducedLoad(const Advisor::Graph& nodes,
+                         const Model model,
+                         const unsigned threads)
+    : model{model}
+    , threads{threads == 0 ? std::thread::hardware_concurrency() : threads}
+    , damping{0.5}
+    , anderson{3}
+    , tolerance{1e-10}
+    , max_iterations{1000}
+    , num_vertices(boost::num_vertices(nodes))
+    , unreachable{0}
+{
+    if (this->threads == 0) {
+        this->threads = 1;
+    }
+
+    std::unordered_map<const Link*, unsigned> edge_index;
+    boost::graph_traits<Advisor::Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(nodes);
+    for (auto it = e_b; it != e_e; it++) {
+        edge_index[&nodes[*it]] = edges_.size();
+        edges_.push_back(*it);
+        capacities.push_back(nodes[*it].num_wavelengths());
+    }
+
+    // Routes from each source, found in parallel
+    std::vector<std::vector<unsigned>> parents_from(num_vertices);
+    std::vector<std::vector<unsigned>> links_from(num_vertices);
+    std::vector<unsigned long> unreachable_from(num_vertices, 0);
+    parallel_for(num_vertices, this->threads,
+        [&](const unsigned long begin, const unsigned long end) {
+            std::vector<TreeEdge> tree;
+            // Route of each vertex, counted from the first of the source
+            std::vector<unsigned> route_of(num_vertices);
+            for (auto src = begin; src < end; src++) {
+                tree.clear();
+                TreeEdgeRecorder vis{tree};
+                boost::breadth_first_search(nodes, src, boost::visitor(vis));
+
+                // Parents are discovered before their children
+                for (const TreeEdge& edge : tree) {
+                    route_of[edge.vertex] = parents_from[src].size();
+                    parents_from[src].push_back(edge.parent == src
+                                                ? NO_PARENT
+                                                : route_of[edge.parent]);
+                    links_from[src].push_back(edge_index.at(edge.link));
+                }
+                unreachable_from[src] = num_vertices - 1 - tree.size();
+            }
+        });
+
+    source_offsets.push_back(0);
+    for (unsigned src = 0; src < num_vertices; src++) {
+        route_parent.insert(route_parent.end(),
+                            parents_from[src].begin(), parents_from[src].end());
+        route_link.insert(route_link.end(),
+                          links_from[src].begin(), links_from[src].end());
+        source_offsets.push_back(route_parent.size());
+        unreachable += unreachable_from[src];
+    }
+
+    const unsigned num_blocks = std::min(NUM_BLOCKS, num_vertices);
+    for (unsigned b = 0; b <= num_blocks; b++) {
+        block_offsets.push_back(
+            static_cast<unsigned long>(num_vertices) * b / num_blocks);
+    }
+
+    index_capacities();
+}
+
+// Destructor
+ReducedLoad::~ReducedLoad()
+{ }
+/* }}} */
+
+void
+ReducedLoad::set_damping(const double damping) {
+    this->damping = damping;
+}
+
+void
+ReducedLoad::set_anderson(const unsigned depth) {
+    anderson = depth;
+}
+
+void
+ReducedLoad::set_tolerance(const double tolerance) {
+    this->tolerance = tolerance;
+}
+
+void
+ReducedLoad::set_max_iterations(const unsigned max_iterations) {
+    this->max_iterations = max_iterations;
+}
+
+void
+ReducedLoad::set_capacities(const std::vector<unsigned>& capacities) {
+    this->capacities.assign(capacities.begin(), capacities.end());
+    index_capacities();
+}
+
+void
+ReducedLoad::index_capacities() {
+    route_capacity.resize(num_routes());
+    for (unsigned src = 0; src < num_vertices; src++) {
+        const unsigned long first = source_offsets[src];
+        for (auto r = first; r < source_offsets[src + 1]; r++) {
+            unsigned capacity = capacities[route_link[r]];
+            if (route_parent[r] != NO_PARENT) {
+                capacity = std::min(capacity,
+                                    route_capacity[first + route_parent[r]]);
+            }
+            route_capacity[r] = capacity;
+        }
+    }
+}
+
+std::vector<double>
+ReducedLoad::offered_loads(const Solution& solution) const {
+    if (model == CONVERSION) {
+        return solution.link_load;
+    }
+
+    // Carried load back to offered load
+    std::vector<double> offered(solution.link_load.size());
+    for (unsigned long l = 0; l < offered.size(); l++) {
+        offered[l] = solution.link_load[l]
+            / std::max(1 - solution.link_blocking[l], 1e-12);
+    }
+    return offered;
+}
+
+const std::vector<Advisor::edge_t>&
+ReducedLoad::edges() const {
+    return edges_;
+}
+
+unsigned long
+ReducedLoad::num_routes() const {
+    return route_parent.size();
+}
+
+void
+ReducedLoad::update_block(const unsigned block,
+                          const std::vector<double>& x,
+                          Workspace& workspace) const {
+    Workspace::Block& b = workspace.blocks[block];
+    std::fill(b.link_sums.begin(), b.link_sums.end(), 0.0);
+    b.blocking = 0;
+    for (auto src = block_offsets[block]; src < block_offsets[block + 1];
+            src++) {
+        const unsigned long first = source_offsets[src];
+        const unsigned n = source_offsets[src + 1] - first;
+        const unsigned* parents = &route_parent[first];
+        const unsigned* links = &route_link[first];
+
+        // A route is the route to the parent plus one link
+        for (unsigned i = 0; i < n; i++) {
+            const double free = (parents[i] == NO_PARENT
+                                 ? 1
+                                 : b.route_free[parents[i]])
+                * (1 - x[links[i]]);
+            b.route_free[i] = free;
+            if (model == CONVERSION) {
+                b.blocking += 1 - free;
+                b.subtree[i] = free;
+            }
+            else {
+                // No wavelength is free on all the links
+                const double blocking =
+                    power(1 - free, route_capacity[first + i]);
+                b.blocking += blocking;
+                b.subtree[i] = 1 - blocking;
+            }
+        }
+
+        // The routes through the last link of a route are those to its
+        // destination and below, so children are added to their parents
+        for (unsigned i = n; i-- > 0;) {
+            b.link_sums[links[i]] += b.subtree[i];
+            if (parents[i] != NO_PARENT) {
+                b.subtree[parents[i]] += b.subtree[i];
+            }
+        }
+    }
+}
+
+double
+ReducedLoad::update(const std::vector<double>& x,
+                    const double pair_load,
+                    std::vector<double>& next,
+                    std::vector<double>& link_load,
+                    Workspace& workspace) const {
+    workspace.workers.run(workspace.blocks.size(),
+        [&](const unsigned long block) {
+            update_block(block, x, workspace);
+        });
+
+    for (unsigned long l = 0; l < edges_.size(); l++) {
+        double sum = 0;
+        for (const Workspace::Block& b : workspace.blocks) {
+            sum += b.link_sums[l];
+        }
+
+        if (model == CONVERSION) {
+            // Thinned by the other links of the routes
+            link_load[l] = pair_load * sum / (1 - x[l]);
+            next[l] = erlang_b(link_load[l], capacities[l]);
+        }
+        else {
+            // Carried load
+            link_load[l] = pair_load * sum;
+            next[l] = capacities[l] > 0
+                ? std::min(link_load[l] / capacities[l], MAX_VALUE)
+                : MAX_VALUE;
+        }
+    }
+
+    double blocking = 0;
+    for (const Workspace::Block& b : workspace.blocks) {
+        blocking += b.blocking;
+    }
+    return blocking;
+}
+
+ReducedLoad::Solution
+ReducedLoad::solve(const Advisor::event_t lambda,
+                   const Advisor::event_t duration_mean) const {
+    Solution sol;
+    const unsigned long num_links = edges_.size();
+    const double num_pairs = static_cast<double>(num_vertices)
+        * (num_vertices - 1);
+    if (num_pairs <= 0) {
+        return sol;
+    }
+    const double pair_load = lambda / duration_mean / num_pairs;
+
+    std::vector<double> x(num_links, 0);
+    std::vector<double> g(num_links);
+    std::vector<double> f(num_links);
+    sol.link_load.resize(num_links);
+    const unsigned num_blocks = block_offsets.size() - 1;
+    Workspace workspace{num_routes() < MIN_PARALLEL_ROUTES
+                        ? 1
+                        : std::min(threads, num_blocks),
+                        num_blocks, num_vertices - 1, num_links};
+
+    // Previous iterates and residuals for Anderson acceleration
+    std::deque<std::vector<double>> x_hist, f_hist;
+
+    for (sol.iterations = 1; sol.iterations <= max_iterations;
+            sol.iterations++) {
+        update(x, pair_load, g, sol.link_load, workspace);
+
+        sol.residual = 0;
+        for (unsigned long l = 0; l < num_links; l++) {
+            f[l] = g[l] - x[l];
+            sol.residual = std::max(sol.residual, std::fabs(f[l]));
+        }
+        if (sol.residual < tolerance) {
+            x = g;
+            sol.converged = true;
+            break;
+        }
+
+        // Damped step
+        std::vector<double> x_next(num_links);
+        for (unsigned long l = 0; l < num_links; l++) {
+            x_next[l] = x[l] + damping * f[l];
+        }
+
+        const unsigned m = x_hist.size();
+        if (m > 0) {
+            // Least squares fit of the residual by differences with the
+            // previous residuals
+            std::vector<double> a(m * m, 0), b(m, 0);
+            for (unsigned i = 0; i < m; i++) {
+                for (unsigned long l = 0; l < num_links; l++) {
+                    const double df_i = f[l] - f_hist[i][l];
+                    b[i] += df_i * f[l];
+                    for (unsigned j = i; j < m; j++) {
+                        a[i * m + j] += df_i * (f[l] - f_hist[j][l]);
+                    }
+                }
+            }
+            for (unsigned i = 0; i < m; i++) {
+                for (unsigned j = 0; j < i; j++) {
+                    a[i * m + j] = a[j * m + i];
+                }
+                // Regularization
+                a[i * m + i] *= 1 + 1e-10;
+            }
+
+            if (solve_dense(a, b)) {
+                for (unsigned i = 0; i < m; i++) {
+                    for (unsigned long l = 0; l < num_links; l++) {
+                        const double dx = x[l] - x_hist[i][l];
+                        const double df = f[l] - f_hist[i][l];
+                        x_next[l] -= b[i] * (dx + damping * df);
+                    }
+                }
+            }
+        }
+
+        if (anderson > 0) {
+            x_hist.push_front(x);
+            f_hist.push_front(f);
+            if (x_hist.size() > anderson) {
+                x_hist.pop_back();
+                f_hist.pop_back();
+            }
+        }
+
+        for (unsigned long l = 0; l < num_links; l++) {
+            x[l] = std::min(std::max(x_next[l], 0.0), MAX_VALUE);
+        }
+    }
+    if (!sol.converged) {
+        sol.iterations = max_iterations;
+    }
+
+    // Evaluate the routes and links at the final point
+    const double route_blocking =
+        update(x, pair_load, g, sol.link_load, workspace);
+
+    sol.link_blocking.resize(num_links);
+    for (unsigned long l = 0; l < num_links; l++) {
+        if (model == CONVERSION) {
+            sol.link_blocking[l] = x[l];
+        }
+        else {
+            // All the wavelengths are busy
+            sol.link_blocking[l] = std::pow(x[l], capacities[l]);
+        }
+    }
+
+    sol.blocking = (unreachable + route_blocking) / num_pairs;
+
+    return sol;
+}
@@ -0,0 +1,182 @@
+#ifndef REDUCED_LOAD_H_
+#define REDUCED_LOAD_H_
+
+#include "Advisor.h"
+
+#include <vector>
+
+/**
+ * Analytic approximation of the network blocking probability by the reduced
+ * load (Erlang fixed point) method.
+ *
+ * Every ordered pair of nodes is offered lambda / (mu V (V - 1)) Erlangs
+ * over a fixed route, the path that the simulator finds first in an empty
+ * network (i.e. the BFS tree path). Links are assumed to block
+ * independently, and the traffic offered to a link is thinned by the
+ * blocking on the other links of each route. The capacity of each link is
+ * taken from the graph, so links may have different numbers of wavelengths.
+ *
+ * Two models are available:
+ *
+ * - CONVERSION: every node converts wavelengths. Link e blocks with
+ *   B_e = E(rho_e, W_e), where rho_e is the reduced load.
+ *
+ * - CONTINUITY: a connection needs the same wavelength on every link. Each
+ *   wavelength of link e is busy with probability u_e (the carried load
+ *   divided by W_e), independently, and a route is blocked if no wavelength
+ *   is free on all of its links.
+ *
+ * The fixed point is found by damped iteration, optionally accelerated with
+ * Anderson mixing. The routes from a source form its BFS tree, so each
+ * iteration evaluates a route from the route to the parent of its
+ * destination, and sums the loads of the links by subtree, with constant
+ * work per route. Sources are split into a fixed number of blocks, run by
+ * threads that are started once per `solve' (and not at all for small
+ * networks), so the result does not depend on the number of threads.
+ */
+class ReducedLoad {
+public:
+    enum Model { CONVERSION, CONTINUITY };
+
+    struct Solution {
+        Solution();
+
+        /* Indexed like `edges()' */
+        std::vector<double> link_blocking;
+        std::vector<double> link_load;
+        /* Average over all ordered pairs */
+        double blocking;
+        unsigned iterations;
+        double residual;
+        bool converged;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    /**
+     * Finds the routes between all pairs of nodes.
+     *
+     * \param[in] threads the number of threads to use. 0 uses one per
+     *                    hardware thread.
+     */
+    ReducedLoad(const Advisor::Graph& nodes,
+                const Model model,
+                const unsigned threads = 0);
+
+    // Destructor
+    ~ReducedLoad();
+    /* }}} */
+
+    /**
+     * \param[in] damping the weight of the new iterate, in (0, 1].
+     */
+    void
+    set_damping(const double damping);
+
+    /**
+     * \param[in] depth the number of previous iterates used by Anderson
+     *                  acceleration. 0 disables it.
+     */
+    void
+    set_anderson(const unsigned depth);
+
+    void
+    set_tolerance(const double tolerance);
+
+    void
+    set_max_iterations(const unsigned max_iterations);
+
+    /**
+     * Replaces the number of wavelengths of each link (indexed like
+     * `edges()') without finding the routes again.
+     */
+    void
+    set_capacities(const std::vector<unsigned>& capacities);
+
+    /**
+     * Solves the fixed point for the given traffic. Parameters are the same
+     * as those of Advisor.
+     */
+    ReducedLoad::Solution
+    solve(const Advisor::event_t lambda,
+          const Advisor::event_t duration_mean) const;
+
+    /**
+     * \return the load offered to each link (indexed like `edges()') in the
+     *         given solution, i.e. the load an isolated link would need to
+     *         see the same blocking.
+     */
+    std::vector<double>
+    offered_loads(const Solution& solution) const;
+
+    /**
+     * \return the edges of the graph in the order used by the solution.
+     */
+    const std::vector<Advisor::edge_t>&
+    edges() const;
+
+    /**
+     * \return the number of ordered pairs that have a route.
+     */
+    unsigned long
+    num_routes() const;
+
+private:
+    /* Threads and buffers of one `solve' */
+    struct Workspace;
+
+    /**
+     * Computes one application of the fixed point map: `next' is F(`x').
+     *
+     * \return the sum of the blocking probabilities of the routes at `x'.
+     */
+    double
+    update(const std::vector<double>& x,
+           const double pair_load,
+           std::vector<double>& next,
+           std::vector<double>& link_load,
+           Workspace& workspace) const;
+
+    /**
+     * Evaluates the routes from the sources of one block. Sums, for each
+     * link, how free (CONVERSION) or unblocked (CONTINUITY) the routes
+     * through it are, and the blocking of the routes.
+     */
+    void
+    update_block(const unsigned block,
+                 const std::vector<double>& x,
+                 Workspace& workspace) const;
+
+    /**
+     * Recomputes the smallest capacity on each route.
+     */
+    void
+    index_capacities();
+
+    Model model;
+    unsigned threads;
+    double damping;
+    unsigned anderson;
+    double tolerance;
+    unsigned max_iterations;
+
+    unsigned num_vertices;
+    std::vector<Advisor::edge_t> edges_;
+    std::vector<double> capacities;
+    /* Routes of source s are [source_offsets[s], source_offsets[s + 1]), in
+     * the order the BFS found their destinations */
+    std::vector<unsigned long> source_offsets;
+    /* Route to the parent of the destination, an earlier route of the same
+     * source counted from its first, or NO_PARENT if the parent is the
+     * source */
+    std::vector<unsigned> route_parent;
+    /* Last link of each route, the one into the destination */
+    std::vector<unsigned> route_link;
+    /* Smallest capacity on each route */
+    std::vector<unsigned> route_capacity;
+    /* Blocks of sources are [block_offsets[b], block_offsets[b + 1]) */
+    std::vector<unsigned> block_offsets;
+    /* Ordered pairs without any route */
+    unsigned long unreachable;
+};
+
+#endif /* end of include guard */
@@ -0,0 +1,119 @@
+#include "Replay.h"
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+const char MAGIC[8] = {'E', 'B', 'M', 'A', 'R', 'R', 'I', 'V'};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t count;
+};
+static_assert(sizeof(Header) % alignof(Replay::Arrival) == 0,
+              "arrivals would be misaligned");
+static_assert(sizeof(Replay::Arrival) == 24,
+              "unexpected padding in arrivals");
+}
+
+const std::uint32_t Replay::VERSION = 1;
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+Replay::Replay()
+    : arrivals{nullptr}
+    , size_{0}
+{ }
+
+// Destructor
+Replay::~Replay()
+{ }
+/* }}} */
+
+bool
+Replay::load(const std::string& filename) {
+    mapping.reset();
+    arrivals = nullptr;
+    size_ = 0;
+
+    auto file = std::make_shared<MappedFile>(filename);
+    if (!file->good()) {
+        error_ = "cannot open " + filename;
+        return false;
+    }
+
+    Header header;
+    if (file->size() < sizeof(header)) {
+        error_ = filename + ": truncated header";
+        return false;
+    }
+    std::copy(file->data(), file->data() + sizeof(header),
+              reinterpret_cast<char*>(&header));
+    if (!std::equal(MAGIC, MAGIC + sizeof(MAGIC), header.magic)) {
+        error_ = filename + ": not an arrival file";
+        return false;
+    }
+    if (header.version != VERSION || header.record_size != sizeof(Arrival)) {
+        error_ = filename + ": unsupported version or byte order";
+        return false;
+    }
+    if ((file->size() - sizeof(header)) / sizeof(Arrival) < header.count) {
+        error_ = filename + ": truncated";
+        return false;
+    }
+
+    arrivals = reinterpret_cast<const Arrival*>(file->data() + sizeof(header));
+    size_ = header.count;
+    mapping = file;
+    return true;
+}
+
+bool
+Replay::check(const unsigned num_vertices) {
+    double last = 0;
+    for (std::size_t i = 0; i < size_; i++) {
+        const Arrival& a = arrivals[i];
+        std::string problem;
+        if (a.src >= num_vertices || a.dst >= num_vertices) {
+            problem = "vertex out of range";
+        }
+        else if (a.src == a.dst) {
+            problem = "same source and destination";
+        }
+        else if (!(a.time >= last)) {
+            problem = "arrival earlier than the previous one";
+        }
+        else if (!(a.holding >= 0)) {
+            problem = "negative holding time";
+        }
+
+        if (!problem.empty()) {
+            std::ostringstream oss;
+            oss << "arrival " << i << ": " << problem;
+            error_ = oss.str();
+            return false;
+        }
+        last = a.time;
+    }
+    return true;
+}
+
+bool
+Replay::write(const std::string& filename,
+              const std::vector<Arrival>& arrivals) {
+    std::ofstream ofs{filename, std::ios::out | std::ios::binary};
+    Header header;
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    header.version = VERSION;
+    header.record_size = sizeof(Arrival);
+    header.count = arrivals.size();
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(arrivals.data()),
+              arrivals.size() * sizeof(Arrival));
+    return static_cast<bool>(ofs);
+}
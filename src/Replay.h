@@ -0,0 +1,108 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+/**
+ * A recorded sequence of connection requests, read from a binary file.
+ *
+ * The file is memory-mapped and its arrivals are used in place, so replaying
+ * a workload takes no parsing and no copying. Replaying the same file with
+ * different settings (e.g. with and without converters) compares them on
+ * exactly the same connections.
+ *
+ * The file starts with a header (magic, version, record size and number of
+ * arrivals) followed by the arrivals in the byte order of the machine.
+ */
+class Replay {
+public:
+    static const std::uint32_t VERSION;
+
+    struct Arrival {
+        /* Absolute time of the request */
+        double time;
+        std::uint32_t src;
+        std::uint32_t dst;
+        /* How long the connection is held if it is accepted */
+        double holding;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    Replay();
+
+    // Destructor
+    ~Replay();
+    /* }}} */
+
+    /**
+     * Maps an arrival file.
+     *
+     * \return true on success. On failure, `error()' describes the problem.
+     */
+    bool
+    load(const std::string& filename);
+
+    /**
+     * Checks that the arrivals are in order of time, have non-negative
+     * holding times and are between distinct vertices below `num_vertices'.
+     *
+     * \return true if all the arrivals are valid, false otherwise.
+     */
+    bool
+    check(const unsigned num_vertices);
+
+    /**
+     * Writes arrivals in the format read by `load'.
+     *
+     * \return true on success, false otherwise.
+     */
+    static bool
+    write(const std::string& filename, const std::vector<Arrival>& arrivals);
+
+    const Arrival*
+    begin() const;
+
+    const Arrival*
+    end() const;
+
+    std::size_t
+    size() const;
+
+    const std::string&
+    error() const;
+
+private:
+    std::shared_ptr<MappedFile> mapping;
+    const Arrival* arrivals;
+    std::size_t size_;
+    std::string error_;
+};
+
+/* Inlined methods */
+inline const Replay::Arrival*
+Replay::begin() const {
+    return arrivals;
+}
+
+inline const Replay::Arrival*
+Replay::end() const {
+    return arrivals + size_;
+}
+
+inline std::size_t
+Replay::size() const {
+    return size_;
+}
+
+inline const std::string&
+Replay::error() const {
+    return error_;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,276 @@
+#include "ResultCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+/**
+ * Holds an exclusive lock on a file for as long as it exists.
+ */
+class FileLock {
+public:
+    explicit FileLock(const std::string& filename)
+        : fd{::open(filename.c_str(), O_RDWR | O_CREAT, 0666)}
+    {
+        if (fd >= 0 && ::flock(fd, LOCK_EX) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    ~FileLock() {
+        if (fd >= 0) {
+            ::flock(fd, LOCK_UN);
+            ::close(fd);
+        }
+    }
+
+    bool
+    good() const {
+        return fd >= 0;
+    }
+
+private:
+    int fd;
+};
+
+/**
+ * Reads the elements of a column file past those already in `column'. If
+ * the file has fewer, `column' is cut back to them.
+ */
+template<typename Column>
+void
+read_column(const std::string& filename, Column& column) {
+    using T = typename Column::value_type;
+    std::ifstream ifs{filename,
+                      std::ios::in | std::ios::binary | std::ios::ate};
+    const std::size_t rows = ifs
+        ? static_cast<std::size_t>(ifs.tellg()) / sizeof(T)
+        : 0;
+    const std::size_t first = column.size();
+    if (rows <= first) {
+        column.resize(rows);
+        return;
+    }
+
+    column.resize(rows);
+    ifs.seekg(first * sizeof(T));
+    ifs.read(reinterpret_cast<char*>(&column[first]),
+             (rows - first) * sizeof(T));
+    column.resize(first + ifs.gcount() / sizeof(T));
+}
+
+/**
+ * \return the number of elements of `width' bytes in a column file.
+ */
+std::size_t
+column_rows(const std::string& filename, const std::size_t width) {
+    struct stat st;
+    return ::stat(filename.c_str(), &st) == 0 ? st.st_size / width : 0;
+}
+
+template<typename T>
+bool
+append(const std::string& filename, const T* data, const std::size_t size) {
+    std::ofstream ofs{filename,
+                      std::ios::out | std::ios::binary | std::ios::app};
+    ofs.write(reinterpret_cast<const char*>(data), size * sizeof(T));
+    ofs.close();
+    return static_cast<bool>(ofs);
+}
+
+/**
+ * Cuts a column file back to `rows' elements of `width' bytes.
+ */
+bool
+truncate_column(const std::string& filename, const std::size_t rows,
+                const std::size_t width) {
+    struct stat st;
+    if (::stat(filename.c_str(), &st) != 0) {
+        return errno == ENOENT && rows == 0;
+    }
+    if (static_cast<std::size_t>(st.st_size) == rows * width) {
+        return true;
+    }
+    return ::truncate(filename.c_str(), rows * width) == 0;
+}
+}
+
+const unsigned ResultCache::VERSION;
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+ResultCache::ResultCache()
+{ }
+
+// Destructor
+ResultCache::~ResultCache()
+{ }
+/* }}} */
+
+std::uint64_t
+ResultCache::hash(const void* data, const std::size_t size,
+                  std::uint64_t hash) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++) {
+        hash = (hash ^ p[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string
+ResultCache::key(const std::string& description, const unsigned version) {
+    return "v" + std::to_string(version) + ' ' + description;
+}
+
+std::string
+ResultCache::path(const std::string& column) const {
+    return directory + "/" + column;
+}
+
+bool
+ResultCache::open(const std::string& directory) {
+    this->directory = directory;
+    if (::mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+        error_ = "cannot create " + directory;
+        return false;
+    }
+
+    FileLock lock{path("lock")};
+    if (!lock.good()) {
+        error_ = "cannot lock " + path("lock");
+        return false;
+    }
+    return load();
+}
+
+bool
+ResultCache::load() {
+    // The key of a row is written last, so no row was completed since the
+    // last call if its column has as many as are already read
+    const std::size_t old_rows = keys.size();
+    if (column_rows(path("key.u64"), 8) == old_rows) {
+        return true;
+    }
+
+    read_column(path("key.u64"), keys);
+    read_column(path("scenario_end.u64"), scenario_ends);
+    read_column(path("replications.u64"), replications);
+    read_column(path("connections.u64"), connections);
+    read_column(path("blocked.u64"), blocked);
+    read_column(path("sum_blocking.f64"), sum_blocking);
+    read_column(path("sum_blocking_sq.f64"), sum_blocking_sq);
+    read_column(path("scenarios.txt"), scenarios);
+
+    // Rows that are complete in every column
+    std::size_t rows = std::min({keys.size(), scenario_ends.size(),
+                                 replications.size(), connections.size(),
+                                 blocked.size(), sum_blocking.size(),
+                                 sum_blocking_sq.size()});
+    while (rows > 0 && scenario_ends[rows - 1] > scenarios.size()) {
+        rows--;
+    }
+    keys.resize(rows);
+    scenario_ends.resize(rows);
+    replications.resize(rows);
+    connections.resize(rows);
+    blocked.resize(rows);
+    sum_blocking.resize(rows);
+    sum_blocking_sq.resize(rows);
+    scenarios.resize(rows == 0 ? 0 : scenario_ends[rows - 1]);
+
+    // Only the new rows, unless the files were cut back behind our back
+    if (rows < old_rows) {
+        index.clear();
+    }
+    for (std::size_t i = rows < old_rows ? 0 : old_rows; i < rows; i++) {
+        index.emplace(keys[i], i);
+    }
+    return true;
+}
+
+bool
+ResultCache::find(const std::string& scenario,
+                  Shard::Partial& partial) const {
+    const std::uint64_t key = hash(scenario.data(), scenario.size());
+    auto range = index.equal_range(key);
+    for (auto it = range.first; it != range.second; it++) {
+        const std::size_t row = it->second;
+        const std::size_t begin = row == 0 ? 0 : scenario_ends[row - 1];
+        // Guard against collisions
+        if (scenarios.compare(begin, scenario_ends[row] - begin,
+                              scenario) != 0) {
+            continue;
+        }
+
+        partial.replications = replications[row];
+        partial.connections = connections[row];
+        partial.blocked = blocked[row];
+        partial.sum_blocking = sum_blocking[row];
+        partial.sum_blocking_sq = sum_blocking_sq[row];
+        return true;
+    }
+    return false;
+}
+
+bool
+ResultCache::insert(const std::string& scenario,
+                    const Shard::Partial& partial) {
+    FileLock lock{path("lock")};
+    if (!lock.good()) {
+        error_ = "cannot lock " + path("lock");
+        return false;
+    }
+
+    // Pick up the rows other processes appended since the last time, and
+    // drop incomplete ones
+    load();
+    const std::size_t rows = keys.size();
+    bool ok = truncate_column(path("key.u64"), rows, 8)
+        && truncate_column(path("scenario_end.u64"), rows, 8)
+        && truncate_column(path("replications.u64"), rows, 8)
+        && truncate_column(path("connections.u64"), rows, 8)
+        && truncate_column(path("blocked.u64"), rows, 8)
+        && truncate_column(path("sum_blocking.f64"), rows, 8)
+        && truncate_column(path("sum_blocking_sq.f64"), rows, 8)
+        && truncate_column(path("scenarios.txt"), scenarios.size(), 1);
+    if (!ok) {
+        error_ = "cannot repair " + directory;
+        return false;
+    }
+
+    const std::uint64_t key = hash(scenario.data(), scenario.size());
+    const std::uint64_t end = scenarios.size() + scenario.size();
+    const std::uint64_t values[] = {
+        partial.replications, partial.connections, partial.blocked};
+    // The key goes last, so that a row is only complete once it is written
+    ok = append(path("scenarios.txt"), scenario.data(), scenario.size())
+        && append(path("scenario_end.u64"), &end, 1)
+        && append(path("replications.u64"), &values[0], 1)
+        && append(path("connections.u64"), &values[1], 1)
+        && append(path("blocked.u64"), &values[2], 1)
+        && append(path("sum_blocking.f64"), &partial.sum_blocking, 1)
+        && append(path("sum_blocking_sq.f64"), &partial.sum_blocking_sq, 1)
+        && append(path("key.u64"), &key, 1);
+    if (!ok) {
+        error_ = "cannot write to " + directory;
+        return false;
+    }
+
+    keys.push_back(key);
+    scenario_ends.push_back(end);
+    scenarios += scenario;
+    replications.push_back(values[0]);
+    connections.push_back(values[1]);
+    blocked.push_back(values[2]);
+    sum_blocking.push_back(partial.sum_blocking);
+    sum_blocking_sq.push_back(partial.sum_blocking_sq);
+    index.emplace(key, keys.size() - 1);
+    return true;
+}
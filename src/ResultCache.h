@@ -0,0 +1,132 @@
+#ifndef RESULT_CACHE_H_
+#define RESULT_CACHE_H_
+
+#include "Shard.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Results of previously simulated scenarios, kept in a directory.
+ *
+ * A scenario is a string describing everything that determines the result
+ * (topology hash, parameters, seed, ...); it is found by its hash. Each field
+ * of the results is a column in its own append-only file, and the column of
+ * hashes serves as the index. Appends are serialized between processes with
+ * a lock file, and columns left uneven by an interrupted append are cut back
+ * to the last complete row. Before appending, only the rows other processes
+ * appended in the meantime are read.
+ */
+class ResultCache {
+public:
+    /**
+     * Version of the simulator's results, part of every key made by `key'.
+     * Must be increased by every change that can make the same scenario give
+     * a different result (e.g. how wavelengths are chosen), so that results
+     * of older versions are no longer found.
+     */
+    static const unsigned VERSION = 6;
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    ResultCache();
+
+    // Destructor
+    ~ResultCache();
+    /* }}} */
+
+    /**
+     * Opens the cache in `directory', creating it if needed, and reads its
+     * index.
+     *
+     * \return true on success. On failure, `error()' describes the problem.
+     */
+    bool
+    open(const std::string& directory);
+
+    /**
+     * \return true and the stored result if the scenario is in the cache,
+     *         false otherwise.
+     */
+    bool
+    find(const std::string& scenario, Shard::Partial& partial) const;
+
+    /**
+     * Appends the result of a scenario.
+     *
+     * \return true on success. On failure, `error()' describes the problem.
+     */
+    bool
+    insert(const std::string& scenario, const Shard::Partial& partial);
+
+    /**
+     * \return the number of results in the cache.
+     */
+    std::size_t
+    size() const;
+
+    const std::string&
+    error() const;
+
+    /**
+     * \return the scenario to store the results of `description' under, for
+     *         the given version of the simulator.
+     */
+    static std::string
+    key(const std::string& description, const unsigned version = VERSION);
+
+    /**
+     * \return the 64-bit FNV-1a hash of `size' bytes, continuing from `hash'.
+     */
+    static std::uint64_t
+    hash(const void* data,
+         const std::size_t size,
+         std::uint64_t hash = 14695981039346656037ull);
+
+private:
+    /**
+     * Reads the rows appended since the last call, if any, and adds them to
+     * the index. Must be called with the lock held, or when nothing else can
+     * append.
+     */
+    bool
+    load();
+
+    /**
+     * \return the file of a column.
+     */
+    std::string
+    path(const std::string& column) const;
+
+    std::string directory;
+
+    /* Columns, one element per row */
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint64_t> scenario_ends;
+    std::string scenarios;
+    std::vector<std::uint64_t> replications;
+    std::vector<std::uint64_t> connections;
+    std::vector<std::uint64_t> blocked;
+    std::vector<double> sum_blocking;
+    std::vector<double> sum_blocking_sq;
+
+    /* Rows of each hash */
+    std::unordered_multimap<std::uint64_t, std::size_t> index;
+    std::string error_;
+};
+
+/* Inlined methods */
+inline std::size_t
+ResultCache::size() const {
+    return keys.size();
+}
+
+inline const std::string&
+ResultCache::error() const {
+    return error_;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,172 @@
+#include "Shard.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+
+namespace {
+/* First line of every partial statistics file */
+const char* const MAGIC = "erlang-b-model-partial";
+const unsigned VERSION = 2;
+}
+
+Shard::Partial::Partial()
+    : replications{0}
+    , connections{0}
+    , blocked{0}
+    , sum_blocking{0}
+    , sum_blocking_sq{0}
+{ }
+
+void
+Shard::Partial::add(const Simulator::Result& result) {
+    const double pb = result.blocking();
+
+    replications++;
+    connections += result.connections;
+    blocked += result.blocked;
+    sum_blocking += pb;
+    sum_blocking_sq += pb * pb;
+}
+
+void
+Shard::Partial::merge(const Partial& other) {
+    replications += other.replications;
+    connections += other.connections;
+    blocked += other.blocked;
+    sum_blocking += other.sum_blocking;
+    sum_blocking_sq += other.sum_blocking_sq;
+}
+
+double
+Shard::Partial::blocking() const {
+    if (connections == 0) {
+        return 0;
+    }
+    return static_cast<double>(blocked) / connections;
+}
+
+double
+Shard::Partial::std_error() const {
+    if (replications < 2) {
+        return 0;
+    }
+
+    const double n = replications;
+    const double mean = sum_blocking / n;
+    const double var = (sum_blocking_sq - n * mean * mean) / (n - 1);
+    return var > 0 ? std::sqrt(var / n) : 0;
+}
+
+void
+Shard::Partial::write(std::ostream& os,
+                      const std::string& scenario,
+                      const Shard& shard) const {
+    const auto precision = os.precision();
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    os << MAGIC << " " << VERSION << std::endl;
+    os << "scenario " << scenario << std::endl;
+    os << "shard " << shard.index() << "/" << shard.count() << std::endl;
+    os << "replications " << replications << std::endl;
+    os << "connections " << connections << std::endl;
+    os << "blocked " << blocked << std::endl;
+    os << "sum_blocking " << sum_blocking << std::endl;
+    os << "sum_blocking_sq " << sum_blocking_sq << std::endl;
+    os.precision(precision);
+}
+
+bool
+Shard::Partial::read(std::istream& is,
+                     Partial& partial,
+                     std::string& scenario,
+                     Shard& shard) {
+    std::string magic, key;
+    unsigned version;
+    is >> magic >> version;
+    if (!is || magic != MAGIC || version != VERSION) {
+        return false;
+    }
+
+    // The rest of the line, without the space after the key
+    std::string s;
+    is >> key;
+    std::getline(is, s);
+    if (key != "scenario" || s.empty()) {
+        return false;
+    }
+    s.erase(0, 1);
+
+    Shard sh;
+    std::string spec;
+    is >> key >> spec;
+    if (key != "shard" || !Shard::parse(spec, sh)) {
+        return false;
+    }
+
+    Partial p;
+    is >> key >> p.replications;
+    if (key != "replications") {
+        return false;
+    }
+    is >> key >> p.connections;
+    if (key != "connections") {
+        return false;
+    }
+    is >> key >> p.blocked;
+    if (key != "blocked") {
+        return false;
+    }
+    is >> key >> p.sum_blocking;
+    if (key != "sum_blocking") {
+        return false;
+    }
+    is >> key >> p.sum_blocking_sq;
+    if (key != "sum_blocking_sq" || is.fail()) {
+        return false;
+    }
+
+    partial = p;
+    scenario = s;
+    shard = sh;
+    return true;
+}
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+Shard::Shard()
+    : index_{0}
+    , count_{1}
+{ }
+
+Shard::Shard(const unsigned index, const unsigned count)
+    : index_{index}
+    , count_{count}
+{ }
+/* }}} */
+
+bool
+Shard::parse(const std::string& spec, Shard& shard) {
+    const auto slash = spec.find('/');
+    if (slash == std::string::npos || slash == 0
+            || slash + 1 == spec.size()) {
+        return false;
+    }
+
+    const std::string i_str = spec.substr(0, slash);
+    const std::string n_str = spec.substr(slash + 1);
+    const std::string digits = "0123456789";
+    if (i_str.find_first_not_of(digits) != std::string::npos
+            || n_str.find_first_not_of(digits) != std::string::npos) {
+        return false;
+    }
+
+    const unsigned long i = std::strtoul(i_str.c_str(), nullptr, 10);
+    const unsigned long n = std::strtoul(n_str.c_str(), nullptr, 10);
+    if (n == 0 || i >= n) {
+        return false;
+    }
+
+    shard = Shard(i, n);
+    return true;
+}
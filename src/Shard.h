@@ -0,0 +1,126 @@
+#ifndef SHARD_H_
+#define SHARD_H_
+
+#include "Simulator.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+/**
+ * One of `count' disjoint slices of a set of independent replications.
+ * Replication r belongs to shard (r mod count), so every process that is
+ * given the same base seed runs exactly the same replications regardless of
+ * how many other shards exist on the same or other machines.
+ */
+class Shard {
+public:
+    /**
+     * Statistics of all the replications that one (or more, after merging)
+     * shard ran. Counts are kept as integers so that the pooled blocking
+     * probability does not depend on how the replications were split.
+     */
+    struct Partial {
+        Partial();
+
+        /**
+         * Adds the result of one replication.
+         */
+        void
+        add(const Simulator::Result& result);
+
+        /**
+         * Adds all the replications of another partial.
+         */
+        void
+        merge(const Partial& other);
+
+        /**
+         * \return the pooled blocking probability of all the connections.
+         */
+        double
+        blocking() const;
+
+        /**
+         * \return the standard error of the per-replication blocking
+         *         probability, or 0 if there are fewer than two replications.
+         */
+        double
+        std_error() const;
+
+        /**
+         * Writes the statistics in a line-based text format that can be
+         * read back with `read', along with the shard that ran them and a
+         * description of the scenario (one line), so that only partials of
+         * the same scenario are merged.
+         */
+        void
+        write(std::ostream& os,
+              const std::string& scenario,
+              const Shard& shard) const;
+
+        /**
+         * \return true if a partial was read successfully, false otherwise.
+         */
+        static bool
+        read(std::istream& is,
+             Partial& partial,
+             std::string& scenario,
+             Shard& shard);
+
+        unsigned long replications;
+        unsigned long connections;
+        unsigned long blocked;
+        double sum_blocking;
+        double sum_blocking_sq;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor: a single shard that owns everything
+    Shard();
+
+    Shard(const unsigned index, const unsigned count);
+    /* }}} */
+
+    /**
+     * Parses a shard specification of the form "i/N" with 0 <= i < N.
+     *
+     * \return true if the specification is valid, false otherwise.
+     */
+    static bool
+    parse(const std::string& spec, Shard& shard);
+
+    /**
+     * \return true if the given replication is run by this shard.
+     */
+    bool
+    owns(const unsigned replication) const;
+
+    unsigned
+    index() const;
+
+    unsigned
+    count() const;
+
+private:
+    unsigned index_;
+    unsigned count_;
+};
+
+/* Inlined methods */
+inline bool
+Shard::owns(const unsigned replication) const {
+    return replication % count_ == index_;
+}
+
+inline unsigned
+Shard::index() const {
+    return index_;
+}
+
+inline unsigned
+Shard::count() const {
+    return count_;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,638 @@
+#include "Simulator.h"
+
+#include "Counters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+/**
+ * Priority queue of events whose heap can be saved and restored as is, so
+ * that events with equal times come out in the same order after resuming.
+ */
+class EventQueue : public std::priority_queue<Event, std::vector<Event>,
+                                              std::greater<Event>> {
+public:
+    std::vector<Event>&
+    container() {
+        return c;
+    }
+
+    /**
+     * Removes the earliest event, moving it out rather than copying its path.
+     */
+    Event
+    take() {
+        std::pop_heap(c.begin(), c.end(), comp);
+        Event event = std::move(c.back());
+        c.pop_back();
+        return event;
+    }
+};
+}
+
+Simulator::Result::Result()
+    : connections{0}
+    , blocked{0}
+    , events{0}
+{ }
+
+float
+Simulator::Result::blocking() const {
+    if (connections == 0) {
+        return 0;
+    }
+    return static_cast<float>(blocked) / connections;
+}
+
+Simulator::State::State()
+    : ignored{false}
+    , to_ignore{0}
+    , connection_count{0}
+    , success_count{0}
+    , block_count{0}
+    , now{0}
+    , last_arrival{0}
+    , arrival_index{0}
+{ }
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+Simulator::Simulator(Advisor& advisor,
+                     const unsigned limit,
+                     const unsigned ignore_first)
+    : advisor(advisor)
+    , limit{limit}
+    , ignore_first{ignore_first}
+    , control_variate{nullptr}
+    , pair_stats{nullptr}
+    , adaptive_pairs{false}
+    , trace{nullptr}
+    , replay{nullptr}
+    , replication{0}
+    , checkpoint_writer{nullptr}
+    , checkpoint_interval{0}
+    , phase_timer{nullptr}
+    , stats_page{nullptr}
+    , stats_interval{0}
+    , stats_replication{0}
+    , stats_last_events{0}
+    , perf{nullptr}
+    , latency{nullptr}
+    , timeline{nullptr}
+    , timeline_replication{0}
+    , utilization{nullptr}
+    , utilization_replication{0}
+    , resuming{false}
+{ }
+
+// Destructor
+Simulator::~Simulator()
+{ }
+/* }}} */
+
+void
+Simulator::use_control_variate(ControlVariate& cv) {
+    control_variate = &cv;
+}
+
+void
+Simulator::use_pair_stats(PairStats& stats, const bool adaptive) {
+    pair_stats = &stats;
+    adaptive_pairs = adaptive;
+}
+
+void
+Simulator::use_trace(TraceWriter& trace, const unsigned replication) {
+    this->trace = &trace;
+    this->replication = replication;
+}
+
+void
+Simulator::use_replay(const Replay& replay) {
+    this->replay = &replay;
+}
+
+void
+Simulator::use_checkpoints(Checkpoint::Writer& writer,
+                           const unsigned long interval,
+                           std::function<void(Checkpoint&)> header) {
+    checkpoint_writer = &writer;
+    checkpoint_interval = interval;
+    checkpoint_header = header;
+    index_edges();
+}
+
+void
+Simulator::use_phase_timer(PhaseTimer& timer) {
+    phase_timer = &timer;
+}
+
+void
+Simulator::use_stats_page(StatsPage& page,
+                          const unsigned long interval,
+                          const unsigned replication) {
+    stats_page = &page;
+    stats_interval = std::max(interval, 1ul);
+    stats_replication = replication;
+}
+
+void
+Simulator::use_perf_counters(PerfCounters& counters) {
+    perf = &counters;
+}
+
+void
+Simulator::use_event_latency(EventLatency& latency) {
+    this->latency = &latency;
+}
+
+void
+Simulator::use_timeline(Timeline& timeline, const unsigned replication) {
+    this->timeline = &timeline;
+    timeline_replication = replication;
+}
+
+void
+Simulator::use_utilization(Utilization& utilization,
+                           const unsigned replication) {
+    this->utilization = &utilization;
+    utilization_replication = replication;
+}
+
+bool
+Simulator::resume(Checkpoint& checkpoint) {
+    if (!advisor.restore(checkpoint)) {
+        return false;
+    }
+    index_edges();
+
+    State& s = resume_state;
+    std::uint8_t ignored;
+    std::uint64_t num_events;
+    if (!checkpoint.get(ignored)
+            || !checkpoint.get(s.to_ignore)
+            || !checkpoint.get(s.connection_count)
+            || !checkpoint.get(s.success_count)
+            || !checkpoint.get(s.block_count)
+            || !checkpoint.get(s.now)
+            || !checkpoint.get(s.last_arrival)
+            || !checkpoint.get(s.arrival_index)
+            || !checkpoint.get(num_events)) {
+        return false;
+    }
+    s.ignored = ignored != 0;
+    if (replay != nullptr && s.arrival_index > replay->size()) {
+        return false;
+    }
+
+    const Advisor::vertex_t num_vertices = boost::num_vertices(advisor.graph());
+    resume_events.clear();
+    for (std::uint64_t i = 0; i < num_events; i++) {
+        Event event;
+        std::uint64_t src, dst, path_length;
+        std::uint32_t type;
+        if (!checkpoint.get(src) || !checkpoint.get(dst)
+                || !checkpoint.get(type) || !checkpoint.get(event.time)
+                || !checkpoint.get(event.wavelength)
+                || !checkpoint.get(path_length)
+                || src >= num_vertices || dst >= num_vertices
+                || type > Event::DUMMY) {
+            return false;
+        }
+        event.src = src;
+        event.dst = dst;
+        event.type = static_cast<Event::Type>(type);
+        for (std::uint64_t j = 0; j < path_length; j++) {
+            std::uint64_t e;
+            if (!checkpoint.get(e) || e >= edge_list.size()) {
+                return false;
+            }
+            event.path.push_back(edge_list[e]);
+        }
+        resume_events.push_back(std::move(event));
+    }
+
+    resuming = true;
+    return true;
+}
+
+void
+Simulator::save(const State& state,
+                const std::vector<Event>& events,
+                Checkpoint& checkpoint) const {
+    advisor.save(checkpoint);
+
+    checkpoint.put<std::uint8_t>(state.ignored);
+    checkpoint.put(state.to_ignore);
+    checkpoint.put(state.connection_count);
+    checkpoint.put(state.success_count);
+    checkpoint.put(state.block_count);
+    checkpoint.put(state.now);
+    checkpoint.put(state.last_arrival);
+    checkpoint.put(state.arrival_index);
+
+    const Advisor::Graph& g = advisor.graph();
+    checkpoint.put<std::uint64_t>(events.size());
+    for (const Event& event : events) {
+        checkpoint.put<std::uint64_t>(event.src);
+        checkpoint.put<std::uint64_t>(event.dst);
+        checkpoint.put<std::uint32_t>(event.type);
+        checkpoint.put(event.time);
+        checkpoint.put(event.wavelength);
+        checkpoint.put<std::uint64_t>(event.path.size());
+        for (const Advisor::edge_t& e : event.path) {
+            checkpoint.put(edge_index.at(&g[e]));
+        }
+    }
+}
+
+void
+Simulator::publish(const State& state,
+                   const unsigned long events,
+                   const unsigned long active) {
+    const auto wall = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> elapsed = wall - stats_start;
+    const std::chrono::duration<double> since_last = wall - stats_last;
+
+    StatsPage::Snapshot s;
+    s.replication = stats_replication;
+    s.warming_up = !state.ignored;
+    s.elapsed = elapsed.count();
+    s.now = state.now;
+    s.events = events;
+    s.connections = state.ignored ? state.connection_count : 0;
+    s.blocked = state.ignored ? state.block_count : 0;
+    s.active = active;
+    s.blocking = s.connections > 0
+        ? static_cast<double>(s.blocked) / s.connections
+        : 0;
+    // Normal approximation, as if connections were independent
+    s.ci_half_width = s.connections > 0
+        ? 1.96 * std::sqrt(s.blocking * (1 - s.blocking) / s.connections)
+        : 0;
+    s.events_per_second = since_last.count() > 0
+        ? (events - stats_last_events) / since_last.count()
+        : 0;
+    stats_page->publish(s);
+
+    stats_last = wall;
+    stats_last_events = events;
+}
+
+void
+Simulator::index_edges() {
+    const Advisor::Graph& g = advisor.graph();
+    edge_list.clear();
+    edge_index.clear();
+    boost::graph_traits<Advisor::Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(g);
+    for (auto it = e_b; it != e_e; it++) {
+        edge_index[&g[*it]] = edge_list.size();
+        edge_list.push_back(*it);
+    }
+}
+
+void
+Simulator::warm_start(const std::vector<double>& offered_loads) {
+    this->offered_loads = offered_loads;
+}
+
+Simulator::Result
+Simulator::run() {
+    State state;
+    EventQueue pq;
+    if (resuming) {
+        state = resume_state;
+        pq.container() = std::move(resume_events);
+        resuming = false;
+    }
+    bool& ignored = state.ignored;
+    unsigned& to_ignore = state.to_ignore;
+    unsigned& connection_count = state.connection_count;
+    unsigned& success_count = state.success_count;
+    unsigned& block_count = state.block_count;
+    Advisor::event_t& now = state.now;
+    Advisor::event_t& last_arrival = state.last_arrival;
+    if (phase_timer != nullptr) {
+        phase_timer->start(ignored ? "measurement" : "warm-up");
+    }
+    // Distribution of the probes, refreshed every `PROBE_REFRESH' arrivals
+    const unsigned PROBE_REFRESH = 1000;
+    // Edges reserved for each path; longer paths grow their own
+    const std::size_t PATH_CAPACITY = 16;
+    std::discrete_distribution<std::size_t> probe_dist;
+    unsigned probes_since_refresh = PROBE_REFRESH;
+    unsigned long arrivals_since_checkpoint = 0;
+    unsigned long events = 0;
+    // Connections holding a path, i.e. END events in the queue
+    unsigned long active = std::count_if(
+            pq.container().begin(), pq.container().end(),
+            [](const Event& e) { return e.type == Event::END; });
+    unsigned long events_since_publish = 0;
+    if (stats_page != nullptr) {
+        stats_start = std::chrono::steady_clock::now();
+        stats_last = stats_start;
+        stats_last_events = 0;
+    }
+
+    // Next recorded request when replaying
+    const Replay::Arrival* next_arrival = nullptr;
+    const Replay::Arrival* replay_end = nullptr;
+    if (replay != nullptr) {
+        next_arrival = replay->begin() + state.arrival_index;
+        replay_end = replay->end();
+    }
+
+    // Every connection holds at least one wavelength of one edge, so there
+    // are never more of them than wavelengths on all edges. With that many
+    // paths and queue slots ready, nothing is allocated while running.
+    // (Growing the queue would also copy the paths rather than move them.)
+    std::size_t max_connections = 2;
+    boost::graph_traits<Advisor::Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(advisor.graph());
+    for (auto it = e_b; it != e_e; it++) {
+        max_connections += advisor.graph()[*it].wavelengths().size();
+    }
+    pq.container().reserve(max_connections);
+    spare_paths.reserve(max_connections);
+
+    if (pq.empty()) {
+        // 10% of the limit by default, 1% when starting warm
+        const double ignore_ratio = offered_loads.empty() ? 0.1 : 0.01;
+        to_ignore = ignore_first == 0 ? limit * ignore_ratio : ignore_first;
+
+        if (!offered_loads.empty()) {
+            const Advisor::Graph& g = advisor.graph();
+            for (const auto& c : advisor.warm_start(offered_loads)) {
+                const Advisor::edge_t e = std::get<0>(c);
+                std::vector<Advisor::edge_t> path;
+                path.reserve(PATH_CAPACITY);
+                path.push_back(e);
+                pq.push(Event{boost::source(e, g), boost::target(e, g),
+                              Event::END, std::get<2>(c),
+                              std::move(path), std::get<1>(c)});
+                active++;
+            }
+        }
+        if (replay != nullptr) {
+            if (next_arrival != replay_end) {
+                pq.push(Event(std::make_pair(next_arrival->src,
+                                             next_arrival->dst),
+                              Event::START,
+                              next_arrival->time));
+                connection_count++;
+            }
+        }
+        else {
+            pq.push(Event(advisor.get_nodes(),
+                          Event::START,
+                          advisor.get_arrival()));
+            connection_count++;
+        }
+    }
+
+    // Paths of the events already queued count as well
+    while (spare_paths.size() + pq.size() < max_connections) {
+        spare_paths.emplace_back();
+        spare_paths.back().reserve(PATH_CAPACITY);
+    }
+
+    // Next multiple of the sampling interval
+    Advisor::event_t next_sample = 0;
+    if (utilization != nullptr) {
+        next_sample = std::ceil(now / utilization->interval())
+            * utilization->interval();
+    }
+
+    PerfCounters::Scope run_scope{perf, PerfCounters::RUN};
+    if (latency != nullptr) {
+        latency->start();
+    }
+    while (true) {
+        if (connection_count > limit || pq.empty()) {
+            break;
+        }
+        if (connection_count == to_ignore && !ignored) {
+            connection_count = 0;
+            success_count = 0;
+            block_count = 0;
+            ignored = true;
+            if (phase_timer != nullptr) {
+                phase_timer->start("measurement");
+            }
+        }
+
+        if (checkpoint_writer != nullptr
+                && arrivals_since_checkpoint >= checkpoint_interval) {
+            if (next_arrival != nullptr) {
+                state.arrival_index = next_arrival - replay->begin();
+            }
+            checkpoint_header(checkpoint);
+            save(state, pq.container(), checkpoint);
+            checkpoint_writer->submit(std::move(checkpoint));
+            arrivals_since_checkpoint = 0;
+        }
+
+        Counters::maximum(Counters::QUEUE_DEPTH, pq.size());
+        const std::uint64_t event_start =
+            timeline != nullptr ? Timeline::now() : 0;
+        PerfCounters::Scope pop_scope{perf, PerfCounters::QUEUE};
+        Event event = pq.take();
+        pop_scope.close();
+        // Nothing changes between events, so the network is sampled as it
+        // is before this one
+        while (utilization != nullptr && next_sample <= event.time) {
+            utilization->sample(advisor.graph(), utilization_replication,
+                                next_sample);
+            next_sample += utilization->interval();
+        }
+        now = event.time;
+        events++;
+        if (stats_page != nullptr
+                && ++events_since_publish == stats_interval) {
+            publish(state, events, active);
+            events_since_publish = 0;
+        }
+
+        Advisor::vertex_t src = event.src;
+        Advisor::vertex_t dst = event.dst;
+        // Outcome of routing a START, for the timeline
+        Link::wavelength_t routed = Link::NONE;
+        unsigned tried = 0;
+
+        // Only the handling of the event itself is timed, not the queue or
+        // the sampling and publishing above
+        std::uint64_t latency_start =
+            latency != nullptr ? EventLatency::ticks() : 0;
+        switch (event.type) {
+            case Event::START:
+                {
+                    if (pair_stats != nullptr && adaptive_pairs && ignored) {
+                        if (probes_since_refresh == PROBE_REFRESH) {
+                            auto w = pair_stats->neyman_weights();
+                            probe_dist = std::discrete_distribution<
+                                std::size_t>(w.begin(), w.end());
+                            probes_since_refresh = 0;
+                        }
+                        Advisor::vertex_t a, b;
+                        std::tie(a, b) = advisor.get_nodes(probe_dist);
+                        PerfCounters::Scope probe_scope{
+                            perf, PerfCounters::ROUTING};
+                        const bool probe_blocked =
+                            !advisor.has_path_between(a, b);
+                        probe_scope.close();
+                        pair_stats->record(a, b, probe_blocked);
+                        probes_since_refresh++;
+                        // Nor the probe, which is not part of this arrival
+                        if (latency != nullptr) {
+                            latency_start = EventLatency::ticks();
+                        }
+                    }
+
+                    // Reuse the path of a finished connection
+                    std::vector<Advisor::edge_t> path;
+                    if (!spare_paths.empty()) {
+                        path = std::move(spare_paths.back());
+                        spare_paths.pop_back();
+                    }
+
+                    PerfCounters::Scope routing_scope{
+                        perf, PerfCounters::ROUTING};
+                    const Link::wavelength_t wl =
+                        advisor.path_between(src, dst, path);
+                    routing_scope.close();
+                    routed = wl;
+                    tried = advisor.wavelengths_tried();
+                    const std::size_t path_length = path.size();
+                    Advisor::event_t duration = 0;
+                    // Wavelength is Link::NONE on failure
+                    if (wl != Link::NONE) {
+                        PerfCounters::Scope lock_scope{
+                            perf, PerfCounters::LOCKING};
+                        advisor.add_connection(path, wl);
+                        lock_scope.close();
+
+                        // Schedule finishing of connection
+                        duration = next_arrival != nullptr
+                            ? next_arrival->holding
+                            : advisor.get_duration();
+                        PerfCounters::Scope push_scope{
+                            perf, PerfCounters::QUEUE};
+                        pq.push(Event{event.src, event.dst, Event::END,
+                            now + duration, std::move(path), wl});
+                        push_scope.close();
+                        active++;
+                    }
+                    else {
+                        spare_paths.push_back(std::move(path));
+                        PerfCounters::Scope push_scope{
+                            perf, PerfCounters::QUEUE};
+                        pq.push(Event(Event::BLOCK, now));
+                    }
+
+                    if (trace != nullptr) {
+                        TraceWriter::Record r;
+                        r.arrival = now;
+                        r.departure = now + duration;
+                        r.src = src;
+                        r.dst = dst;
+                        r.path_length = path_length;
+                        r.wavelength = wl;
+                        r.flags = (wl == Link::NONE ? TraceWriter::BLOCKED : 0)
+                            | (ignored ? 0 : TraceWriter::WARM_UP);
+                        r.replication = replication;
+                        trace->record(r);
+                    }
+                    if (pair_stats != nullptr && ignored) {
+                        pair_stats->record(src, dst, wl == Link::NONE);
+                    }
+                    if (control_variate != nullptr && ignored) {
+                        control_variate->arrival(now - last_arrival,
+                                                 wl == Link::NONE,
+                                                 duration);
+                    }
+                    last_arrival = now;
+                    arrivals_since_checkpoint++;
+
+                    // Schedule the next recorded connection, if any
+                    if (next_arrival != nullptr) {
+                        if (++next_arrival != replay_end) {
+                            pq.push(Event(std::make_pair(next_arrival->src,
+                                                         next_arrival->dst),
+                                          Event::START,
+                                          next_arrival->time));
+                            connection_count++;
+                        }
+                        break;
+                    }
+
+                    // Schedule connection between two random nodes
+                    Event next(advisor.get_nodes(),
+                               Event::START,
+                               now + advisor.get_arrival());
+                    PerfCounters::Scope push_scope{perf, PerfCounters::QUEUE};
+                    pq.push(std::move(next));
+                    connection_count++;
+                    break;
+                }
+            case Event::END:
+                {
+                    PerfCounters::Scope lock_scope{
+                        perf, PerfCounters::LOCKING};
+                    advisor.remove_connection(event.path, event.wavelength);
+                }
+                spare_paths.push_back(std::move(event.path));
+                success_count++;
+                active--;
+                break;
+            case Event::BLOCK:
+                block_count++;
+                break;
+            default:
+                break;
+        }
+
+        // Only measured events, once the caches are warm
+        if (latency != nullptr && ignored && event.type != Event::BLOCK) {
+            const EventLatency::Kind kind = event.type == Event::END
+                ? EventLatency::END
+                : routed != Link::NONE
+                ? EventLatency::START_ACCEPTED
+                : EventLatency::START_BLOCKED;
+            latency->record(kind, EventLatency::ticks() - latency_start);
+        }
+        if (timeline != nullptr) {
+            const char* type = "BLOCK";
+            Link::wavelength_t wl = routed;
+            if (event.type == Event::START) {
+                type = routed != Link::NONE ? "START" : "START (blocked)";
+            }
+            else if (event.type == Event::END) {
+                type = "END";
+                wl = event.wavelength;
+            }
+            timeline->event(type, event_start, Timeline::now(), src, dst,
+                            tried, wl, timeline_replication, now);
+        }
+    }
+
+    run_scope.close();
+    if (latency != nullptr) {
+        latency->stop();
+    }
+    if (phase_timer != nullptr) {
+        phase_timer->stop();
+    }
+    if (stats_page != nullptr) {
+        publish(state, events, active);
+    }
+
+    Result result;
+    result.connections = connection_count;
+    result.blocked = block_count;
+    result.events = events;
+    return result;
+}
@@ -0,0 +1,285 @@
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include "Advisor.h"
+#include "Checkpoint.h"
+#include "ControlVariate.h"
+#include "Event.h"
+#include "EventLatency.h"
+#include "PairStats.h"
+#include "PerfCounters.h"
+#include "PhaseTimer.h"
+#include "Replay.h"
+#include "StatsPage.h"
+#include "Timeline.h"
+#include "TraceWriter.h"
+#include "Utilization.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class Simulator {
+public:
+    /**
+     * Counters collected during one run of the simulation. Kept as integers
+     * so that results from several runs can be pooled exactly.
+     */
+    struct Result {
+        Result();
+
+        /**
+         * \return the ratio of blocked connections to all connections.
+         */
+        float
+        blocking() const;
+
+        unsigned long connections;
+        unsigned long blocked;
+        /* Events processed, including those of ignored connections */
+        unsigned long events;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    /**
+     * \param[in] advisor the Advisor object that handles random number
+     *                    generation, keeping track of the network state, and
+     *                    finding paths.
+     *
+     * \param[in] limit the total number of connections to observe.
+     *
+     * \param[in] ignore_first the number of connections to ignore. Default to
+     *                         10% of limit.
+     */
+    Simulator(Advisor& advisor,
+              const unsigned limit,
+              const unsigned ignore_first = 0);
+
+    // Destructor
+    ~Simulator();
+    /* }}} */
+
+    /**
+     * Records the measured connections in the given control variate
+     * estimator. The estimator must outlive the calls to `run'.
+     */
+    void
+    use_control_variate(ControlVariate& cv);
+
+    /**
+     * Records every measured connection in the given per-pair counters.
+     * The counters must outlive the calls to `run'.
+     *
+     * \param[in] adaptive if true, every arrival is accompanied by a probe
+     *                     of one more pair, chosen by Neyman allocation over
+     *                     the counters collected so far. A probe only checks
+     *                     whether a path is available and does not change the
+     *                     state of the network; since arrivals are Poisson,
+     *                     it sees the same state as a real connection would.
+     */
+    void
+    use_pair_stats(PairStats& stats, const bool adaptive = false);
+
+    /**
+     * Starts from an approximately stationary network instead of an empty
+     * one (see Advisor::warm_start). Only 1% of the connections are then
+     * ignored by default.
+     *
+     * \param[in] offered_loads the load offered to each link, in the order
+     *                          of boost::edges.
+     */
+    void
+    warm_start(const std::vector<double>& offered_loads);
+
+    /**
+     * Writes a record of every connection, including ignored ones, to the
+     * given trace. The trace must outlive the calls to `run'.
+     *
+     * \param[in] replication the number stored in each record.
+     */
+    void
+    use_trace(TraceWriter& trace, const unsigned replication = 0);
+
+    /**
+     * Takes the connection requests from a recorded sequence instead of
+     * drawing them from the random number generator of the Advisor. The
+     * simulation also ends when the sequence runs out. The replay must
+     * outlive the calls to `run'.
+     */
+    void
+    use_replay(const Replay& replay);
+
+    /**
+     * Saves a checkpoint every `interval' arrivals. Each checkpoint starts
+     * with whatever `header' appends (e.g. the state of the caller), followed
+     * by the state of the Advisor and of the simulation. The state of the
+     * control variate estimator and the per-pair counters is not saved.
+     * The writer must outlive the calls to `run'.
+     */
+    void
+    use_checkpoints(Checkpoint::Writer& writer,
+                    const unsigned long interval,
+                    std::function<void(Checkpoint&)> header);
+
+    /**
+     * Times the part of `run' before the first `ignore_first' connections
+     * have been observed as the phase "warm-up" and the rest as
+     * "measurement". The timer must outlive the calls to `run'.
+     */
+    void
+    use_phase_timer(PhaseTimer& timer);
+
+    /**
+     * Publishes the progress of the simulation to the given page every
+     * `interval' events and at the end of `run'. The page must outlive the
+     * calls to `run'.
+     *
+     * \param[in] replication the number stored in each snapshot.
+     */
+    void
+    use_stats_page(StatsPage& page,
+                   const unsigned long interval,
+                   const unsigned replication = 0);
+
+    /**
+     * Counts the whole event loop and its routing, locking and event queue
+     * sections with the given counters, which must have been opened on the
+     * thread calling `run' and must outlive the calls to `run'.
+     */
+    void
+    use_perf_counters(PerfCounters& counters);
+
+    /**
+     * Records how long processing each measured START and END event takes
+     * (see EventLatency), from dispatching it to scheduling what follows.
+     * Popping the event and the sampling, publishing and probing hooks are
+     * not included. The distributions must outlive the calls to `run'.
+     */
+    void
+    use_event_latency(EventLatency& latency);
+
+    /**
+     * Records in the given timeline how long processing each event took,
+     * for the events it samples or finds slow. The phases show up only if
+     * a PhaseTimer using the same timeline is used as well. The timeline
+     * must outlive the calls to `run'.
+     *
+     * \param[in] replication the number stored with each event.
+     */
+    void
+    use_timeline(Timeline& timeline, const unsigned replication = 0);
+
+    /**
+     * Samples the utilization of the network every `interval()' of
+     * simulated time, including during the warm-up. The series must outlive
+     * the calls to `run'.
+     *
+     * \param[in] replication the number stored with each sample.
+     */
+    void
+    use_utilization(Utilization& utilization, const unsigned replication = 0);
+
+    /**
+     * Restores the state saved in a checkpoint (after its header has been
+     * read), so that the next call to `run' continues exactly where the
+     * saved simulation was.
+     *
+     * \return true on success, false if the checkpoint does not match this
+     *         simulation.
+     */
+    bool
+    resume(Checkpoint& checkpoint);
+
+    /**
+     * Runs the simulation until `limit' connections have been observed.
+     *
+     * \return the counters of the measured (i.e. not ignored) connections.
+     */
+    Simulator::Result
+    run();
+
+private:
+    /**
+     * Everything `run' needs to continue a simulation.
+     */
+    struct State {
+        State();
+
+        bool ignored;
+        unsigned to_ignore;
+        unsigned connection_count;
+        unsigned success_count;
+        unsigned block_count;
+        Advisor::event_t now;
+        Advisor::event_t last_arrival;
+        /* Index of the next recorded request when replaying */
+        std::uint64_t arrival_index;
+    };
+
+    /**
+     * \param[in] events the pending events in the order of the heap.
+     */
+    void
+    save(const State& state,
+         const std::vector<Event>& events,
+         Checkpoint& checkpoint) const;
+
+    /**
+     * Publishes a snapshot to `stats_page'.
+     *
+     * \param[in] active the number of connections holding a path.
+     */
+    void
+    publish(const State& state,
+            const unsigned long events,
+            const unsigned long active);
+
+    /**
+     * Numbers the edges in the order of boost::edges, so that events can
+     * refer to them in checkpoints.
+     */
+    void
+    index_edges();
+
+    Advisor& advisor;
+    unsigned limit;
+    unsigned ignore_first;
+    std::vector<double> offered_loads;
+    ControlVariate* control_variate;
+    PairStats* pair_stats;
+    bool adaptive_pairs;
+    TraceWriter* trace;
+    const Replay* replay;
+    unsigned replication;
+    Checkpoint::Writer* checkpoint_writer;
+    unsigned long checkpoint_interval;
+    std::function<void(Checkpoint&)> checkpoint_header;
+    PhaseTimer* phase_timer;
+    StatsPage* stats_page;
+    unsigned long stats_interval;
+    unsigned stats_replication;
+    /* Wall clock time and events at the start of `run' and at the last
+     * snapshot */
+    std::chrono::steady_clock::time_point stats_start;
+    std::chrono::steady_clock::time_point stats_last;
+    unsigned long stats_last_events;
+    PerfCounters* perf;
+    EventLatency* latency;
+    Timeline* timeline;
+    unsigned timeline_replication;
+    Utilization* utilization;
+    unsigned utilization_replication;
+    /* Reused between checkpoints to avoid allocating */
+    Checkpoint checkpoint;
+    bool resuming;
+    State resume_state;
+    std::vector<Event> resume_events;
+    std::vector<Advisor::edge_t> edge_list;
+    std::unordered_map<const Link*, std::uint64_t> edge_index;
+    /* Paths of finished connections, whose storage is reused */
+    std::vector<std::vector<Advisor::edge_t>> spare_paths;
+};
+
+#endif /* end of include guard */
@@ -0,0 +1,163 @@
+#include "StatsPage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+const char MAGIC[8] = {'E', 'B', 'M', 'S', 'T', 'A', 'T', 'S'};
+}
+
+const std::uint32_t StatsPage::VERSION = 1;
+
+struct StatsPage::Page {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t snapshot_size;
+    /* Odd while the snapshot is being written */
+    std::atomic<std::uint64_t> sequence;
+    Snapshot snapshot;
+};
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+StatsPage::StatsPage()
+    : page{nullptr}
+    , fd{-1}
+    , writable{false}
+    , replications{1}
+    , finished{false}
+    , last()
+{ }
+
+// Destructor
+StatsPage::~StatsPage() {
+    close();
+}
+/* }}} */
+
+bool
+StatsPage::create(const std::string& filename, const unsigned replications) {
+    close();
+
+    fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ::ftruncate(fd, sizeof(Page)) != 0) {
+        close();
+        return false;
+    }
+    void* p = ::mmap(nullptr, sizeof(Page), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    page = static_cast<Page*>(p);
+    writable = true;
+    this->replications = replications;
+    finished = false;
+    last = Snapshot();
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), page->magic);
+    page->version = VERSION;
+    page->snapshot_size = sizeof(Snapshot);
+    page->sequence.store(0, std::memory_order_relaxed);
+    publish(last);
+    return true;
+}
+
+bool
+StatsPage::open(const std::string& filename) {
+    close();
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0 || ::lseek(fd, 0, SEEK_END) < static_cast<off_t>(sizeof(Page))) {
+        close();
+        return false;
+    }
+    void* p = ::mmap(nullptr, sizeof(Page), PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    page = static_cast<Page*>(p);
+    if (!std::equal(MAGIC, MAGIC + sizeof(MAGIC), page->magic)
+            || page->version != VERSION
+            || page->snapshot_size != sizeof(Snapshot)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void
+StatsPage::close() {
+    if (page != nullptr) {
+        ::munmap(page, sizeof(Page));
+        page = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    writable = false;
+}
+
+void
+StatsPage::publish(const Snapshot& snapshot) {
+    if (page == nullptr || !writable) {
+        return;
+    }
+
+    last = snapshot;
+    last.pid = ::getpid();
+    last.replications = replications;
+    last.finished = finished;
+
+    const std::uint64_t seq = page->sequence.load(std::memory_order_relaxed);
+    page->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&page->snapshot, &last, sizeof(Snapshot));
+    page->sequence.store(seq + 2, std::memory_order_release);
+}
+
+void
+StatsPage::finish() {
+    finished = true;
+    publish(last);
+}
+
+bool
+StatsPage::read(Snapshot& snapshot) const {
+    if (page == nullptr) {
+        return false;
+    }
+
+    for (unsigned attempt = 0; attempt < 10000; attempt++) {
+        const std::uint64_t before =
+            page->sequence.load(std::memory_order_acquire);
+        if (before % 2 == 1) {
+            // Give a writer that was preempted a chance to finish
+            std::this_thread::yield();
+            continue;
+        }
+        std::memcpy(&snapshot, &page->snapshot, sizeof(Snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (page->sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint64_t
+StatsPage::updates() const {
+    if (page == nullptr) {
+        return 0;
+    }
+    return page->sequence.load(std::memory_order_acquire) / 2;
+}
@@ -0,0 +1,128 @@
+#ifndef STATS_PAGE_H_
+#define STATS_PAGE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * A small file, mapped into memory, through which a running simulation
+ * publishes its progress to other processes (e.g. watch-stats).
+ *
+ * The file holds a header and one Snapshot. The writer updates it under a
+ * sequence lock: the sequence number is odd while the snapshot is being
+ * copied, and readers retry until they see the same even number before and
+ * after their copy. The writer never waits for readers.
+ *
+ * The layout is fixed and in the byte order of the machine, so the file must
+ * be read on the machine it is written on.
+ */
+class StatsPage {
+public:
+    static const std::uint32_t VERSION;
+
+    struct Snapshot {
+        std::uint32_t pid;
+        /* Non-zero once the whole run has finished */
+        std::uint32_t finished;
+        std::uint32_t replication;
+        std::uint32_t replications;
+        /* Non-zero while the first connections are being ignored */
+        std::uint32_t warming_up;
+        std::uint32_t reserved;
+        /* Wall clock seconds since the start of the replication */
+        double elapsed;
+        /* Simulated time */
+        double now;
+        std::uint64_t events;
+        /* Measured connections and how many of them were blocked */
+        std::uint64_t connections;
+        std::uint64_t blocked;
+        /* Connections holding a path */
+        std::uint64_t active;
+        double blocking;
+        /* Half width of the 95% confidence interval of `blocking' */
+        double ci_half_width;
+        /* Since the previous snapshot */
+        double events_per_second;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    StatsPage();
+
+    StatsPage(const StatsPage&) = delete;
+
+    // Destructor
+    ~StatsPage();
+
+    StatsPage&
+    operator=(const StatsPage&) = delete;
+    /* }}} */
+
+    /**
+     * Creates (or truncates) the file and maps it for writing.
+     *
+     * \param[in] replications stored in every snapshot.
+     *
+     * \return true on success, false otherwise.
+     */
+    bool
+    create(const std::string& filename, const unsigned replications = 1);
+
+    /**
+     * Maps a file created by another process for reading.
+     *
+     * \return true on success, false if the file cannot be mapped or is not
+     *         a stats page of this version.
+     */
+    bool
+    open(const std::string& filename);
+
+    /**
+     * Unmaps the file. The file itself is kept.
+     */
+    void
+    close();
+
+    /**
+     * Replaces the snapshot. The pid, number of replications and the
+     * finished flag are filled in by the page. Must only be called on a page
+     * opened with `create'.
+     */
+    void
+    publish(const Snapshot& snapshot);
+
+    /**
+     * Publishes the last snapshot again with the finished flag set.
+     */
+    void
+    finish();
+
+    /**
+     * Copies a consistent snapshot.
+     *
+     * \return true on success, false if the writer kept changing it.
+     */
+    bool
+    read(Snapshot& snapshot) const;
+
+    /**
+     * \return the number of times the snapshot was published. Readers can
+     *         compare it between reads to tell a stalled writer.
+     */
+    std::uint64_t
+    updates() const;
+
+private:
+    struct Page;
+
+    Page* page;
+    int fd;
+    bool writable;
+    std::uint32_t replications;
+    bool finished;
+    Snapshot last;
+};
+
+#endif /* end of include guard */
@@ -0,0 +1,167 @@
+#include "Timeline.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include <unistd.h>
+
+namespace {
+/**
+ * Appends `s' as a JSON string, with quotes and backslashes escaped.
+ */
+void
+append_string(std::string& out, const char* s) {
+    out += '"';
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            out += '\\';
+        }
+        out += *s;
+    }
+    out += '"';
+}
+}
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+Timeline::Timeline()
+    : threshold{0}
+    , sample_every{0}
+    , since_sample{0}
+    , origin{0}
+    , pid{0}
+    , current{0}
+    , used{0}
+    , spans_{0}
+    , slow_events_{0}
+    , failed{false}
+{ }
+
+// Destructor
+Timeline::~Timeline() {
+    close();
+}
+/* }}} */
+
+bool
+Timeline::open(const std::string& filename,
+               const std::uint64_t threshold,
+               const unsigned long sample_every,
+               const std::size_t spans_per_page) {
+    close();
+
+    ofs.open(filename, std::ios::out | std::ios::trunc);
+    if (!ofs) {
+        return false;
+    }
+    pid = ::getpid();
+    ofs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+        << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+        << ",\"tid\":1,\"args\":{\"name\":\"erlang-b-model\"}},\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+        << ",\"tid\":1,\"args\":{\"name\":\"simulation\"}}";
+
+    this->threshold = threshold;
+    this->sample_every = sample_every;
+    since_sample = 0;
+    origin = now();
+    const std::size_t page_size = std::max<std::size_t>(spans_per_page, 1);
+    pages[0].assign(page_size, Span());
+    pages[1].assign(page_size, Span());
+    current = 0;
+    used = 0;
+    spans_ = 0;
+    slow_events_ = 0;
+    failed = !ofs;
+    writer.start([this](const void* page, const std::size_t size) {
+        out.clear();
+        format(static_cast<const Span*>(page), size, out);
+        ofs.write(out.data(), out.size());
+        return static_cast<bool>(ofs);
+    });
+    return !failed;
+}
+
+void
+Timeline::phase(const std::string& name,
+                const std::uint64_t start,
+                const std::uint64_t end) {
+    Span span = Span();
+    span.kind = PHASE;
+    span.start = start;
+    span.duration = end - start;
+    std::strncpy(span.name, name.c_str(), sizeof(span.name) - 1);
+    append(span);
+}
+
+bool
+Timeline::close() {
+    if (!writer.running()) {
+        return !failed;
+    }
+    if (used != 0) {
+        flush_page();
+    }
+    if (!writer.stop()) {
+        failed = true;
+    }
+
+    ofs << "\n]}" << std::endl;
+    ofs.close();
+    if (!ofs) {
+        failed = true;
+    }
+    return !failed;
+}
+
+void
+Timeline::append(const Span& span) {
+    pages[current][used] = span;
+    spans_++;
+    if (++used == pages[current].size()) {
+        flush_page();
+    }
+}
+
+void
+Timeline::flush_page() {
+    writer.submit(pages[current].data(), used);
+    current ^= 1;
+    used = 0;
+}
+
+void
+Timeline::format(const Span* spans,
+                 const std::size_t n,
+                 std::string& out) const {
+    char buffer[256];
+    for (std::size_t i = 0; i < n; i++) {
+        const Span& span = spans[i];
+        // Microseconds since `open'; phases may have started before it
+        const double ts =
+            (static_cast<double>(span.start) - static_cast<double>(origin))
+            / 1000;
+        out += ",\n{\"name\":";
+        append_string(out, span.name);
+        std::snprintf(buffer, sizeof(buffer),
+                      ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+                      "\"dur\":%.3f,\"pid\":%lu,\"tid\":1",
+                      span.kind == PHASE ? "phase" : "event",
+                      ts, span.duration / 1000.0, pid);
+        out += buffer;
+        if (span.kind == EVENT) {
+            std::snprintf(buffer, sizeof(buffer),
+                          ",\"args\":{\"src\":%" PRIu32 ",\"dst\":%" PRIu32
+                          ",\"wavelengths_tried\":%" PRIu32
+                          ",\"wavelength\":%" PRIu32
+                          ",\"replication\":%" PRIu32
+                          ",\"time\":%.17g,\"slow\":%s}",
+                          span.src, span.dst, span.wavelengths_tried,
+                          span.wavelength, span.replication, span.time,
+                          span.slow ? "true" : "false");
+            out += buffer;
+        }
+        out += '}';
+    }
+}
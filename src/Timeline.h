@@ -0,0 +1,249 @@
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include "PageWriter.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a timeline of the run in the Chrome trace event format (JSON), which
+ * can be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * The timeline has a span for every phase (see PhaseTimer) and, nested in
+ * them, spans of single events: every `sample_every'-th event and every event
+ * that took at least `threshold' nanoseconds to process, so that the outliers
+ * hidden by the averages can be found. Event spans carry the type of the
+ * event, its source and destination, the number of wavelengths tried and the
+ * wavelength used.
+ *
+ * Spans are copied into one of two pages of fixed-size records. When a page
+ * is full it is handed to a PageWriter, which formats it as JSON and writes
+ * it on a background thread while the other page is being filled.
+ */
+class Timeline {
+public:
+    enum Kind {
+        PHASE,
+        EVENT
+    };
+
+    struct Span {
+        Kind kind;
+        /* Nanoseconds, see `now' */
+        std::uint64_t start;
+        std::uint64_t duration;
+        /* Name of the phase or type of the event */
+        char name[24];
+        /* Only for events */
+        std::uint32_t src;
+        std::uint32_t dst;
+        std::uint32_t wavelengths_tried;
+        std::uint32_t wavelength;
+        std::uint32_t replication;
+        /* Whether the event was recorded for being slow */
+        bool slow;
+        /* Simulated time of the event */
+        double time;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    Timeline();
+
+    Timeline(const Timeline&) = delete;
+
+    // Destructor
+    ~Timeline();
+
+    Timeline&
+    operator=(const Timeline&) = delete;
+    /* }}} */
+
+    /**
+     * Creates the file and starts the background thread.
+     *
+     * \param[in] threshold events that take at least this many nanoseconds
+     *                      are always recorded.
+     *
+     * \param[in] sample_every record every this many events regardless of
+     *                         how long they took; 0 to record only slow
+     *                         events.
+     *
+     * \return true if the file was created, false otherwise.
+     */
+    bool
+    open(const std::string& filename,
+         const std::uint64_t threshold,
+         const unsigned long sample_every,
+         const std::size_t spans_per_page = 1 << 14);
+
+    /**
+     * Records a phase. Must only be called between `open' and `close'.
+     *
+     * \param[in] start the start of the phase, as returned by `now'.
+     */
+    void
+    phase(const std::string& name,
+          const std::uint64_t start,
+          const std::uint64_t end);
+
+    /**
+     * Records an event if it is slow or sampled. Must only be called between
+     * `open' and `close'.
+     *
+     * \param[in] type the name of the type of the event, at most 23
+     *                 characters.
+     *
+     * \return true if the event was recorded.
+     */
+    bool
+    event(const char* type,
+          const std::uint64_t start,
+          const std::uint64_t end,
+          const std::uint32_t src,
+          const std::uint32_t dst,
+          const std::uint32_t wavelengths_tried,
+          const std::uint32_t wavelength,
+          const std::uint32_t replication,
+          const double time);
+
+    /**
+     * Writes the remaining spans, ends the JSON document and waits for the
+     * background thread.
+     *
+     * \return true if everything was written, false otherwise.
+     */
+    bool
+    close();
+
+    /**
+     * \return the number of spans recorded so far.
+     */
+    unsigned long
+    spans() const;
+
+    /**
+     * \return the number of events recorded for being slow so far.
+     */
+    unsigned long
+    slow_events() const;
+
+    /**
+     * \return the current time in nanoseconds on the clock of the timeline.
+     */
+    static std::uint64_t
+    now();
+
+    /**
+     * \return `t' in nanoseconds on the clock of the timeline.
+     */
+    static std::uint64_t
+    nanoseconds(const std::chrono::steady_clock::time_point t);
+
+private:
+    void
+    append(const Span& span);
+
+    /**
+     * Hands the current page to the writer and switches to the other one
+     * once the writer is done with it.
+     */
+    void
+    flush_page();
+
+    /**
+     * Formats the spans as JSON objects, each preceded by a comma.
+     */
+    void
+    format(const Span* spans, const std::size_t n, std::string& out) const;
+
+    std::ofstream ofs;
+    std::uint64_t threshold;
+    unsigned long sample_every;
+    unsigned long since_sample;
+    /* Time of `open', subtracted from every timestamp */
+    std::uint64_t origin;
+    unsigned long pid;
+
+    std::vector<Span> pages[2];
+    unsigned current;
+    /* Spans used in the current page */
+    std::size_t used;
+    unsigned long spans_;
+    unsigned long slow_events_;
+
+    /* JSON of a page, only used by the writer */
+    std::string out;
+    PageWriter writer;
+    bool failed;
+};
+
+/* Inlined methods */
+inline bool
+Timeline::event(const char* type,
+                const std::uint64_t start,
+                const std::uint64_t end,
+                const std::uint32_t src,
+                const std::uint32_t dst,
+                const std::uint32_t wavelengths_tried,
+                const std::uint32_t wavelength,
+                const std::uint32_t replication,
+                const double time) {
+    const std::uint64_t duration = end - start;
+    const bool slow = duration >= threshold;
+    const bool sampled = sample_every != 0 && ++since_sample >= sample_every;
+    if (!slow && !sampled) {
+        return false;
+    }
+    if (sampled) {
+        since_sample = 0;
+    }
+
+    Span& span = pages[current][used];
+    span.kind = EVENT;
+    span.start = start;
+    span.duration = duration;
+    std::strncpy(span.name, type, sizeof(span.name) - 1);
+    span.name[sizeof(span.name) - 1] = '\0';
+    span.src = src;
+    span.dst = dst;
+    span.wavelengths_tried = wavelengths_tried;
+    span.wavelength = wavelength;
+    span.replication = replication;
+    span.slow = slow;
+    span.time = time;
+    slow_events_ += slow;
+    spans_++;
+    if (++used == pages[current].size()) {
+        flush_page();
+    }
+    return true;
+}
+
+inline unsigned long
+Timeline::spans() const {
+    return spans_;
+}
+
+inline unsigned long
+Timeline::slow_events() const {
+    return slow_events_;
+}
+
+inline std::uint64_t
+Timeline::now() {
+    return nanoseconds(std::chrono::steady_clock::now());
+}
+
+inline std::uint64_t
+Timeline::nanoseconds(const std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t.time_since_epoch()).count();
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,508 @@
+#include "Topology.h"
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+
+namespace {
+/* Files smaller than this are parsed by one thread */
+const std::size_t PARALLEL_THRESHOLD = 1 << 20;
+
+/**
+ * Numbers found in one part of the file, and the first error in it.
+ */
+struct Chunk {
+    Chunk()
+        : lines{0}
+        , error_line{0}
+    { }
+
+    std::vector<unsigned> numbers;
+    /* Number of newlines in the chunk */
+    unsigned long lines;
+    /* Line of the error relative to the start of the chunk (from 1), or 0 */
+    unsigned long error_line;
+    std::string error;
+};
+
+bool
+is_space(const char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r'
+        || c == '\v' || c == '\f';
+}
+
+/**
+ * Parses unsigned decimal integers separated by whitespace. All of them are
+ * vertices, which must be below Topology::MAX_VERTICES, except the first
+ * one if `has_count'.
+ */
+void
+parse_chunk(const char* p, const char* end, const bool has_count,
+            Chunk& chunk) {
+    const unsigned max = std::numeric_limits<unsigned>::max();
+
+    while (p != end) {
+        if (*p == '\n') {
+            chunk.lines++;
+            p++;
+            continue;
+        }
+        if (is_space(*p)) {
+            p++;
+            continue;
+        }
+
+        if (*p < '0' || *p > '9') {
+            chunk.error_line = chunk.lines + 1;
+            chunk.error = std::string{"unexpected character '"} + *p + "'";
+            return;
+        }
+
+        unsigned long value = 0;
+        while (p != end && *p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            if (value > max) {
+                chunk.error_line = chunk.lines + 1;
+                chunk.error = "number too large";
+                return;
+            }
+            p++;
+        }
+        if (p != end && !is_space(*p)) {
+            chunk.error_line = chunk.lines + 1;
+            chunk.error = std::string{"unexpected character '"} + *p + "'";
+            return;
+        }
+        if (value >= Topology::MAX_VERTICES
+                && !(has_count && chunk.numbers.empty())) {
+            std::ostringstream oss;
+            oss << "vertex " << value << " too large (at most "
+                << Topology::MAX_VERTICES - 1 << ")";
+            chunk.error_line = chunk.lines + 1;
+            chunk.error = oss.str();
+            return;
+        }
+        chunk.numbers.push_back(static_cast<unsigned>(value));
+    }
+}
+
+const char BINARY_MAGIC[8] = {'E', 'B', 'M', 'T', 'O', 'P', 'O', '\0'};
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+const std::uint32_t HAS_CAPACITIES = 1;
+
+/**
+ * Header of the binary format. The arrays follow it in this order, each
+ * starting at a multiple of 8 bytes: endpoints (2E x u32) and capacities (E
+ * x u32). Everything is in the byte order of the machine that wrote it.
+ */
+struct BinaryHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    std::uint64_t num_vertices;
+    std::uint64_t num_edges;
+    std::uint64_t hash;
+};
+static_assert(sizeof(BinaryHeader) == 48, "unexpected padding in header");
+
+std::uint64_t
+aligned(const std::uint64_t bytes) {
+    return (bytes + 7) & ~std::uint64_t{7};
+}
+
+/**
+ * Byte offsets of the arrays from the start of the file.
+ */
+struct BinaryLayout {
+    explicit BinaryLayout(const std::uint64_t num_edges)
+        : endpoints{sizeof(BinaryHeader)}
+        , capacities{endpoints + aligned(2 * num_edges * 4)}
+        , size{capacities + aligned(num_edges * 4)}
+    { }
+
+    std::uint64_t endpoints;
+    std::uint64_t capacities;
+    std::uint64_t size;
+};
+
+const std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+const std::uint64_t FNV_PRIME = 1099511628211ull;
+
+std::uint64_t
+fnv1a(std::uint64_t hash, const std::uint32_t value) {
+    // Little-endian bytes, whatever the byte order of the machine
+    for (unsigned shift = 0; shift < 32; shift += 8) {
+        hash = (hash ^ ((value >> shift) & 0xff)) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Hash of the endpoints followed by the capacities, with 0 for edges without
+ * one (all of them if `capacities' is nullptr). This is the same for a
+ * topology read from text and from a binary file written without capacities.
+ */
+std::uint64_t
+content_hash(const std::uint32_t* endpoints,
+             const std::uint32_t* capacities,
+             const unsigned long num_edges) {
+    std::uint64_t hash = FNV_OFFSET;
+    for (unsigned long i = 0; i < 2 * num_edges; i++) {
+        hash = fnv1a(hash, endpoints[i]);
+    }
+    for (unsigned long i = 0; i < num_edges; i++) {
+        hash = fnv1a(hash, capacities != nullptr ? capacities[i] : 0);
+    }
+    return hash;
+}
+
+/**
+ * \return one more than the largest endpoint, computed in 64 bits so that
+ *         an endpoint of UINT_MAX does not wrap around.
+ */
+unsigned
+count_vertices(const std::vector<std::uint32_t>& endpoints) {
+    unsigned long count = 0;
+    for (const std::uint32_t v : endpoints) {
+        count = std::max(count, v + 1ul);
+    }
+    return static_cast<unsigned>(count);
+}
+
+void
+write_padded(std::ostream& os, const void* data, const std::size_t size) {
+    static const char zeros[8] = {};
+    os.write(static_cast<const char*>(data), size);
+    os.write(zeros, aligned(size) - size);
+}
+}
+
+const std::uint32_t Topology::BINARY_VERSION = 3;
+const unsigned Topology::MAX_VERTICES;
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+Topology::Topology()
+    : endpoints_{nullptr}
+    , capacities_{nullptr}
+    , num_edges_{0}
+    , num_vertices_{0}
+    , hash_{FNV_OFFSET}
+{ }
+
+// Copy constructor
+Topology::Topology(const Topology& rhs)
+    : endpoint_storage{rhs.endpoint_storage}
+    , mapping{rhs.mapping}
+    , endpoints_{rhs.endpoints_}
+    , capacities_{rhs.capacities_}
+    , num_edges_{rhs.num_edges_}
+    , num_vertices_{rhs.num_vertices_}
+    , hash_{rhs.hash_}
+    , error_{rhs.error_}
+{
+    // Mapped files are shared, but parsed text must point to our own copy
+    if (mapping == nullptr && endpoints_ != nullptr) {
+        endpoints_ = endpoint_storage.data();
+    }
+}
+
+// Destructor
+Topology::~Topology()
+{ }
+
+// Assignment operator
+Topology&
+Topology::operator=(const Topology& rhs) {
+    Topology copy{rhs};
+    *this = std::move(copy);
+    return *this;
+}
+/* }}} */
+
+bool
+Topology::load(const std::string& filename, const unsigned threads) {
+    auto file = std::make_shared<MappedFile>(filename);
+    if (!file->good()) {
+        error_ = "cannot open " + filename;
+        return false;
+    }
+
+    const bool binary = file->size() >= sizeof(BINARY_MAGIC)
+        && std::equal(BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC),
+                      file->data());
+    const bool ok = binary
+        ? load_binary(file)
+        : parse(file->data(), file->data() + file->size(), threads);
+    if (!ok) {
+        error_ = filename + ":" + error_;
+        return false;
+    }
+    return true;
+}
+
+bool
+Topology::load_binary(std::shared_ptr<MappedFile> file) {
+    *this = Topology{};
+
+    if (file->size() < sizeof(BinaryHeader)) {
+        error_ = " truncated header";
+        return false;
+    }
+    BinaryHeader header;
+    std::copy(file->data(), file->data() + sizeof(header),
+              reinterpret_cast<char*>(&header));
+
+    if (header.byte_order != BYTE_ORDER_MARK) {
+        error_ = " written on a machine with a different byte order";
+        return false;
+    }
+    if (header.version != BINARY_VERSION) {
+        std::ostringstream oss;
+        oss << " unsupported version " << header.version;
+        error_ = oss.str();
+        return false;
+    }
+    if (header.num_vertices > MAX_VERTICES
+            || header.num_edges > std::numeric_limits<std::uint32_t>::max()) {
+        error_ = " too many vertices or edges";
+        return false;
+    }
+    const BinaryLayout layout{header.num_edges};
+    if (file->size() < layout.size) {
+        error_ = " truncated";
+        return false;
+    }
+
+    const char* base = file->data();
+    endpoints_ = reinterpret_cast<const std::uint32_t*>(
+            base + layout.endpoints);
+    if (header.flags & HAS_CAPACITIES) {
+        capacities_ = reinterpret_cast<const std::uint32_t*>(
+                base + layout.capacities);
+    }
+    num_edges_ = header.num_edges;
+    num_vertices_ = header.num_vertices;
+
+    hash_ = content_hash(endpoints_, capacities_, num_edges_);
+    if (hash_ != header.hash) {
+        *this = Topology{};
+        error_ = " content does not match its hash";
+        return false;
+    }
+    // The number of vertices is not covered by the hash
+    for (unsigned long i = 0; i < 2 * num_edges_; i++) {
+        if (endpoints_[i] >= num_vertices_) {
+            std::ostringstream oss;
+            oss << " edge " << i / 2 << " has endpoint " << endpoints_[i]
+                << " but there are " << num_vertices_ << " vertices";
+            *this = Topology{};
+            error_ = oss.str();
+            return false;
+        }
+    }
+
+    // Random access from here on
+    file->advise_sequential(false);
+    mapping = file;
+    return true;
+}
+
+bool
+Topology::parse(const char* begin, const char* end, const unsigned threads) {
+    *this = Topology{};
+
+    unsigned num_threads = threads == 0
+        ? std::thread::hardware_concurrency()
+        : threads;
+    const std::size_t size = end - begin;
+    if (num_threads == 0 || size < PARALLEL_THRESHOLD) {
+        num_threads = 1;
+    }
+
+    // Split at newlines so that no number is cut in half
+    std::vector<const char*> bounds{begin};
+    for (unsigned i = 1; i < num_threads; i++) {
+        const char* p = std::max(bounds.back(), begin + size * i / num_threads);
+        p = std::find(p, end, '\n');
+        bounds.push_back(p);
+    }
+    bounds.push_back(end);
+
+    // The number of edges is the first number, in whichever chunk it is
+    const char* count_at = std::find_if_not(begin, end, is_space);
+    auto has_count = [&bounds, count_at](const unsigned i) {
+        return bounds[i] <= count_at && count_at < bounds[i + 1];
+    };
+
+    std::vector<Chunk> chunks(num_threads);
+    if (num_threads == 1) {
+        parse_chunk(begin, end, true, chunks[0]);
+    }
+    else {
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < num_threads; i++) {
+            workers.emplace_back(parse_chunk, bounds[i], bounds[i + 1],
+                                 has_count(i), std::ref(chunks[i]));
+        }
+        for (std::thread& w : workers) {
+            w.join();
+        }
+    }
+
+    // The first error in the file, with its absolute line number
+    unsigned long line = 0;
+    std::size_t total = 0;
+    for (const Chunk& chunk : chunks) {
+        if (chunk.error_line != 0) {
+            std::ostringstream oss;
+            oss << line + chunk.error_line << ": " << chunk.error;
+            error_ = oss.str();
+            return false;
+        }
+        line += chunk.lines;
+        total += chunk.numbers.size();
+    }
+
+    if (total == 0) {
+        error_ = "1: missing number of edges";
+        return false;
+    }
+
+    unsigned declared = 0;
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.numbers.empty()) {
+            declared = chunk.numbers.front();
+            break;
+        }
+    }
+    if (total - 1 != 2ul * declared) {
+        std::ostringstream oss;
+        oss << line + 1 << ": expected " << declared << " edges but found "
+            << (total - 1) / 2;
+        if ((total - 1) % 2 != 0) {
+            oss << " and a half";
+        }
+        error_ = oss.str();
+        return false;
+    }
+
+    endpoint_storage.reserve(total - 1);
+    bool first = true;
+    for (const Chunk& chunk : chunks) {
+        auto it = chunk.numbers.begin();
+        if (first && it != chunk.numbers.end()) {
+            // Skip the number of edges
+            it++;
+            first = false;
+        }
+        endpoint_storage.insert(endpoint_storage.end(),
+                                it, chunk.numbers.end());
+    }
+
+    num_vertices_ = count_vertices(endpoint_storage);
+    endpoints_ = endpoint_storage.data();
+    num_edges_ = declared;
+    hash_ = content_hash(endpoints_, capacities_, num_edges_);
+    return true;
+}
+
+void
+Topology::assign(std::vector<std::uint32_t> endpoints) {
+    *this = Topology{};
+    endpoint_storage = std::move(endpoints);
+    endpoints_ = endpoint_storage.data();
+    num_edges_ = endpoint_storage.size() / 2;
+    num_vertices_ = count_vertices(endpoint_storage);
+    hash_ = content_hash(endpoints_, capacities_, num_edges_);
+}
+
+bool
+Topology::write_text(std::ostream& os) const {
+    // Formatted by hand into a large buffer; streams are slow per number
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    char digits[16];
+    auto append = [&buffer, &digits](unsigned long value, const char end) {
+        char* p = digits + sizeof(digits);
+        do {
+            *--p = '0' + value % 10;
+            value /= 10;
+        } while (value != 0);
+        buffer.append(p, digits + sizeof(digits));
+        buffer.push_back(end);
+    };
+
+    append(num_edges_, '\n');
+    for (unsigned long i = 0; i < num_edges_; i++) {
+        append(endpoints_[2 * i], ' ');
+        append(endpoints_[2 * i + 1], '\n');
+        if (buffer.size() > (1 << 20) - 64) {
+            os.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    os.write(buffer.data(), buffer.size());
+    return static_cast<bool>(os);
+}
+
+bool
+Topology::write_binary(const std::string& filename,
+                       const unsigned num_links) const {
+    std::vector<std::uint32_t> capacities;
+    if (capacities_ != nullptr) {
+        capacities.assign(capacities_, capacities_ + num_edges_);
+    }
+    else {
+        capacities.assign(num_edges_, num_links);
+    }
+    const bool has_capacities = capacities_ != nullptr || num_links != 0;
+
+    BinaryHeader header = {};
+    std::copy(BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC),
+              header.magic);
+    header.version = BINARY_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.flags = has_capacities ? HAS_CAPACITIES : 0;
+    header.num_vertices = num_vertices_;
+    header.num_edges = num_edges_;
+    header.hash = content_hash(endpoints_,
+                               has_capacities ? capacities.data() : nullptr,
+                               num_edges_);
+
+    std::ofstream ofs{filename, std::ios::binary};
+    if (!ofs) {
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_padded(ofs, endpoints_, 2 * num_edges_ * 4);
+    write_padded(ofs, capacities.data(), num_edges_ * 4);
+    return static_cast<bool>(ofs);
+}
+
+Advisor::Graph
+Topology::make_graph(const unsigned num_links,
+                     const bool has_converter) const {
+    // All the vertices at once
+    Advisor::Graph g{num_vertices_};
+
+    const Link link{num_links, has_converter};
+    for (unsigned long i = 0; i < num_edges_; i++) {
+        if (capacities_ != nullptr && capacities_[i] != 0) {
+            boost::add_edge(endpoints_[2 * i], endpoints_[2 * i + 1],
+                            Link{capacities_[i], has_converter}, g);
+        }
+        else {
+            boost::add_edge(endpoints_[2 * i], endpoints_[2 * i + 1], link, g);
+        }
+    }
+
+    return g;
+}
@@ -0,0 +1,200 @@
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include "Advisor.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+/**
+ * The list of edges of a network, read from a file.
+ *
+ * The text format is the number of edges followed by the two endpoints of
+ * each edge, all separated by whitespace (usually one edge per line). Files
+ * are memory-mapped and parsed without streams or locales; large files are
+ * parsed by several threads, each taking a range of lines.
+ *
+ * The binary format (see `write_binary') holds the same edges along with the
+ * number of wavelengths of each edge and a hash of the content. It is mapped
+ * read-only and its edges are used in place, so loading it takes no parsing,
+ * only a pass to check the hash and the endpoints, and processes loading the
+ * same file share its pages. The graph the simulator routes on is still built
+ * from the edges by `make_graph'. `load' detects the format automatically.
+ */
+class Topology {
+public:
+    /* Version of the binary format */
+    static const std::uint32_t BINARY_VERSION;
+
+    /* Vertices are numbered below this; the graph takes memory for every
+     * vertex whether it has edges or not */
+    static const unsigned MAX_VERTICES = 1u << 28;
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    Topology();
+
+    // Copy constructor
+    Topology(const Topology& rhs);
+
+    // Move constructor
+    Topology(Topology&& rhs) = default;
+
+    // Destructor
+    ~Topology();
+
+    // Assignment operator
+    Topology&
+    operator=(const Topology& rhs);
+
+    // Move assignment operator
+    Topology&
+    operator=(Topology&& rhs) = default;
+    /* }}} */
+
+    /**
+     * Reads an edge list or binary topology file.
+     *
+     * \param[in] threads the number of threads to use for large text files.
+     *                    0 uses one per hardware thread.
+     *
+     * \return true on success. On failure, `error()' describes the problem.
+     */
+    bool
+    load(const std::string& filename, const unsigned threads = 0);
+
+    /**
+     * Same as `load', but parses text that is already in memory.
+     */
+    bool
+    parse(const char* begin, const char* end, const unsigned threads = 0);
+
+    /**
+     * Uses the given edges; edge i is between endpoints 2 * i and 2 * i + 1.
+     * Endpoints must be below MAX_VERTICES.
+     */
+    void
+    assign(std::vector<std::uint32_t> endpoints);
+
+    /**
+     * Writes the topology in the text format read by `load'.
+     *
+     * \return true on success, false otherwise.
+     */
+    bool
+    write_text(std::ostream& os) const;
+
+    /**
+     * Writes the topology in the binary format.
+     *
+     * \param[in] num_links the number of wavelengths to store for edges
+     *                      without one. 0 leaves them unspecified.
+     *
+     * \return true on success, false otherwise.
+     */
+    bool
+    write_binary(const std::string& filename,
+                 const unsigned num_links = 0) const;
+
+    /**
+     * \return a graph with a Link on each edge. Edges are added in the order
+     *         of the file. Edges with a stored number of wavelengths use it,
+     *         others use `num_links'.
+     */
+    Advisor::Graph
+    make_graph(const unsigned num_links, const bool has_converter) const;
+
+    /**
+     * \return the endpoints of the edges; edge i is between endpoints
+     *         2 * i and 2 * i + 1.
+     */
+    const std::uint32_t*
+    endpoints() const;
+
+    /**
+     * \return the number of wavelengths of each edge, 0 if unspecified.
+     *         nullptr if none is specified (e.g. for text files).
+     */
+    const std::uint32_t*
+    capacities() const;
+
+    unsigned long
+    num_edges() const;
+
+    /**
+     * \return one more than the largest vertex in any edge.
+     */
+    unsigned
+    num_vertices() const;
+
+    /**
+     * \return the 64-bit FNV-1a hash of the endpoints and then the
+     *         capacities, each as 4 little-endian bytes, with 0 for edges
+     *         without a capacity. The same edges with the same capacities
+     *         have the same hash, whichever format they were read from; a
+     *         binary file written with capacities differs from the text
+     *         it was converted from.
+     */
+    std::uint64_t
+    hash() const;
+
+    /**
+     * \return a description of the last error, including the line number
+     *         for malformed input.
+     */
+    const std::string&
+    error() const;
+
+private:
+    bool
+    load_binary(std::shared_ptr<MappedFile> file);
+
+    /* Storage for parsed text; unused for mapped binary files */
+    std::vector<std::uint32_t> endpoint_storage;
+    std::shared_ptr<MappedFile> mapping;
+
+    const std::uint32_t* endpoints_;
+    const std::uint32_t* capacities_;
+    unsigned long num_edges_;
+    unsigned num_vertices_;
+    std::uint64_t hash_;
+    std::string error_;
+};
+
+/* Inlined methods */
+inline const std::uint32_t*
+Topology::endpoints() const {
+    return endpoints_;
+}
+
+inline const std::uint32_t*
+Topology::capacities() const {
+    return capacities_;
+}
+
+inline unsigned long
+Topology::num_edges() const {
+    return num_edges_;
+}
+
+inline unsigned
+Topology::num_vertices() const {
+    return num_vertices_;
+}
+
+inline std::uint64_t
+Topology::hash() const {
+    return hash_;
+}
+
+inline const std::string&
+Topology::error() const {
+    return error_;
+}
+
+#endif /* end of include guard */
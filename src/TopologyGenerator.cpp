@@ -0,0 +1,347 @@
+#include "TopologyGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <thread>
+
+namespace {
+/* Number of random edges drawn from one generator */
+const unsigned long BLOCK_SIZE = 1 << 16;
+
+/**
+ * \return a key that sorts edges by their smaller, then larger endpoint.
+ */
+std::uint64_t
+edge_key(const std::uint32_t a, const std::uint32_t b) {
+    return a < b
+        ? (static_cast<std::uint64_t>(a) << 32) | b
+        : (static_cast<std::uint64_t>(b) << 32) | a;
+}
+
+/**
+ * A generator for one block of work, independent of which thread does it.
+ */
+std::mt19937_64
+block_generator(const std::uint64_t seed,
+                const std::uint64_t stream,
+                const std::uint64_t block) {
+    std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                      static_cast<std::uint32_t>(seed >> 32),
+                      static_cast<std::uint32_t>(stream),
+                      static_cast<std::uint32_t>(block),
+                      static_cast<std::uint32_t>(block >> 32)};
+    return std::mt19937_64{seq};
+}
+
+/**
+ * Calls f(i) for i in [0, n), handing out indices to `threads' threads in
+ * turn.
+ */
+template<typename Function>
+void
+parallel_for(const unsigned long n, const unsigned threads, Function f) {
+    const unsigned long t = std::min<unsigned long>(threads, n);
+    if (t <= 1) {
+        for (unsigned long i = 0; i < n; i++) {
+            f(i);
+        }
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned long first = 0; first < t; first++) {
+        workers.emplace_back([first, n, t, &f]() {
+            for (unsigned long i = first; i < n; i += t) {
+                f(i);
+            }
+        });
+    }
+    for (std::thread& w : workers) {
+        w.join();
+    }
+}
+}
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+TopologyGenerator::TopologyGenerator(const Model model,
+                                     const unsigned num_vertices,
+                                     const std::uint64_t seed,
+                                     const unsigned threads)
+    : model{model}
+    , num_vertices{num_vertices}
+    , seed{seed}
+    , threads{threads == 0 ? std::thread::hardware_concurrency() : threads}
+    , edges{0}
+    , alpha{0.4}
+    , beta{0.1}
+    , rows{0}
+    , attachments{2}
+{ }
+
+// Destructor
+TopologyGenerator::~TopologyGenerator()
+{ }
+/* }}} */
+
+bool
+TopologyGenerator::parse_model(const std::string& name, Model& model) {
+    static const std::pair<const char*, Model> names[] = {
+        {"erdos-renyi", ERDOS_RENYI},
+        {"waxman", WAXMAN},
+        {"grid", GRID},
+        {"torus", TORUS},
+        {"ring", RING},
+        {"bus", BUS},
+        {"preferential", PREFERENTIAL},
+    };
+    for (const auto& n : names) {
+        if (name == n.first) {
+            model = n.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+TopologyGenerator::set_edges(const unsigned long edges) {
+    this->edges = edges;
+}
+
+void
+TopologyGenerator::set_waxman(const double alpha, const double beta) {
+    this->alpha = alpha;
+    this->beta = beta;
+}
+
+void
+TopologyGenerator::set_rows(const unsigned rows) {
+    this->rows = rows;
+}
+
+void
+TopologyGenerator::set_attachments(const unsigned attachments) {
+    this->attachments = attachments;
+}
+
+bool
+TopologyGenerator::generate(std::vector<std::uint32_t>& endpoints) {
+    error_.clear();
+    const unsigned long n = num_vertices;
+    if (n < 2) {
+        error_ = "at least two nodes are needed";
+        return false;
+    }
+
+    std::vector<std::uint64_t> keys;
+    switch (model) {
+        case ERDOS_RENYI:
+            if (edges > n * (n - 1) / 2) {
+                error_ = "more edges than pairs of nodes";
+                return false;
+            }
+            erdos_renyi(keys);
+            break;
+        case WAXMAN:
+            if (alpha <= 0 || beta <= 0 || beta > 1) {
+                error_ = "alpha must be positive and beta in (0, 1]";
+                return false;
+            }
+            waxman(keys);
+            break;
+        case GRID:
+        case TORUS:
+            if (rows == 0) {
+                // The squarest grid
+                rows = std::sqrt(n);
+                while (n % rows != 0) {
+                    rows--;
+                }
+            }
+            if (n % rows != 0) {
+                error_ = "the number of nodes is not a multiple of the rows";
+                return false;
+            }
+            lattice(keys, model == TORUS);
+            break;
+        case RING:
+        case BUS:
+            for (std::uint32_t v = 0; v + 1 < n; v++) {
+                keys.push_back(edge_key(v, v + 1));
+            }
+            if (model == RING && n > 2) {
+                keys.push_back(edge_key(n - 1, 0));
+            }
+            break;
+        case PREFERENTIAL:
+            if (attachments == 0 || attachments >= n) {
+                error_ = "attachments must be between 1 and the number of "
+                    "nodes - 1";
+                return false;
+            }
+            preferential(keys);
+            break;
+    }
+
+    std::sort(keys.begin(), keys.end());
+    endpoints.resize(2 * keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        endpoints[2 * i] = keys[i] >> 32;
+        endpoints[2 * i + 1] = static_cast<std::uint32_t>(keys[i]);
+    }
+    return true;
+}
+
+void
+TopologyGenerator::erdos_renyi(std::vector<std::uint64_t>& found) const {
+    // Draw random pairs in blocks until there are enough distinct ones
+    const std::uint32_t n = num_vertices;
+    std::uint64_t round = 0;
+    while (found.size() < edges) {
+        const unsigned long need = edges - found.size();
+        const unsigned long draws = need + need / 8 + 16;
+        const unsigned long blocks = (draws + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        std::vector<std::uint64_t> candidates(blocks * BLOCK_SIZE);
+        parallel_for(blocks, threads, [&](const unsigned long block) {
+            auto rgen = block_generator(seed, round, block);
+            std::uniform_int_distribution<std::uint32_t> node{0, n - 1};
+            auto out = candidates.begin() + block * BLOCK_SIZE;
+            for (unsigned long i = 0; i < BLOCK_SIZE; i++) {
+                std::uint32_t a, b;
+                do {
+                    a = node(rgen);
+                    b = node(rgen);
+                } while (a == b);
+                *out++ = edge_key(a, b);
+            }
+        });
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                         candidates.end());
+
+        std::vector<std::uint64_t> merged;
+        merged.reserve(found.size() + candidates.size());
+        std::set_union(found.begin(), found.end(),
+                       candidates.begin(), candidates.end(),
+                       std::back_inserter(merged));
+        found.swap(merged);
+        round++;
+    }
+
+    // Keep a random subset of the right size
+    if (found.size() > edges) {
+        auto rgen = block_generator(seed, round, 0);
+        for (unsigned long i = 0; i < edges; i++) {
+            std::uniform_int_distribution<std::size_t> pick{
+                i, found.size() - 1};
+            std::swap(found[i], found[pick(rgen)]);
+        }
+        found.resize(edges);
+    }
+}
+
+void
+TopologyGenerator::waxman(std::vector<std::uint64_t>& keys) const {
+    const unsigned n = num_vertices;
+
+    std::vector<double> x(n), y(n);
+    auto rgen = block_generator(seed, 0, 0);
+    std::uniform_real_distribution<double> coordinate{0, 1};
+    for (unsigned v = 0; v < n; v++) {
+        x[v] = coordinate(rgen);
+        y[v] = coordinate(rgen);
+    }
+
+    // Each node decides on its links to the nodes after it
+    const double scale = 1 / (alpha * std::sqrt(2.0));
+    std::vector<std::vector<std::uint64_t>> links(n);
+    parallel_for(n, threads, [&](const unsigned long u) {
+        auto row_rgen = block_generator(seed, 1, u);
+        std::uniform_real_distribution<double> uniform{0, 1};
+        for (unsigned v = u + 1; v < n; v++) {
+            const double d = std::hypot(x[u] - x[v], y[u] - y[v]);
+            if (uniform(row_rgen) < beta * std::exp(-d * scale)) {
+                links[u].push_back(edge_key(u, v));
+            }
+        }
+    });
+
+    for (const auto& l : links) {
+        keys.insert(keys.end(), l.begin(), l.end());
+    }
+}
+
+void
+TopologyGenerator::lattice(std::vector<std::uint64_t>& keys,
+                           const bool wrap) const {
+    const unsigned columns = num_vertices / rows;
+    auto node = [columns](const unsigned r, const unsigned c) {
+        return r * columns + c;
+    };
+
+    for (unsigned r = 0; r < rows; r++) {
+        for (unsigned c = 0; c < columns; c++) {
+            if (c + 1 < columns) {
+                keys.push_back(edge_key(node(r, c), node(r, c + 1)));
+            }
+            if (r + 1 < rows) {
+                keys.push_back(edge_key(node(r, c), node(r + 1, c)));
+            }
+        }
+    }
+
+    // Wrapping a dimension of 2 would duplicate its edges
+    if (wrap && columns > 2) {
+        for (unsigned r = 0; r < rows; r++) {
+            keys.push_back(edge_key(node(r, columns - 1), node(r, 0)));
+        }
+    }
+    if (wrap && rows > 2) {
+        for (unsigned c = 0; c < columns; c++) {
+            keys.push_back(edge_key(node(rows - 1, c), node(0, c)));
+        }
+    }
+}
+
+void
+TopologyGenerator::preferential(std::vector<std::uint64_t>& keys) const {
+    // Each new node depends on all the previous ones, so this is sequential;
+    // it is linear in the number of edges
+    const unsigned m = attachments;
+    auto rgen = block_generator(seed, 0, 0);
+
+    // Every endpoint of every edge, so that a uniform choice from it is
+    // proportional to the degree
+    std::vector<std::uint32_t> endpoints;
+    endpoints.reserve(2ul * m * num_vertices);
+
+    // Start with a clique of m + 1 nodes
+    for (unsigned a = 0; a <= m; a++) {
+        for (unsigned b = a + 1; b <= m; b++) {
+            keys.push_back(edge_key(a, b));
+            endpoints.push_back(a);
+            endpoints.push_back(b);
+        }
+    }
+
+    std::vector<std::uint32_t> targets;
+    for (std::uint32_t v = m + 1; v < num_vertices; v++) {
+        std::uniform_int_distribution<std::size_t> pick{
+            0, endpoints.size() - 1};
+        targets.clear();
+        while (targets.size() < m) {
+            const std::uint32_t t = endpoints[pick(rgen)];
+            if (std::find(targets.begin(), targets.end(), t) == targets.end()) {
+                targets.push_back(t);
+            }
+        }
+        for (const std::uint32_t t : targets) {
+            keys.push_back(edge_key(t, v));
+            endpoints.push_back(t);
+            endpoints.push_back(v);
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef TOPOLOGY_GENERATOR_H_
+#define TOPOLOGY_GENERATOR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Generates the edges of synthetic networks.
+ *
+ * The same seed always gives the same network, regardless of the number of
+ * threads: random models draw from generators seeded by the seed and the
+ * index of a fixed-size block of work, and threads only decide which blocks
+ * they take.
+ */
+class TopologyGenerator {
+public:
+    enum Model {
+        /* `edges' distinct edges chosen uniformly at random */
+        ERDOS_RENYI,
+        /* Nodes at random points of the unit square; nodes at distance d are
+         * linked with probability beta * exp(-d / (alpha * sqrt(2))) */
+        WAXMAN,
+        /* `rows' x (num_vertices / rows) grid */
+        GRID,
+        /* A grid whose rows and columns wrap around */
+        TORUS,
+        /* Every node linked to the next one, and the last to the first */
+        RING,
+        /* Every node linked to the next one */
+        BUS,
+        /* Each new node is linked to `attachments' existing ones, chosen in
+         * proportion to their degree (Barabasi-Albert) */
+        PREFERENTIAL,
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    /**
+     * \param[in] threads the number of threads to use. 0 uses one per
+     *                    hardware thread.
+     */
+    TopologyGenerator(const Model model,
+                      const unsigned num_vertices,
+                      const std::uint64_t seed,
+                      const unsigned threads = 0);
+
+    // Destructor
+    ~TopologyGenerator();
+    /* }}} */
+
+    /**
+     * \return true and the model with the given name (e.g. "waxman"), or
+     *         false if there is no such model.
+     */
+    static bool
+    parse_model(const std::string& name, Model& model);
+
+    /**
+     * Sets the number of edges of the Erdos-Renyi model.
+     */
+    void
+    set_edges(const unsigned long edges);
+
+    /**
+     * Sets the parameters of the Waxman model (default 0.4 and 0.1).
+     */
+    void
+    set_waxman(const double alpha, const double beta);
+
+    /**
+     * Sets the number of rows of grids and tori.
+     */
+    void
+    set_rows(const unsigned rows);
+
+    /**
+     * Sets the number of edges added with each node of the preferential
+     * attachment model (default 2).
+     */
+    void
+    set_attachments(const unsigned attachments);
+
+    /**
+     * Generates the edges, sorted by their endpoints.
+     *
+     * \param[out] endpoints edge i is between endpoints 2 * i and 2 * i + 1,
+     *                       the smaller one first.
+     *
+     * \return true on success, false if the parameters are not possible
+     *         (`error()' describes why).
+     */
+    bool
+    generate(std::vector<std::uint32_t>& endpoints);
+
+    const std::string&
+    error() const;
+
+private:
+    void
+    erdos_renyi(std::vector<std::uint64_t>& edges) const;
+
+    void
+    waxman(std::vector<std::uint64_t>& edges) const;
+
+    void
+    lattice(std::vector<std::uint64_t>& edges, const bool wrap) const;
+
+    void
+    preferential(std::vector<std::uint64_t>& edges) const;
+
+    Model model;
+    unsigned num_vertices;
+    std::uint64_t seed;
+    unsigned threads;
+    unsigned long edges;
+    double alpha;
+    double beta;
+    unsigned rows;
+    unsigned attachments;
+    std::string error_;
+};
+
+/* Inlined methods */
+inline const std::string&
+TopologyGenerator::error() const {
+    return error_;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,131 @@
+#include "TraceWriter.h"
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace {
+const char MAGIC[8] = {'E', 'B', 'M', 'T', 'R', 'A', 'C', 'E'};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+};
+}
+
+const std::uint32_t TraceWriter::VERSION = 1;
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+// Default constructor
+TraceWriter::TraceWriter()
+    : current{0}
+    , used{0}
+    , records_{0}
+    , failed{false}
+{ }
+
+// Destructor
+TraceWriter::~TraceWriter() {
+    close();
+}
+/* }}} */
+
+bool
+TraceWriter::open(const std::string& filename,
+                  const std::size_t records_per_page) {
+    close();
+
+    ofs.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        return false;
+    }
+    Header header;
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    header.version = VERSION;
+    header.record_size = sizeof(Record);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const std::size_t page_size = std::max<std::size_t>(records_per_page, 1)
+        * sizeof(Record);
+    pages[0].assign(page_size, 0);
+    pages[1].assign(page_size, 0);
+    current = 0;
+    used = 0;
+    records_ = 0;
+    failed = !ofs;
+    writer.start([this](const void* page, const std::size_t size) {
+        ofs.write(static_cast<const char*>(page), size);
+        return static_cast<bool>(ofs);
+    });
+    return !failed;
+}
+
+bool
+TraceWriter::close() {
+    if (!writer.running()) {
+        return !failed;
+    }
+    if (used != 0) {
+        flush_page();
+    }
+    if (!writer.stop()) {
+        failed = true;
+    }
+
+    ofs.close();
+    if (!ofs) {
+        failed = true;
+    }
+    return !failed;
+}
+
+void
+TraceWriter::flush_page() {
+    writer.submit(pages[current].data(), used);
+    current ^= 1;
+    used = 0;
+}
+
+bool
+TraceWriter::write_csv(const std::string& filename, std::ostream& os) {
+    std::ifstream ifs{filename, std::ios::in | std::ios::binary};
+    Header header;
+    if (!ifs.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), header.magic)
+            || header.version != VERSION
+            || header.record_size != sizeof(Record)) {
+        return false;
+    }
+
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    os << "replication,arrival,departure,src,dst,path_length,wavelength,"
+        "blocked,warm_up\n";
+
+    // Read many records at a time
+    std::vector<Record> records(1 << 12);
+    while (ifs) {
+        ifs.read(reinterpret_cast<char*>(records.data()),
+                 records.size() * sizeof(Record));
+        const std::size_t bytes = ifs.gcount();
+        if (bytes % sizeof(Record) != 0) {
+            // Truncated record
+            return false;
+        }
+        for (std::size_t i = 0; i < bytes / sizeof(Record); i++) {
+            const Record& r = records[i];
+            os << r.replication << ',' << r.arrival << ',' << r.departure
+                << ',' << r.src << ',' << r.dst << ',' << r.path_length
+                << ',';
+            if (r.flags & BLOCKED) {
+                os << ',';
+            }
+            else {
+                os << r.wavelength << ',';
+            }
+            os << ((r.flags & BLOCKED) != 0) << ','
+                << ((r.flags & WARM_UP) != 0) << '\n';
+        }
+    }
+    return static_cast<bool>(os);
+}
@@ -0,0 +1,134 @@
+#ifndef TRACE_WRITER_H_
+#define TRACE_WRITER_H_
+
+#include "PageWriter.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes one fixed-size record per connection to a binary file.
+ *
+ * Records are copied into one of two pages in memory. When a page is full it
+ * is handed to a PageWriter, which writes it to the file in one call while
+ * the other page is being filled, so the simulation only waits if the disk
+ * cannot keep up.
+ *
+ * The file starts with a header (magic, version and record size) and is
+ * followed by the records in the byte order of the machine.
+ */
+class TraceWriter {
+public:
+    static const std::uint32_t VERSION;
+
+    /* Bits of Record::flags */
+    static const std::uint32_t BLOCKED = 1;
+    static const std::uint32_t WARM_UP = 2;
+
+    struct Record {
+        /* Arrival time of the connection */
+        double arrival;
+        /* Departure time, same as arrival if the connection was blocked */
+        double departure;
+        std::uint32_t src;
+        std::uint32_t dst;
+        /* Number of links in the path, 0 if blocked */
+        std::uint32_t path_length;
+        /* Link::NONE if blocked */
+        std::uint32_t wavelength;
+        std::uint32_t flags;
+        std::uint32_t replication;
+    };
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    // Default constructor
+    TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+
+    // Destructor
+    ~TraceWriter();
+
+    TraceWriter&
+    operator=(const TraceWriter&) = delete;
+    /* }}} */
+
+    /**
+     * Creates the trace file and starts the background thread.
+     *
+     * \param[in] records_per_page the number of records in each of the two
+     *                             pages.
+     *
+     * \return true if the file was created, false otherwise.
+     */
+    bool
+    open(const std::string& filename,
+         const std::size_t records_per_page = 1 << 15);
+
+    /**
+     * Appends a record. Must only be called between `open' and `close'.
+     */
+    void
+    record(const Record& r);
+
+    /**
+     * Writes the remaining records and waits for the background thread.
+     *
+     * \return true if every record was written, false otherwise.
+     */
+    bool
+    close();
+
+    /**
+     * \return the number of records so far.
+     */
+    unsigned long
+    records() const;
+
+    /**
+     * Converts a trace file to CSV, one line per record after a header line.
+     *
+     * \return true on success, false if the file is not a valid trace.
+     */
+    static bool
+    write_csv(const std::string& filename, std::ostream& os);
+
+private:
+    /**
+     * Hands the current page to the writer and switches to the other one
+     * once the writer is done with it.
+     */
+    void
+    flush_page();
+
+    std::ofstream ofs;
+    std::vector<char> pages[2];
+    unsigned current;
+    /* Bytes used in the current page */
+    std::size_t used;
+    unsigned long records_;
+    PageWriter writer;
+    bool failed;
+};
+
+/* Inlined methods */
+inline void
+TraceWriter::record(const Record& r) {
+    std::memcpy(pages[current].data() + used, &r, sizeof(r));
+    used += sizeof(r);
+    records_++;
+    if (used == pages[current].size()) {
+        flush_page();
+    }
+}
+
+inline unsigned long
+TraceWriter::records() const {
+    return records_;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,170 @@
+#include "Utilization.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace {
+const char MAGIC[8] = {'E', 'B', 'M', 'U', 'T', 'I', 'L', '\0'};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_edges;
+    std::uint32_t num_wavelengths;
+    std::uint32_t reserved;
+    std::uint64_t samples;
+};
+}
+
+const std::uint32_t Utilization::VERSION = 1;
+
+/* Constructors, Destructor, and Assignment operators {{{ */
+Utilization::Utilization(const Advisor::Graph& graph,
+                         const double interval,
+                         const std::size_t capacity)
+    : interval_{interval}
+    , capacity{std::max<std::size_t>(capacity, 1)}
+    , num_wavelengths_{0}
+    , samples_{0}
+{
+    boost::graph_traits<Advisor::Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(graph);
+    for (auto it = e_b; it != e_e; it++) {
+        endpoints.push_back(boost::source(*it, graph));
+        endpoints.push_back(boost::target(*it, graph));
+        for (const Link::wavelength_t wl : graph[*it].wavelengths()) {
+            num_wavelengths_ = std::max<std::size_t>(num_wavelengths_, wl);
+        }
+    }
+
+    times.assign(this->capacity, 0);
+    replications.assign(this->capacity, 0);
+    edge_counts.assign(this->capacity * num_edges(), 0);
+    wavelength_counts.assign(this->capacity * num_wavelengths_, 0);
+}
+
+// Copy constructor
+Utilization::Utilization(const Utilization& other)
+    : interval_{other.interval_}
+    , capacity{other.capacity}
+    , endpoints{other.endpoints}
+    , num_wavelengths_{other.num_wavelengths_}
+    , samples_{other.samples_}
+    , times{other.times}
+    , replications{other.replications}
+    , edge_counts{other.edge_counts}
+    , wavelength_counts{other.wavelength_counts}
+{ }
+
+// Destructor
+Utilization::~Utilization()
+{ }
+
+// Assignment operator
+Utilization&
+Utilization::operator=(const Utilization& other) {
+    interval_ = other.interval_;
+    capacity = other.capacity;
+    endpoints = other.endpoints;
+    num_wavelengths_ = other.num_wavelengths_;
+    samples_ = other.samples_;
+    times = other.times;
+    replications = other.replications;
+    edge_counts = other.edge_counts;
+    wavelength_counts = other.wavelength_counts;
+    return *this;
+}
+/* }}} */
+
+void
+Utilization::sample(const Advisor::Graph& graph,
+                    const unsigned replication,
+                    const double time) {
+    const std::size_t s = samples_ % capacity;
+    times[s] = time;
+    replications[s] = replication;
+
+    std::uint32_t* edges = edge_counts.data() + s * num_edges();
+    std::uint32_t* wavelengths =
+        wavelength_counts.data() + s * num_wavelengths_;
+    std::fill(wavelengths, wavelengths + num_wavelengths_, 0);
+
+    // The number of used wavelengths is O(1) per edge; the per-wavelength
+    // counts cost one increment per busy wavelength
+    boost::graph_traits<Advisor::Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(graph);
+    std::size_t e = 0;
+    for (auto it = e_b; it != e_e && e < num_edges(); it++, e++) {
+        const Link& link = graph[*it];
+        edges[e] = link.num_used();
+        link.for_each_used([&](const Link::wavelength_t wl) {
+            if (wl >= 1 && wl <= num_wavelengths_) {
+                wavelengths[wl - 1]++;
+            }
+        });
+    }
+    samples_++;
+}
+
+void
+Utilization::write_csv(std::ostream& os) const {
+    os << "replication,time";
+    for (std::size_t e = 0; e < num_edges(); e++) {
+        os << ',' << endpoints[2 * e] << "--" << endpoints[2 * e + 1];
+    }
+    for (std::size_t wl = 1; wl <= num_wavelengths_; wl++) {
+        os << ",wl" << wl;
+    }
+    os << std::endl;
+
+    const auto precision = os.precision();
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (std::size_t i = 0; i < size(); i++) {
+        os << replication(i) << ',' << time(i);
+        for (std::size_t e = 0; e < num_edges(); e++) {
+            os << ',' << edge(i, e);
+        }
+        for (std::size_t wl = 1; wl <= num_wavelengths_; wl++) {
+            os << ',' << wavelength(i, wl);
+        }
+        os << '\n';
+    }
+    os.precision(precision);
+    os.flush();
+}
+
+bool
+Utilization::write_binary(const std::string& filename) const {
+    std::ofstream ofs{filename,
+                      std::ios::out | std::ios::binary | std::ios::trunc};
+    if (!ofs) {
+        return false;
+    }
+
+    Header header;
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    header.version = VERSION;
+    header.num_edges = num_edges();
+    header.num_wavelengths = num_wavelengths_;
+    header.reserved = 0;
+    header.samples = size();
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(endpoints.data()),
+              endpoints.size() * sizeof(std::uint32_t));
+
+    for (std::size_t i = 0; i < size(); i++) {
+        const std::size_t s = slot(i);
+        const std::uint32_t r[2] = {replications[s], 0};
+        ofs.write(reinterpret_cast<const char*>(r), sizeof(r));
+        ofs.write(reinterpret_cast<const char*>(&times[s]), sizeof(double));
+        ofs.write(reinterpret_cast<const char*>(
+                      edge_counts.data() + s * num_edges()),
+                  num_edges() * sizeof(std::uint32_t));
+        ofs.write(reinterpret_cast<const char*>(
+                      wavelength_counts.data() + s * num_wavelengths_),
+                  num_wavelengths_ * sizeof(std::uint32_t));
+    }
+    return ofs.good();
+}
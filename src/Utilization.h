@@ -0,0 +1,195 @@
+#ifndef UTILIZATION_H_
+#define UTILIZATION_H_
+
+#include "Advisor.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Time series of how busy the network is, sampled at a fixed interval of
+ * simulated time.
+ *
+ * Each sample holds the number of used wavelengths on every edge and, for
+ * every wavelength, the number of edges using it. Samples go into a ring of
+ * fixed capacity that is allocated up front, so memory stays bounded and
+ * sampling does not allocate; once the ring is full the oldest samples are
+ * overwritten.
+ */
+class Utilization {
+public:
+    static const std::uint32_t VERSION;
+
+    /* Constructors, Destructor, and Assignment operators {{{ */
+    /**
+     * \param[in] graph the network that will be sampled (or a copy of it).
+     *                  Edges are numbered in the order of boost::edges.
+     *
+     * \param[in] interval simulated time between samples.
+     *
+     * \param[in] capacity the number of samples kept.
+     */
+    Utilization(const Advisor::Graph& graph,
+                const double interval,
+                const std::size_t capacity);
+
+    // Copy constructor
+    Utilization(const Utilization& other);
+
+    // Destructor
+    ~Utilization();
+
+    // Assignment operator
+    Utilization&
+    operator=(const Utilization& other);
+    /* }}} */
+
+    /**
+     * Records the current state of the network. The graph must have the
+     * same edges as the one given to the constructor.
+     *
+     * \param[in] replication stored with the sample.
+     */
+    void
+    sample(const Advisor::Graph& graph,
+           const unsigned replication,
+           const double time);
+
+    double
+    interval() const;
+
+    /**
+     * \return the number of samples kept, at most the capacity.
+     */
+    std::size_t
+    size() const;
+
+    /**
+     * \return the number of samples taken, including overwritten ones.
+     */
+    std::uint64_t
+    samples() const;
+
+    std::size_t
+    num_edges() const;
+
+    /**
+     * \return the largest wavelength of any link. Wavelengths are counted
+     *         from 1.
+     */
+    std::size_t
+    num_wavelengths() const;
+
+    /**
+     * Accessors of the kept samples, oldest (i = 0) first.
+     */
+    double
+    time(const std::size_t i) const;
+
+    unsigned
+    replication(const std::size_t i) const;
+
+    /**
+     * \return the number of used wavelengths on edge `e'.
+     */
+    std::uint32_t
+    edge(const std::size_t i, const std::size_t e) const;
+
+    /**
+     * \return the number of edges on which wavelength `wl' is used.
+     */
+    std::uint32_t
+    wavelength(const std::size_t i, const Link::wavelength_t wl) const;
+
+    /**
+     * Writes a header line and one line per sample: the replication, the
+     * time, a column per edge named "source--target" as in the DOT output,
+     * and a column per wavelength named "wl<n>".
+     */
+    void
+    write_csv(std::ostream& os) const;
+
+    /**
+     * Writes a header (magic, version, numbers of edges, wavelengths and
+     * samples), the source and target of each edge, then per sample the
+     * replication, the time and the counts, all in the byte order of the
+     * machine.
+     *
+     * \return true on success, false otherwise.
+     */
+    bool
+    write_binary(const std::string& filename) const;
+
+private:
+    /**
+     * \return the position in the ring of the i-th oldest sample.
+     */
+    std::size_t
+    slot(const std::size_t i) const;
+
+    double interval_;
+    std::size_t capacity;
+    std::vector<std::uint32_t> endpoints;
+    std::size_t num_wavelengths_;
+    std::uint64_t samples_;
+    std::vector<double> times;
+    std::vector<std::uint32_t> replications;
+    std::vector<std::uint32_t> edge_counts;
+    std::vector<std::uint32_t> wavelength_counts;
+};
+
+/* Inlined methods */
+inline double
+Utilization::interval() const {
+    return interval_;
+}
+
+inline std::size_t
+Utilization::size() const {
+    return samples_ < capacity ? samples_ : capacity;
+}
+
+inline std::uint64_t
+Utilization::samples() const {
+    return samples_;
+}
+
+inline std::size_t
+Utilization::num_edges() const {
+    return endpoints.size() / 2;
+}
+
+inline std::size_t
+Utilization::num_wavelengths() const {
+    return num_wavelengths_;
+}
+
+inline std::size_t
+Utilization::slot(const std::size_t i) const {
+    return samples_ <= capacity ? i : (samples_ + i) % capacity;
+}
+
+inline double
+Utilization::time(const std::size_t i) const {
+    return times[slot(i)];
+}
+
+inline unsigned
+Utilization::replication(const std::size_t i) const {
+    return replications[slot(i)];
+}
+
+inline std::uint32_t
+Utilization::edge(const std::size_t i, const std::size_t e) const {
+    return edge_counts[slot(i) * num_edges() + e];
+}
+
+inline std::uint32_t
+Utilization::wavelength(const std::size_t i,
+                        const Link::wavelength_t wl) const {
+    return wavelength_counts[slot(i) * num_wavelengths_ + wl - 1];
+}
+
+#endif /* end of include guard */
@@ -1,6 +1,27 @@
 #include "Advisor.h"
+#include "AllocationTracker.h"
+#include "Checkpoint.h"
+#include "ControlVariate.h"
+#include "Counters.h"
+#include "Dimensioning.h"
+#include "Erlang.h"
 #include "Event.h"
+#include "EventLatency.h"
+#include "Ladder.h"
 #include "Link.h"
+#include "PairStats.h"
+#include "PerfCounters.h"
+#include "PhaseTimer.h"
+#include "ReducedLoad.h"
+#include "Replay.h"
+#include "ResultCache.h"
+#include "Shard.h"
+#include "Simulator.h"
+#include "StatsPage.h"
+#include "Timeline.h"
+#include "Topology.h"
+#include "TraceWriter.h"
+#include "Utilization.h"
 
 #include "cxxopts.hpp"
 
@@ -8,29 +29,18 @@
 #include <boost/graph/graph_traits.hpp>
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
-#include <queue>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
 #include <utility>
-
-Advisor::Graph
-make_graph_from_file(std::istream& is,
-                     const unsigned num_links,
-                     const bool has_converter) {
-    unsigned num_edges;
-    is >> num_edges;
-
-    Advisor::Graph g;
-
-    unsigned a, b;
-    for (unsigned i = 0; i < num_edges; i++) {
-        is >> a >> b;
-        boost::add_edge(a, b, Link(num_links, has_converter), g);
-    }
-
-    return g;
-}
+#include <vector>
 
 void
 output_network(std::ostream& os, const Advisor::Graph& nodes) {
@@ -47,87 +57,132 @@ output_network(std::ostream& os, const Advisor::Graph& nodes) {
 }
 
 /**
- * \param[in] advisor the Advisor object that handles random number
- *                    generation, keeping track of the network state, and
- *                    finding paths.
- *
- * \param[in] limit the total number of packets to observe.
- *
- * \param[in] ignore_first the number of packets to ignore. Default to 10% of limit.
+ * Combines the partial statistics files written by shards into one pooled
+ * estimate. The files must be of the same scenario and hold every shard
+ * exactly once.
  */
-float
-simulate(Advisor& advisor,
-         const unsigned limit,
-         const unsigned ignore_first = 0) {
-    bool ignored = false;
-    // 10% of the limit by default
-    unsigned to_ignore = ignore_first == 0 ? limit * 0.1 : ignore_first;
-    unsigned connection_count = 0;
-    unsigned success_count = 0;
-    unsigned block_count = 0;
-    Advisor::event_t now = 0;
-
-    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> pq;
-    pq.push(Event(advisor.get_nodes(),
-                  Event::START,
-                  advisor.get_arrival()));
-    connection_count++;
-
-    while (true) {
-        if (connection_count > limit) {
-            break;
-        }
-        if (connection_count == to_ignore && !ignored) {
-            connection_count = 0;
-            success_count = 0;
-            block_count = 0;
-            ignored = true;
-        }
-
-        Event event = pq.top();
-        pq.pop();
-        now = event.time;
-
-        Advisor::vertex_t src = event.src;
-        Advisor::vertex_t dst = event.dst;
-
-        switch (event.type) {
-            case Event::START:
-                {
-                    std::vector<Advisor::edge_t> path;
-                    Link::wavelength_t wl;
-                    std::tie(path, wl) = advisor.make_connection(src, dst);
-                    // Wavelength is Link::NONE on failure
-                    if (wl != Link::NONE) {
-                        // Schedule finishing of connection
-                        auto e = Event{event.src, event.dst, Event::END,
-                            now + advisor.get_duration(), path, wl};
-                        pq.push(e);
-                    }
-                    else {
-                        pq.push(Event(Event::BLOCK, now));
-                    }
-
-                    // Schedule connection between two random nodes
-                    pq.push(Event(advisor.get_nodes(),
-                                  Event::START,
-                                  now + advisor.get_arrival()));
-                    connection_count++;
-                    break;
-                }
-            case Event::END:
-                advisor.remove_connection(event.path, event.wavelength);
-                success_count++;
-                break;
-            case Event::BLOCK:
-                block_count++;
-                break;
-            default:
-                break;
-        }
-    }
-
-    return static_cast<float>(block_count) / connection_count;
+int
+merge_partials(const std::vector<std::string>& filenames) {
+    Shard::Partial total;
+    std::string first_scenario;
+    // File of each shard, empty if not seen yet
+    std::vector<std::string> shards;
+    for (const std::string& filename : filenames) {
+        std::ifstream ifs{filename, std::ios::in};
+        Shard::Partial partial;
+        std::string scenario;
+        Shard shard;
+        if (!ifs.good()
+                || !Shard::Partial::read(ifs, partial, scenario, shard)) {
+            std::cerr << "Error reading partial statistics from "
+                << filename << std::endl;
+            return 1;
+        }
+
+        if (shards.empty()) {
+            first_scenario = scenario;
+            shards.resize(shard.count());
+        }
+        if (scenario != first_scenario || shard.count() != shards.size()) {
+            std::cerr << filename << " was written with different options, "
+                "seed or topology than " << filenames.front() << std::endl;
+            return 1;
+        }
+        if (!shards[shard.index()].empty()) {
+            std::cerr << filename << " and " << shards[shard.index()]
+                << " are both shard " << shard.index() << "/"
+                << shard.count() << std::endl;
+            return 1;
+        }
+        shards[shard.index()] = filename;
+        total.merge(partial);
+    }
+    for (unsigned i = 0; i < shards.size(); i++) {
+        if (shards[i].empty()) {
+            std::cerr << "Missing shard " << i << "/" << shards.size()
+                << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << total.blocking() * 100 << " %" << std::endl;
+    std::cout << "replications: " << total.replications
+        << ", connections: " << total.connections
+        << ", blocked: " << total.blocked
+        << ", standard error: " << total.std_error() * 100 << " %"
+        << std::endl;
+    return 0;
+}
+
+/**
+ * Converts a CSV file of connection requests (time, source, destination and
+ * holding time on each line) into the binary arrival file used by --replay.
+ */
+int
+convert_arrivals(const std::vector<std::string>& args) {
+    if (args.size() != 2) {
+        std::cerr << "Usage: arrivals <CSV file> <arrival file>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream ifs{args[0], std::ios::in};
+    if (!ifs.good()) {
+        std::cerr << "Error reading " << args[0] << std::endl;
+        return 1;
+    }
+    std::vector<Replay::Arrival> arrivals;
+    std::string line;
+    unsigned long line_number = 0;
+    while (std::getline(ifs, line)) {
+        line_number++;
+        // Optional header
+        if (line.empty() || (line_number == 1 && !std::isdigit(line[0]))) {
+            continue;
+        }
+
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream iss{line};
+        Replay::Arrival a;
+        if (!(iss >> a.time >> a.src >> a.dst >> a.holding)) {
+            std::cerr << "Error reading " << args[0] << ":" << line_number
+                << ": expected time, source, destination and holding time"
+                << std::endl;
+            return 1;
+        }
+        arrivals.push_back(a);
+    }
+
+    if (!Replay::write(args[1], arrivals)) {
+        std::cerr << "Error writing " << args[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Converts an edge list into the binary topology format.
+ */
+int
+convert_topology(const std::vector<std::string>& args) {
+    if (args.size() < 2 || args.size() > 3) {
+        std::cerr << "Usage: convert <edge list> <binary file> [num links]"
+            << std::endl;
+        return 1;
+    }
+
+    Topology topology;
+    if (!topology.load(args[0])) {
+        std::cerr << "Error reading " << topology.error() << std::endl;
+        return 1;
+    }
+    const unsigned num_links = args.size() == 3
+        ? std::atoi(args[2].c_str())
+        : 0;
+    if (!topology.write_binary(args[1], num_links)) {
+        std::cerr << "Error writing " << args[1] << std::endl;
+        return 1;
+    }
+    return 0;
 }
 
 int
@@ -137,10 +192,49 @@ main(int argc, char* argv[]) {
     unsigned total = 8000;
     bool converter = false;
     std::string dot_file = "graph.dot";
+    unsigned seed = 0;
+    unsigned replications = 1;
+    std::string shard_spec;
+    std::string partial_file;
+    bool ladder = false;
+    bool control_variate = false;
+    bool stratified = false;
+    bool adaptive_pairs = false;
+    bool theory = false;
+    bool reduced_load = false;
+    unsigned threads = 0;
+    double dimension_target = 0;
+    bool warm_start = false;
+    std::string trace_file;
+    std::string replay_file;
+    std::string checkpoint_file;
+    unsigned long checkpoint_every = 1000000;
+    std::string resume_file;
+    std::string cache_dir;
+    bool counters = false;
+    bool counters_json = false;
+    bool stats = false;
+    bool allocations = false;
+    bool forbid_allocations = false;
+    std::string stats_page_file;
+    unsigned long stats_every = 100000;
+    bool perf = false;
+    bool latency = false;
+    std::string timeline_file;
+    double timeline_threshold = 100;
+    unsigned long timeline_sample = 10000;
+    std::string utilization_file;
+    double utilization_interval = 1;
+    unsigned long utilization_samples = 10000;
 
     bool help = false;
 
-    cxxopts::Options options{argv[0], " <graph filename> <num links>"};
+    cxxopts::Options options{argv[0], " <graph filename> <num links>\n"
+        "  " + std::string{argv[0]} + " merge <partial files...>\n"
+        "  " + std::string{argv[0]}
+        + " convert <edge list> <binary file> [num links]\n"
+        "  " + std::string{argv[0]} + " trace-csv <trace file>\n"
+        "  " + std::string{argv[0]} + " arrivals <CSV file> <arrival file>"};
     options.add_options()
         ("l,lambda", "Mean arrival rate in packets per second",
          cxxopts::value(lambda))
@@ -152,6 +246,104 @@ main(int argc, char* argv[]) {
          cxxopts::value(converter))
         ("o,output", "Name of the output file for visualizing graph",
          cxxopts::value(dot_file))
+        ("s,seed", "Base random seed; replication r uses seed + r "
+         "(0 picks a random seed)",
+         cxxopts::value(seed))
+        ("r,replications", "Number of independent replications",
+         cxxopts::value(replications))
+        ("shard", "Only run replications r with r % N == i, given as i/N",
+         cxxopts::value(shard_spec))
+        ("partial", "Write partial statistics to this file for merging",
+         cxxopts::value(partial_file))
+        ("ladder", "Simulate every number of links from 1 to <num links> "
+         "on the same stream of connections",
+         cxxopts::value(ladder))
+        ("control-variate", "Also report the blocking probability corrected "
+         "with control variates",
+         cxxopts::value(control_variate))
+        ("stratified", "Also report the blocking probability stratified by "
+         "source and destination",
+         cxxopts::value(stratified))
+        ("adaptive-pairs", "Probe pairs with a high variance more often "
+         "(implies --stratified)",
+         cxxopts::value(adaptive_pairs))
+        ("theory", "Also show the Erlang B value (single-link networks only)",
+         cxxopts::value(theory))
+        ("reduced-load", "Only compute the reduced load (Erlang fixed point) "
+         "approximation instead of simulating",
+         cxxopts::value(reduced_load))
+        ("threads", "Number of threads for analytic methods "
+         "(0 for one per core)",
+         cxxopts::value(threads))
+        ("dimension", "Find the number of links for each edge that gives "
+         "at most this blocking probability, up to <num links> per edge, "
+         "verified by simulating at most 2 x --total connections in all",
+         cxxopts::value(dimension_target))
+        ("warm-start", "Start from the approximate stationary state given by "
+         "the reduced load approximation instead of an empty network",
+         cxxopts::value(warm_start))
+        ("trace", "Write a binary record of every connection to this file",
+         cxxopts::value(trace_file))
+        ("replay", "Take the connection requests from this arrival file "
+         "instead of generating them",
+         cxxopts::value(replay_file))
+        ("checkpoint", "Periodically save the state of the simulation to "
+         "this file",
+         cxxopts::value(checkpoint_file))
+        ("checkpoint-every", "Number of arrivals between checkpoints",
+         cxxopts::value(checkpoint_every))
+        ("resume", "Continue the simulation saved in this checkpoint",
+         cxxopts::value(resume_file))
+        ("cache", "Reuse results of identical runs stored in this directory, "
+         "and store new ones there",
+         cxxopts::value(cache_dir))
+        ("counters", "Show counts of operations on the hot path (needs a "
+         "build configured with -DWITH_COUNTERS=ON)",
+         cxxopts::value(counters))
+        ("counters-json", "Show only the blocking probability and the counts of "
+         "operations as one JSON object",
+         cxxopts::value(counters_json))
+        ("stats", "Show the time spent in each phase, the number of events "
+         "per second and the peak memory use on the standard error",
+         cxxopts::value(stats))
+        ("allocations", "Also count the heap allocations, bytes allocated "
+         "and peak bytes in use of each phase (needs a build configured "
+         "with -DWITH_ALLOCATION_TRACKER=ON)",
+         cxxopts::value(allocations))
+        ("forbid-allocations", "Fail if any heap allocation happens in the "
+         "measurement phase (needs the same build)",
+         cxxopts::value(forbid_allocations))
+        ("stats-page", "Publish the progress of the simulation in this file "
+         "(see watch-stats)",
+         cxxopts::value(stats_page_file))
+        ("stats-every", "Number of events between updates of the stats page",
+         cxxopts::value(stats_every))
+        ("perf", "Show hardware performance counters of the routing, "
+         "locking and event queue sections on the standard error",
+         cxxopts::value(perf))
+        ("latency", "Show the median, 99th and 99.9th percentiles and maximum "
+         "of the time taken to process accepted and blocked arrivals and "
+         "departures on the standard error",
+         cxxopts::value(latency))
+        ("timeline", "Write a timeline of the phases and of sampled and slow "
+         "events to this file as Chrome trace events (JSON, for Perfetto)",
+         cxxopts::value(timeline_file))
+        ("timeline-threshold", "Microseconds from which processing an event "
+         "counts as slow and is always put on the timeline",
+         cxxopts::value(timeline_threshold))
+        ("timeline-sample", "Put every this many events on the timeline "
+         "(0 for only the slow ones)",
+         cxxopts::value(timeline_sample))
+        ("utilization", "Sample the used wavelengths of every edge and the "
+         "use of every wavelength into this file (CSV if it ends with .csv, "
+         "binary otherwise)",
+         cxxopts::value(utilization_file))
+        ("utilization-interval", "Simulated time between utilization "
+         "samples",
+         cxxopts::value(utilization_interval))
+        ("utilization-samples", "Number of utilization samples kept; older "
+         "ones are dropped",
+         cxxopts::value(utilization_samples))
         ("h,help", "Show this help",
          cxxopts::value(help));
     options.parse(argc, argv);
@@ -160,6 +352,38 @@ main(int argc, char* argv[]) {
         std::cout << options.help() << std::endl;
         return 0;
     }
+    if (forbid_allocations && !AllocationTracker::compiled_in()) {
+        std::cerr << "--forbid-allocations needs the allocation tracker; "
+            "configure with -DWITH_ALLOCATION_TRACKER=ON" << std::endl;
+        return 1;
+    }
+    if (allocations && !AllocationTracker::compiled_in()) {
+        std::cerr << "The allocation tracker was not compiled in; configure "
+            "with -DWITH_ALLOCATION_TRACKER=ON" << std::endl;
+    }
+    if (allocations || forbid_allocations) {
+        AllocationTracker::enable();
+    }
+    stats = stats || allocations;
+
+    if (argc >= 2 && std::string{argv[1]} == "merge") {
+        return merge_partials(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (argc == 3 && std::string{argv[1]} == "trace-csv") {
+        if (!TraceWriter::write_csv(argv[2], std::cout)) {
+            std::cerr << "Error reading trace " << argv[2] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (argc >= 2 && std::string{argv[1]} == "arrivals") {
+        return convert_arrivals(
+                std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (argc >= 2 && std::string{argv[1]} == "convert") {
+        return convert_topology(
+                std::vector<std::string>(argv + 2, argv + argc));
+    }
 
     if (argc < 3) {
         std::cerr << options.help() << std::endl;
@@ -169,22 +393,485 @@ main(int argc, char* argv[]) {
     std::string filename{argv[1]};
     unsigned num_links = std::atoi(argv[2]);
 
-    // Make nodes
-    std::ifstream ifs{filename, std::ios::in};
+    // These modes return before the replications are run
+    if ((ladder || reduced_load || dimension_target > 0)
+            && (replications != 1 || !shard_spec.empty()
+                || !partial_file.empty() || !cache_dir.empty())) {
+        std::cerr << "--ladder, --reduced-load and --dimension cannot be "
+            "combined with --replications, --shard, --partial or --cache"
+            << std::endl;
+        return 1;
+    }
 
-    if (!ifs.good()) {
-        std::cerr << "Error opening file" << std::endl;
+    // Make nodes
+    PhaseTimer timer;
+    Timeline timeline;
+    if (!timeline_file.empty()) {
+        if (!timeline.open(timeline_file, timeline_threshold * 1000,
+                           timeline_sample)) {
+            std::cerr << "Error writing " << timeline_file << std::endl;
+            return 1;
+        }
+        timer.use_timeline(timeline);
+    }
+    timer.start("load");
+    Topology topology;
+    if (!topology.load(filename, threads)) {
+        std::cerr << "Error reading " << topology.error() << std::endl;
         return 1;
     }
+    Advisor::Graph nodes = topology.make_graph(num_links, converter);
 
     // Output dot file to visualize network
+    timer.start("dot export");
     std::ofstream ofs{dot_file, std::ios::out};
-    Advisor::Graph nodes = make_graph_from_file(ifs, num_links, converter);
     output_network(ofs, nodes);
-    auto advisor = Advisor{nodes, lambda, duration_mean};
+    ofs.close();
+    timer.stop();
 
-    auto pb = simulate(advisor, total);
-    std::cout << pb * 100  << " %" << std::endl;
+    Shard shard;
+    if (!shard_spec.empty()) {
+        if (!Shard::parse(shard_spec, shard)) {
+            std::cerr << "Invalid shard: " << shard_spec << std::endl;
+            return 1;
+        }
+        if (seed == 0) {
+            std::cerr << "Sharding requires a fixed --seed" << std::endl;
+            return 1;
+        }
+    }
+    if (seed == 0) {
+        seed = std::random_device{}();
+    }
+
+    // The offered load of a single link
+    const double load = lambda / duration_mean;
+    if (theory && boost::num_edges(nodes) != 1) {
+        std::cerr << "Erlang B is only exact for networks with one link"
+            << std::endl;
+        theory = false;
+    }
+    // A binary topology may store its own number of wavelengths
+    const unsigned theory_links = theory
+        ? nodes[*boost::edges(nodes).first].num_wavelengths()
+        : num_links;
+
+    if (dimension_target > 0) {
+        Dimensioning dim{nodes, converter, lambda, duration_mean, num_links,
+                         threads};
+        // The whole verification costs at most two simulations of `total'
+        // connections
+        dim.set_simulation(2ul * total, 10, seed);
+        auto assignment = dim.solve(dimension_target);
+
+        for (unsigned i = 0; i < dim.edges().size(); i++) {
+            const auto& e = dim.edges()[i];
+            std::cout << boost::source(e, nodes) << " "
+                << boost::target(e, nodes) << " "
+                << assignment.capacities[i] << std::endl;
+        }
+        std::cout << "total: " << assignment.total
+            << ", reduced load: " << assignment.analytic_blocking * 100 << " %"
+            << ", simulated: " << assignment.simulated_blocking * 100 << " %"
+            << " (standard error " << assignment.std_error * 100 << " %, "
+            << "upper bound " << assignment.upper_bound * 100 << " %, "
+            << assignment.connections_simulated << " connections)"
+            << std::endl;
+        if (assignment.analytic_blocking > dimension_target) {
+            std::cerr << "Target not met by the reduced load approximation "
+                << "with at most " << num_links << " wavelengths per link"
+                << std::endl;
+            return 1;
+        }
+        if (!assignment.feasible) {
+            std::cerr << "Target could not be verified by simulating "
+                << assignment.connections_simulated
+                << " connections; try a larger --total" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (reduced_load) {
+        auto start = std::chrono::steady_clock::now();
+        ReducedLoad rl{nodes,
+                       converter ? ReducedLoad::CONVERSION
+                                 : ReducedLoad::CONTINUITY,
+                       threads};
+        auto sol = rl.solve(lambda, duration_mean);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        std::cout << sol.blocking * 100 << " %" << std::endl;
+        std::cout << "reduced load: " << sol.iterations << " iterations, "
+            << "residual " << sol.residual << ", "
+            << elapsed.count() << " ms"
+            << (sol.converged ? "" : " (not converged)") << std::endl;
+        return 0;
+    }
+
+    if (ladder) {
+        Ladder l{nodes, num_links, converter, lambda, duration_mean, seed};
+        auto results = l.run(total);
+        for (unsigned w = 1; w <= results.size(); w++) {
+            std::cout << w << " " << results[w - 1].blocking() * 100 << " %";
+            if (theory) {
+                std::cout << " " << erlang_b(load, w) * 100 << " %";
+            }
+            std::cout << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<double> offered_loads;
+    if (warm_start) {
+        ReducedLoad rl{nodes,
+                       converter ? ReducedLoad::CONVERSION
+                                 : ReducedLoad::CONTINUITY,
+                       threads};
+        offered_loads = rl.offered_loads(rl.solve(lambda, duration_mean));
+    }
+
+    Shard::Partial partial;
+    // Around 50 batches per replication
+    ControlVariate cv{lambda, duration_mean, std::max(total / 50, 1u)};
+    stratified = stratified || adaptive_pairs;
+    PairStats pair_stats{
+        stratified ? static_cast<unsigned>(boost::num_vertices(nodes)) : 0};
+    Replay replay;
+    if (!replay_file.empty()) {
+        if (!replay.load(replay_file)) {
+            std::cerr << "Error reading " << replay.error() << std::endl;
+            return 1;
+        }
+        if (!replay.check(boost::num_vertices(nodes))) {
+            std::cerr << "Error reading " << replay_file << ": "
+                << replay.error() << std::endl;
+            return 1;
+        }
+    }
+
+    TraceWriter trace;
+    if (!trace_file.empty() && !trace.open(trace_file)) {
+        std::cerr << "Error writing " << trace_file << std::endl;
+        return 1;
+    }
+
+    // Checkpoints start with the scenario, the replication and the
+    // statistics of the replications before it
+    const bool checkpoints = !checkpoint_file.empty() || !resume_file.empty();
+    if (checkpoints && (control_variate || stratified || !trace_file.empty())) {
+        std::cerr << "Checkpoints cannot be combined with --control-variate, "
+            "--stratified or --trace" << std::endl;
+        return 1;
+    }
+    // The control variates have known means only for generated traffic;
+    // replayed arrivals would bias the corrected estimate
+    if (control_variate && !replay_file.empty()) {
+        std::cerr << "--control-variate cannot be combined with --replay"
+            << std::endl;
+        return 1;
+    }
+    // Replayed arrivals are identified by their content, not their count
+    const std::uint64_t replay_hash =
+        ResultCache::hash(replay.begin(),
+                          replay.size() * sizeof(Replay::Arrival));
+    // The sweep the replications belong to, whichever shard runs them
+    std::ostringstream sweep;
+    sweep << std::setprecision(std::numeric_limits<double>::max_digits10)
+        << std::hex << topology.hash() << ' ' << replay_hash << std::dec
+        << ' ' << num_links << ' ' << converter << ' ' << lambda << ' '
+        << duration_mean << ' ' << total << ' ' << replications << ' '
+        << warm_start;
+    std::ostringstream scenario;
+    scenario << sweep.str() << ' ' << shard.index() << '/' << shard.count();
+    Checkpoint resume_checkpoint;
+    unsigned first_replication = 0;
+    if (!resume_file.empty()) {
+        std::string saved_scenario;
+        bool ok = resume_checkpoint.read(resume_file)
+            && resume_checkpoint.get_string(saved_scenario)
+            && resume_checkpoint.get(seed)
+            && resume_checkpoint.get(first_replication)
+            && resume_checkpoint.get(partial.replications)
+            && resume_checkpoint.get(partial.connections)
+            && resume_checkpoint.get(partial.blocked)
+            && resume_checkpoint.get(partial.sum_blocking)
+            && resume_checkpoint.get(partial.sum_blocking_sq);
+        if (!ok) {
+            std::cerr << "Error reading checkpoint " << resume_file
+                << std::endl;
+            return 1;
+        }
+        if (saved_scenario != scenario.str()) {
+            std::cerr << "Checkpoint " << resume_file << " was saved with "
+                "different options, topology or replayed arrivals"
+                << std::endl;
+            return 1;
+        }
+    }
+    Checkpoint::Writer checkpoint_writer;
+    if (!checkpoint_file.empty()) {
+        checkpoint_writer.start(checkpoint_file);
+    }
+
+    // Results are cached per replication, so that adding replications or
+    // shards reuses the ones already run. Only the counters are cached, so
+    // runs that report more than that are always simulated.
+    ResultCache cache;
+    const bool use_cache = !cache_dir.empty() && !checkpoints
+        && !control_variate && !stratified && trace_file.empty();
+    std::ostringstream cache_scenario;
+    if (use_cache) {
+        cache_scenario
+            << std::setprecision(std::numeric_limits<double>::max_digits10)
+            << std::hex << topology.hash() << ' ' << replay_hash
+            << std::dec << ' ' << num_links << ' ' << converter << ' '
+            << lambda << ' ' << duration_mean << ' ' << total << ' '
+            << warm_start << ' ' << seed << ' ';
+        if (!cache.open(cache_dir)) {
+            std::cerr << "Error opening cache: " << cache.error() << std::endl;
+            return 1;
+        }
+    }
+
+    StatsPage stats_page;
+    if (!stats_page_file.empty()
+            && !stats_page.create(stats_page_file, replications)) {
+        std::cerr << "Error writing " << stats_page_file << std::endl;
+        return 1;
+    }
+
+    PerfCounters perf_counters;
+    if (perf) {
+        if (!perf_counters.open()) {
+            std::cerr << "Performance counters are not available ("
+                << perf_counters.error() << ")" << std::endl;
+            perf = false;
+        }
+        else if (!perf_counters.error().empty()) {
+            std::cerr << "Some performance counters are not available ("
+                << perf_counters.error() << ")" << std::endl;
+        }
+    }
+
+    EventLatency event_latency;
+
+    if (!utilization_file.empty() && utilization_interval <= 0) {
+        std::cerr << "The utilization interval must be positive" << std::endl;
+        return 1;
+    }
+    Utilization utilization{nodes, utilization_interval,
+                            utilization_file.empty() ? 1
+                                                     : utilization_samples};
+
+    // Only of the replications simulated in this run
+    unsigned long events = 0;
+    unsigned long connections = 0;
+    for (unsigned r = first_replication; r < replications; r++) {
+        if (!shard.owns(r)) {
+            continue;
+        }
+        const std::string cache_key =
+            ResultCache::key(cache_scenario.str() + std::to_string(r));
+        Shard::Partial cached;
+        if (use_cache && cache.find(cache_key, cached)) {
+            partial.merge(cached);
+            continue;
+        }
+
+        auto advisor = Advisor{nodes, lambda, duration_mean, seed + r};
+        Simulator simulator{advisor, total};
+        if (warm_start) {
+            simulator.warm_start(offered_loads);
+        }
+        if (control_variate) {
+            simulator.use_control_variate(cv);
+        }
+        if (stratified) {
+            simulator.use_pair_stats(pair_stats, adaptive_pairs);
+        }
+        if (!trace_file.empty()) {
+            simulator.use_trace(trace, r);
+        }
+        if (!replay_file.empty()) {
+            simulator.use_replay(replay);
+        }
+        if (!checkpoint_file.empty()) {
+            simulator.use_checkpoints(
+                    checkpoint_writer, checkpoint_every,
+                    [&](Checkpoint& cp) {
+                        cp.put_string(scenario.str());
+                        cp.put(seed);
+                        cp.put(r);
+                        cp.put(partial.replications);
+                        cp.put(partial.connections);
+                        cp.put(partial.blocked);
+                        cp.put(partial.sum_blocking);
+                        cp.put(partial.sum_blocking_sq);
+                    });
+        }
+        if (!resume_file.empty() && r == first_replication
+                && !simulator.resume(resume_checkpoint)) {
+            std::cerr << "Checkpoint " << resume_file << " does not match "
+                "the network" << std::endl;
+            return 1;
+        }
+        if (stats || forbid_allocations || !timeline_file.empty()) {
+            simulator.use_phase_timer(timer);
+        }
+        if (!timeline_file.empty()) {
+            simulator.use_timeline(timeline, r);
+        }
+        if (latency) {
+            simulator.use_event_latency(event_latency);
+        }
+        if (!stats_page_file.empty()) {
+            simulator.use_stats_page(stats_page, stats_every, r);
+        }
+        if (perf) {
+            simulator.use_perf_counters(perf_counters);
+        }
+        if (!utilization_file.empty()) {
+            simulator.use_utilization(utilization, r);
+        }
+        const Simulator::Result result = simulator.run();
+        partial.add(result);
+        events += result.events;
+        connections += result.connections;
+        if (use_cache) {
+            cached.add(result);
+            if (!cache.insert(cache_key, cached)) {
+                std::cerr << "Error writing cache: " << cache.error()
+                    << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (!checkpoint_file.empty() && !checkpoint_writer.stop()) {
+        std::cerr << "Error writing checkpoint " << checkpoint_file
+            << std::endl;
+        return 1;
+    }
+
+    if (!timeline_file.empty() && !timeline.close()) {
+        std::cerr << "Error writing " << timeline_file << std::endl;
+        return 1;
+    }
+
+    if (!trace_file.empty() && !trace.close()) {
+        std::cerr << "Error writing " << trace_file << std::endl;
+        return 1;
+    }
+
+    if (!utilization_file.empty()) {
+        const std::string csv = ".csv";
+        bool ok;
+        if (utilization_file.size() >= csv.size()
+                && utilization_file.compare(utilization_file.size()
+                                            - csv.size(),
+                                            csv.size(), csv) == 0) {
+            std::ofstream ufs{utilization_file, std::ios::out};
+            utilization.write_csv(ufs);
+            ok = ufs.good();
+        }
+        else {
+            ok = utilization.write_binary(utilization_file);
+        }
+        if (!ok) {
+            std::cerr << "Error writing " << utilization_file << std::endl;
+            return 1;
+        }
+    }
+
+    if (!partial_file.empty()) {
+        // Seeded from the checkpoint if resumed
+        std::ofstream pfs{partial_file, std::ios::out};
+        partial.write(pfs, sweep.str() + " seed " + std::to_string(seed),
+                      shard);
+        if (!pfs.good()) {
+            std::cerr << "Error writing " << partial_file << std::endl;
+            return 1;
+        }
+    }
+
+    stats_page.finish();
+
+    if (stats) {
+        timer.write(std::cerr);
+        double simulation = 0;
+        for (const char* phase : {"warm-up", "measurement"}) {
+            if (timer.find(phase) != nullptr) {
+                simulation += timer.find(phase)->wall;
+            }
+        }
+        const PhaseTimer::Phase* measurement = timer.find("measurement");
+        std::cerr << "events: " << events << " ("
+            << (simulation > 0 ? events / simulation : 0) << " per second)"
+            << ", connections: " << connections << " ("
+            << (measurement != nullptr && measurement->wall > 0
+                ? connections / measurement->wall : 0)
+            << " per second)"
+            << ", peak RSS: " << PhaseTimer::peak_rss() << " kB"
+            << std::endl;
+    }
+
+    if (perf) {
+        perf_counters.write(std::cerr);
+    }
+
+    if (latency) {
+        event_latency.write(std::cerr);
+    }
+
+    const PhaseTimer::Phase* measurement = timer.find("measurement");
+    if (forbid_allocations && measurement != nullptr
+            && measurement->allocations > 0) {
+        std::cerr << measurement->allocations << " heap allocations ("
+            << measurement->bytes << " bytes) in the measurement phase"
+            << std::endl;
+        return 1;
+    }
+
+    if ((counters || counters_json) && !Counters::enabled()) {
+        std::cerr << "Counters were not compiled in; configure with "
+            "-DWITH_COUNTERS=ON" << std::endl;
+    }
+    if (counters_json) {
+        std::cout << "{\"blocking\": " << partial.blocking()
+            << ", \"connections\": " << partial.connections
+            << ", \"blocked\": " << partial.blocked << ", ";
+        Counters::collect().write_json(std::cout);
+        std::cout << "}" << std::endl;
+        return 0;
+    }
+
+    std::cout << partial.blocking() * 100  << " %" << std::endl;
+
+    if (counters && Counters::enabled()) {
+        Counters::collect().write(std::cout);
+    }
+
+    if (theory) {
+        std::cout << "theory: " << erlang_b(load, theory_links) * 100 << " %"
+            << std::endl;
+    }
+
+    if (control_variate) {
+        auto est = cv.estimate();
+        std::cout << "control variate: " << est.corrected * 100 << " %"
+            << " (standard error " << est.std_error * 100 << " %"
+            << " vs " << est.raw_std_error * 100 << " %"
+            << ", variance reduction " << est.variance_reduction * 100 << " %"
+            << ", " << est.batches << " batches)" << std::endl;
+    }
+
+    if (stratified) {
+        auto est = pair_stats.estimate();
+        std::cout << "stratified: " << est.blocking * 100 << " %"
+            << " (standard error " << est.std_error * 100 << " %"
+            << ", " << est.pairs << " pairs)" << std::endl;
+    }
 
     return 0;
 }
@@ -10,6 +10,9 @@
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/visitors.hpp>
 
+#include <functional>
+#include <queue>
+#include <tuple>
 #include <vector>
 
 using Graph = Advisor::Graph;
@@ -240,3 +243,122 @@ BOOST_AUTO_TEST_CASE(advisor_remove_connection_test) {
     advisor.remove_connection(path, wl);
     BOOST_CHECK(advisor.has_path_between(0, 1));
 }
+
+BOOST_AUTO_TEST_CASE(advisor_warm_start_test) {
+    const Event::event_t lambda = 5;
+    const Event::event_t duration_mean = 1;
+
+    Graph nodes;
+    boost::add_edge(0, 1, Link(10), nodes);
+    boost::add_edge(1, 2, Link(10), nodes);
+    Advisor advisor{nodes, lambda, duration_mean, 1};
+
+    // No load on the first link, a very high load on the second one
+    auto connections = advisor.warm_start(std::vector<double>{0, 1000});
+    BOOST_CHECK_EQUAL(connections.size(), 10);
+
+    edge_t e01, e12;
+    std::tie(e01, std::ignore) = boost::edge(0, 1, advisor.graph());
+    std::tie(e12, std::ignore) = boost::edge(1, 2, advisor.graph());
+    BOOST_CHECK(advisor.graph()[e01].used_wavelengths().empty());
+    BOOST_CHECK(advisor.graph()[e12].available_wavelengths().empty());
+    BOOST_CHECK(!advisor.has_path_between(0, 2));
+
+    // Releasing the connections empties the network again
+    for (const auto& c : connections) {
+        BOOST_CHECK(std::get<0>(c) == e12);
+        BOOST_CHECK_GT(std::get<2>(c), 0);
+        advisor.remove_connection(std::vector<edge_t>{std::get<0>(c)},
+                                  std::get<1>(c));
+    }
+    BOOST_CHECK(advisor.has_path_between(0, 2));
+}
+
+BOOST_AUTO_TEST_CASE(advisor_warm_start_occupancy_test) {
+    // A load of 5 on one link of 10 wavelengths
+    const unsigned num_links = 10;
+    const Event::event_t lambda = 5;
+    const Event::event_t duration_mean = 1;
+    Graph nodes;
+    boost::add_edge(0, 1, Link(num_links), nodes);
+    edge_t edge;
+
+    // Fraction of the time each wavelength is busy after a long warm-up,
+    // indexed by wavelength (from 1)
+    std::vector<double> long_run(num_links + 1, 0);
+    {
+        const Event::event_t warm_up = 1000;
+        const Event::event_t end = warm_up + 20000;
+        // The part of [start, until) after the warm-up and before the end
+        auto count = [&](const Event::event_t start,
+                         const Event::event_t until,
+                         const Link::wavelength_t wl) {
+            const Event::event_t from = std::max(start, warm_up);
+            const Event::event_t to = std::min(until, end);
+            if (to > from) {
+                long_run[wl] += (to - from) / (end - warm_up);
+            }
+        };
+
+        // End, start and wavelength of each connection, earliest end first
+        using Connection =
+            std::tuple<Event::event_t, Event::event_t, Link::wavelength_t>;
+        std::priority_queue<Connection, std::vector<Connection>,
+                            std::greater<Connection>> ends;
+        Advisor advisor{nodes, lambda, duration_mean, 7};
+        std::tie(edge, std::ignore) = boost::edge(0, 1, advisor.graph());
+        Event::event_t now = 0;
+        while (now < end) {
+            now += advisor.get_arrival();
+            while (!ends.empty() && std::get<0>(ends.top()) < now) {
+                const Connection& c = ends.top();
+                count(std::get<1>(c), std::get<0>(c), std::get<2>(c));
+                advisor.remove_connection(std::vector<edge_t>{edge},
+                                          std::get<2>(c));
+                ends.pop();
+            }
+            const auto connection = advisor.make_connection(0, 1);
+            if (connection.second != Link::NONE) {
+                ends.emplace(now + advisor.get_duration(), now,
+                             connection.second);
+            }
+        }
+        for (; !ends.empty(); ends.pop()) {
+            const Connection& c = ends.top();
+            count(std::get<1>(c), std::get<0>(c), std::get<2>(c));
+        }
+    }
+
+    // Fraction of warm starts in which each wavelength is busy
+    std::vector<double> warm(num_links + 1, 0);
+    Advisor advisor{nodes, lambda, duration_mean, 11};
+    std::tie(edge, std::ignore) = boost::edge(0, 1, advisor.graph());
+    const unsigned starts = 20000;
+    double mean_busy = 0;
+    for (unsigned s = 0; s < starts; s++) {
+        const auto connections = advisor.warm_start(
+                std::vector<double>{lambda / duration_mean});
+        mean_busy += connections.size();
+        for (const auto& c : connections) {
+            warm[std::get<1>(c)] += 1.0 / starts;
+            advisor.remove_connection(std::vector<edge_t>{edge},
+                                      std::get<1>(c));
+        }
+    }
+    mean_busy /= starts;
+
+    // Both are dense at the low wavelengths and sparse at the high ones
+    // (a uniform choice would make each busy about half the time); first
+    // fit leaves some holes that the warm start does not
+    double total = 0;
+    for (unsigned wl = 1; wl <= num_links; wl++) {
+        BOOST_TEST_MESSAGE("wavelength " << wl << ": " << long_run[wl]
+                           << " after a warm-up, " << warm[wl]
+                           << " warm started");
+        BOOST_CHECK_SMALL(warm[wl] - long_run[wl], 0.2);
+        total += long_run[wl];
+    }
+    BOOST_CHECK_GT(warm[1], 0.9);
+    BOOST_CHECK_LT(warm.back(), 0.1);
+    BOOST_CHECK_CLOSE(mean_busy, total, 3);
+}
@@ -0,0 +1,154 @@
+#define BOOST_TEST_MODULE AllocationTrackerTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "AllocationTracker.h"
+#include "Link.h"
+#include "PhaseTimer.h"
+#include "Simulator.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef EBM_ALLOCATION_TRACKER
+BOOST_AUTO_TEST_CASE(allocation_tracker_not_compiled_in_test) {
+    BOOST_CHECK(!AllocationTracker::compiled_in());
+    AllocationTracker::enable();
+    BOOST_CHECK(!AllocationTracker::enabled());
+    {
+        std::vector<char> v(1000);
+        BOOST_CHECK_EQUAL(v.size(), 1000);
+    }
+    BOOST_CHECK_EQUAL(AllocationTracker::totals().allocations, 0);
+    AllocationTracker::enable(false);
+}
+#else
+namespace {
+/**
+ * Ring of `n' nodes with one chord, so that some paths have a choice.
+ */
+Advisor::Graph
+ring(const unsigned n, const unsigned wavelengths) {
+    Advisor::Graph g;
+    for (unsigned i = 0; i < n; i++) {
+        boost::add_edge(i, (i + 1) % n, Link(wavelengths), g);
+    }
+    boost::add_edge(0, n / 2, Link(wavelengths), g);
+    return g;
+}
+}
+
+BOOST_AUTO_TEST_CASE(allocation_tracker_count_test) {
+    BOOST_CHECK(AllocationTracker::compiled_in());
+    AllocationTracker::enable();
+    BOOST_CHECK(AllocationTracker::enabled());
+
+    const AllocationTracker::Totals before = AllocationTracker::totals();
+    {
+        std::unique_ptr<std::vector<char>> v{new std::vector<char>(1000)};
+        BOOST_CHECK_EQUAL(v->size(), 1000);
+    }
+    const AllocationTracker::Totals after =
+        AllocationTracker::totals().since(before);
+    // The vector object and its elements
+    BOOST_CHECK_EQUAL(after.allocations, 2);
+    BOOST_CHECK_EQUAL(after.frees, 2);
+    BOOST_CHECK_GE(after.bytes, 1000 + sizeof(std::vector<char>));
+    BOOST_CHECK_GE(after.peak, before.live + 1000);
+    BOOST_CHECK_EQUAL(after.live, before.live);
+
+    AllocationTracker::enable(false);
+    const AllocationTracker::Totals off = AllocationTracker::totals();
+    {
+        std::vector<char> v(1000);
+        BOOST_CHECK_EQUAL(v.size(), 1000);
+    }
+    BOOST_CHECK_EQUAL(AllocationTracker::totals().allocations,
+                      off.allocations);
+}
+
+BOOST_AUTO_TEST_CASE(allocation_tracker_untracked_free_test) {
+    AllocationTracker::enable(false);
+    std::unique_ptr<std::vector<char>> untracked{
+        new std::vector<char>(100000)};
+
+    AllocationTracker::enable();
+    const AllocationTracker::Totals before = AllocationTracker::totals();
+    std::unique_ptr<std::vector<char>> tracked{new std::vector<char>(1000)};
+    // Freeing a block allocated while tracking was off changes nothing
+    untracked.reset();
+    AllocationTracker::Totals after = AllocationTracker::totals();
+    BOOST_CHECK_EQUAL(after.frees, before.frees);
+    BOOST_CHECK_GE(after.live, before.live + 1000);
+    BOOST_CHECK_GE(after.live, 0);
+
+    // A counted block is subtracted even once tracking is off
+    AllocationTracker::enable(false);
+    tracked.reset();
+    after = AllocationTracker::totals();
+    BOOST_CHECK_EQUAL(after.frees, before.frees + 2);
+    BOOST_CHECK_EQUAL(after.live, before.live);
+}
+
+BOOST_AUTO_TEST_CASE(allocation_tracker_path_test) {
+    Advisor::Graph g = ring(8, 4);
+    Advisor advisor{g, 1, 1, 42};
+    std::vector<Advisor::edge_t> path;
+    AllocationTracker::Totals before;
+    unsigned found = 0;
+    // The first pass grows the buffers, the second one only reuses them
+    for (unsigned pass = 0; pass < 2; pass++) {
+        AllocationTracker::enable();
+        before = AllocationTracker::totals();
+        found = 0;
+        for (Advisor::vertex_t a = 0; a < 8; a++) {
+            for (Advisor::vertex_t b = 0; b < 8; b++) {
+                if (a != b
+                        && advisor.path_between(a, b, path) != Link::NONE
+                        && advisor.has_path_between(b, a)) {
+                    found++;
+                }
+            }
+        }
+        AllocationTracker::enable(false);
+    }
+    BOOST_CHECK_EQUAL(AllocationTracker::totals().since(before).allocations,
+                      0);
+    BOOST_CHECK_EQUAL(found, 8 * 7);
+
+    // Same result as the allocating overload
+    const auto p = advisor.path_between(2, 7);
+    BOOST_CHECK_EQUAL(advisor.path_between(2, 7, path), p.second);
+    BOOST_CHECK(path == p.first);
+}
+
+BOOST_AUTO_TEST_CASE(allocation_tracker_simulator_test) {
+    Advisor::Graph g = ring(8, 4);
+    Advisor advisor{g, 6, 1, 42};
+    Simulator simulator{advisor, 20000, 5000};
+
+    AllocationTracker::enable();
+    PhaseTimer timer;
+    simulator.use_phase_timer(timer);
+    const auto result = simulator.run();
+    AllocationTracker::enable(false);
+    BOOST_CHECK_GT(result.blocked, 0);
+
+    const PhaseTimer::Phase* warm_up = timer.find("warm-up");
+    const PhaseTimer::Phase* measurement = timer.find("measurement");
+    BOOST_REQUIRE(warm_up != nullptr);
+    BOOST_REQUIRE(measurement != nullptr);
+    // Buffers grow while warming up and are only reused afterwards
+    BOOST_CHECK_GT(warm_up->allocations, 0);
+    BOOST_CHECK_GT(warm_up->peak, 0);
+    BOOST_CHECK_EQUAL(measurement->allocations, 0);
+
+    std::ostringstream oss;
+    timer.write(oss);
+    BOOST_CHECK(oss.str().find("allocations") != std::string::npos);
+}
+#endif
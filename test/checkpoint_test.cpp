@@ -0,0 +1,92 @@
+#define BOOST_TEST_MODULE CheckpointTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Checkpoint.h"
+#include "Link.h"
+#include "Simulator.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <cstdio>
+#include <string>
+
+BOOST_AUTO_TEST_CASE(checkpoint_values_test) {
+    const std::string filename = "checkpoint_test.ckpt";
+
+    Checkpoint checkpoint;
+    checkpoint.put(42u);
+    checkpoint.put_string("scenario");
+    checkpoint.put(0.125);
+    BOOST_REQUIRE(checkpoint.write(filename));
+
+    Checkpoint read;
+    BOOST_REQUIRE(read.read(filename));
+    unsigned u;
+    std::string s;
+    double d;
+    BOOST_CHECK(read.get(u));
+    BOOST_CHECK_EQUAL(u, 42);
+    BOOST_CHECK(read.get_string(s));
+    BOOST_CHECK_EQUAL(s, "scenario");
+    BOOST_CHECK(read.get(d));
+    BOOST_CHECK_EQUAL(d, 0.125);
+    BOOST_CHECK(read.at_end());
+    BOOST_CHECK(!read.get(u));
+
+    std::remove(filename.c_str());
+    BOOST_CHECK(!read.read(filename));
+}
+
+BOOST_AUTO_TEST_CASE(checkpoint_resume_test) {
+    const std::string filename = "checkpoint_resume_test.ckpt";
+    Advisor::Graph g;
+    for (unsigned v = 0; v < 3; v++) {
+        boost::add_edge(v, v + 1, Link(2), g);
+    }
+
+    // Uninterrupted run
+    Advisor advisor{g, 4, 1, 11};
+    Simulator simulator{advisor, 600};
+    const auto expected = simulator.run();
+
+    // Same run, saving checkpoints along the way
+    Checkpoint::Writer writer;
+    writer.start(filename);
+    Advisor saving_advisor{g, 4, 1, 11};
+    Simulator saving{saving_advisor, 600};
+    saving.use_checkpoints(writer, 250, [](Checkpoint& cp) {
+        cp.put_string("header");
+    });
+    const auto saved = saving.run();
+    BOOST_REQUIRE(writer.stop());
+    BOOST_CHECK_GT(writer.written(), 0);
+    BOOST_CHECK_EQUAL(saved.connections, expected.connections);
+    BOOST_CHECK_EQUAL(saved.blocked, expected.blocked);
+
+    // Resuming from the last checkpoint gives exactly the same result, even
+    // with a different seed
+    Checkpoint checkpoint;
+    BOOST_REQUIRE(checkpoint.read(filename));
+    std::string header;
+    BOOST_REQUIRE(checkpoint.get_string(header));
+    BOOST_CHECK_EQUAL(header, "header");
+    Advisor resumed_advisor{g, 4, 1, 99};
+    Simulator resumed{resumed_advisor, 600};
+    BOOST_REQUIRE(resumed.resume(checkpoint));
+    BOOST_CHECK(checkpoint.at_end());
+    const auto result = resumed.run();
+    BOOST_CHECK_EQUAL(result.connections, expected.connections);
+    BOOST_CHECK_EQUAL(result.blocked, expected.blocked);
+
+    // A different network does not match
+    Advisor::Graph other;
+    boost::add_edge(0, 1, Link(2), other);
+    BOOST_REQUIRE(checkpoint.read(filename));
+    BOOST_REQUIRE(checkpoint.get_string(header));
+    Advisor other_advisor{other, 4, 1, 11};
+    Simulator other_simulator{other_advisor, 600};
+    BOOST_CHECK(!other_simulator.resume(checkpoint));
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,46 @@
+#define BOOST_TEST_MODULE ControlVariateTest
+#include <boost/test/unit_test.hpp>
+
+#include "ControlVariate.h"
+
+BOOST_AUTO_TEST_CASE(control_variate_empty_test) {
+    ControlVariate cv{1, 1, 10};
+    auto est = cv.estimate();
+    BOOST_CHECK_EQUAL(est.batches, 0);
+    BOOST_CHECK_EQUAL(est.corrected, 0);
+
+    // Incomplete batches are ignored
+    for (unsigned i = 0; i < 9; i++) {
+        cv.arrival(1, true, 0);
+    }
+    BOOST_CHECK_EQUAL(cv.estimate().batches, 0);
+    cv.arrival(1, true, 0);
+    est = cv.estimate();
+    BOOST_CHECK_EQUAL(est.batches, 1);
+    BOOST_CHECK_CLOSE(est.raw, 1.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(control_variate_linear_test) {
+    const unsigned batch_size = 4;
+    ControlVariate cv{1, 1, batch_size};
+
+    // Blocking is exactly linear in the inter-arrival control:
+    // blocking = 0.5 + 2.5 * (t - 1)
+    for (unsigned k = 0; k < 40; k++) {
+        const unsigned blocked = 1 + k % 4;
+        const double t = 1 + (blocked - 2.0) * 0.1;
+        for (unsigned i = 0; i < batch_size; i++) {
+            const double d = 1 + 0.01 * (k % 3);
+            cv.arrival(t, i < blocked, d);
+        }
+    }
+
+    auto est = cv.estimate();
+    BOOST_CHECK_EQUAL(est.batches, 40);
+    BOOST_CHECK_CLOSE(est.raw, 0.625, 1e-9);
+    // The controls have expectation zero, so the correction removes the
+    // offset of the inter-arrival times
+    BOOST_CHECK_CLOSE(est.corrected, 0.5, 1e-6);
+    BOOST_CHECK_SMALL(est.std_error, 1e-6);
+    BOOST_CHECK_GT(est.variance_reduction, 0.99);
+}
@@ -0,0 +1,62 @@
+#define BOOST_TEST_MODULE CountersTest
+#include <boost/test/unit_test.hpp>
+
+// Count in this file regardless of how the libraries were configured
+#ifndef EBM_COUNTERS
+#define EBM_COUNTERS
+#endif
+#include "Counters.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(counters_threads_test) {
+    Counters::reset();
+
+    const unsigned num_threads = 4;
+    const unsigned long n = 100000;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; t++) {
+        threads.emplace_back([=]() {
+            for (unsigned long i = 0; i < n; i++) {
+                Counters::add(Counters::BFS);
+                Counters::add(Counters::EDGES_VISITED, 2);
+            }
+            Counters::maximum(Counters::QUEUE_DEPTH, 10 + t);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Counters::add(Counters::LOCKS, 3);
+    Counters::maximum(Counters::QUEUE_DEPTH, 5);
+
+    // Blocks of finished threads are still counted
+    const Counters c = Counters::collect();
+    BOOST_CHECK_EQUAL(c.get(Counters::BFS), num_threads * n);
+    BOOST_CHECK_EQUAL(c.get(Counters::EDGES_VISITED), 2 * num_threads * n);
+    BOOST_CHECK_EQUAL(c.get(Counters::LOCKS), 3);
+    BOOST_CHECK_EQUAL(c.get(Counters::RELEASES), 0);
+    BOOST_CHECK_EQUAL(c.get(Counters::QUEUE_DEPTH), 10 + num_threads - 1);
+
+    Counters::reset();
+    const Counters zero = Counters::collect();
+    BOOST_CHECK_EQUAL(zero.get(Counters::BFS), 0);
+    BOOST_CHECK_EQUAL(zero.get(Counters::QUEUE_DEPTH), 0);
+}
+
+BOOST_AUTO_TEST_CASE(counters_json_test) {
+    Counters::reset();
+    Counters::add(Counters::SEARCHES, 7);
+    Counters::maximum(Counters::WAVELENGTHS_PER_SEARCH, 4);
+
+    std::ostringstream oss;
+    Counters::collect().write_json(oss);
+    const std::string json = oss.str();
+    BOOST_CHECK_EQUAL(json.find("\"searches\": 7"), 0);
+    BOOST_CHECK(json.find("\"max_wavelengths_per_search\": 4")
+                != std::string::npos);
+    BOOST_CHECK(json.find("\"locks\": 0") != std::string::npos);
+}
@@ -0,0 +1,80 @@
+#define BOOST_TEST_MODULE DimensioningTest
+#include <boost/test/unit_test.hpp>
+
+#include "Dimensioning.h"
+#include "Erlang.h"
+#include "Link.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+using Graph = Advisor::Graph;
+
+BOOST_AUTO_TEST_CASE(dimensioning_single_link_test) {
+    Graph g;
+    boost::add_edge(0, 1, Link(1), g);
+
+    Dimensioning dim{g, true, 5, 1, 100, 1};
+    auto a = dim.solve(0.01);
+    BOOST_CHECK(a.feasible);
+    BOOST_REQUIRE_EQUAL(a.capacities.size(), 1);
+    // Same as inverting Erlang B directly
+    BOOST_CHECK_EQUAL(a.capacities[0], erlang_b_capacity(5, 0.01));
+    BOOST_CHECK_EQUAL(a.total, a.capacities[0]);
+    BOOST_CHECK_LE(a.analytic_blocking, 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(dimensioning_bus_test) {
+    Graph g;
+    for (unsigned i = 0; i < 5; i++) {
+        boost::add_edge(i, i + 1, Link(1), g);
+    }
+
+    Dimensioning dim{g, true, 10, 1, 100, 1};
+    auto a = dim.solve(0.001);
+    BOOST_CHECK(a.feasible);
+    BOOST_CHECK_LE(a.analytic_blocking, 0.001);
+    // The middle links carry more routes than the ends
+    BOOST_CHECK_GT(a.capacities[2], a.capacities[0]);
+
+    auto dimensioned = dim.make_graph(a.capacities);
+    boost::graph_traits<Graph>::edge_iterator e_b, e_e;
+    std::tie(e_b, e_e) = boost::edges(dimensioned);
+    unsigned i = 0;
+    for (auto it = e_b; it != e_e; it++, i++) {
+        BOOST_CHECK_EQUAL(dimensioned[*it].num_wavelengths(),
+                          a.capacities[i]);
+        BOOST_CHECK(dimensioned[*it].has_converter());
+    }
+
+    // Not enough wavelengths allowed
+    Dimensioning small{g, true, 10, 1, 2, 1};
+    BOOST_CHECK(!small.solve(0.001).feasible);
+}
+
+BOOST_AUTO_TEST_CASE(dimensioning_simulation_test) {
+    Graph g;
+    boost::add_edge(0, 1, Link(1), g);
+
+    Dimensioning dim{g, true, 3, 1, 100, 1};
+    // Runs of 2000 / (4 * MAX_ROUNDS) = 125 connections
+    dim.set_simulation(2000, 4, 7);
+    auto a = dim.solve(0.05);
+    BOOST_CHECK_GT(a.connections_simulated, 0);
+    // The whole search stays within the budget, give or take one
+    // connection per run
+    BOOST_CHECK_LE(a.connections_simulated,
+                   2000 + 4 * Dimensioning::MAX_ROUNDS);
+
+    // A small target needs more runs to be told apart, within the same
+    // budget
+    Dimensioning tight{g, true, 3, 1, 100, 1};
+    tight.set_simulation(2000, 4, 7);
+    const auto b = tight.solve(1e-4);
+    BOOST_CHECK_LE(b.connections_simulated,
+                   2000 + 4 * Dimensioning::MAX_ROUNDS);
+    // No blocked connection in 2000 cannot show a blocking below 1e-4
+    BOOST_CHECK_LE(b.analytic_blocking, 1e-4);
+    BOOST_CHECK_EQUAL(b.simulated_blocking, 0);
+    BOOST_CHECK_GT(b.upper_bound, 1e-4);
+    BOOST_CHECK(!b.feasible);
+}
@@ -0,0 +1,84 @@
+#define BOOST_TEST_MODULE ErlangTest
+#include <boost/test/unit_test.hpp>
+
+#include "Erlang.h"
+
+#include <limits>
+#include <vector>
+
+// Small tables can be built at compile time
+static_assert(erlang_b_static(1, 0) == 1, "No servers always block");
+static_assert(erlang_b_static(1, 1) == 0.5, "B(1, 1) = 1 / 2");
+static_assert(erlang_b_static(2, 2) == 0.4, "B(2, 2) = 2 / 5");
+
+BOOST_AUTO_TEST_CASE(erlang_b_test) {
+    BOOST_CHECK_EQUAL(erlang_b(5, 0), 1);
+    BOOST_CHECK_CLOSE(erlang_b(1, 1), 0.5, 1e-12);
+    // Known values
+    BOOST_CHECK_CLOSE(erlang_b(5, 5), 0.28487, 0.01);
+    BOOST_CHECK_CLOSE(erlang_b(10, 10), 0.21458, 0.01);
+
+    // Large capacities do not overflow
+    const double large = erlang_b(9000, 10000);
+    BOOST_CHECK_GT(large, 0);
+    BOOST_CHECK_LT(large, 1e-6);
+
+    BOOST_CHECK_CLOSE(erlang_b(5, 5), erlang_b_static(5, 5), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(erlang_b_batch_test) {
+    std::vector<double> loads = {1, 5, 10, 40, 0.5, 100};
+    std::vector<unsigned> capacities = {1, 5, 10, 60, 0, 120};
+    std::vector<double> out(loads.size());
+
+    erlang_b(loads.data(), capacities.data(), out.data(), loads.size());
+    for (unsigned i = 0; i < loads.size(); i++) {
+        BOOST_CHECK_CLOSE(out[i], erlang_b(loads[i], capacities[i]), 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(erlang_b_capacity_test) {
+    // Smallest capacity reaching the target
+    const unsigned c = erlang_b_capacity(40, 1e-3);
+    BOOST_CHECK_LE(erlang_b(40, c), 1e-3);
+    BOOST_CHECK_GT(erlang_b(40, c - 1), 1e-3);
+
+    BOOST_CHECK_EQUAL(erlang_b_capacity(5, 1), 0);
+
+    std::vector<double> loads = {40, 5, 1, 0.1};
+    std::vector<double> targets = {1e-3, 0.01, 0.5, 0.2};
+    std::vector<unsigned> out(loads.size());
+    erlang_b_capacity(loads.data(), targets.data(), out.data(), loads.size());
+    for (unsigned i = 0; i < loads.size(); i++) {
+        BOOST_CHECK_EQUAL(out[i], erlang_b_capacity(loads[i], targets[i]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(erlang_b_capacity_unreachable_test) {
+    const unsigned never = std::numeric_limits<unsigned>::max();
+    BOOST_CHECK_EQUAL(erlang_b_capacity(5, 0), never);
+    BOOST_CHECK_EQUAL(erlang_b_capacity(5, -0.1), never);
+    // Without load, one server never blocks, but a negative target is still
+    // out of reach
+    BOOST_CHECK_EQUAL(erlang_b_capacity(0, 0), 1);
+    BOOST_CHECK_EQUAL(erlang_b_capacity(0, -0.1), never);
+
+    // Unreachable targets mixed with systems that take several steps
+    std::vector<double> loads = {5, 40, 0, 5, 0, 1};
+    std::vector<double> targets = {-0.5, 1e-3, -1, 0, 0, 1};
+    std::vector<unsigned> out(loads.size());
+    erlang_b_capacity(loads.data(), targets.data(), out.data(), loads.size());
+    const std::vector<unsigned> expected = {
+        never, erlang_b_capacity(40, 1e-3), never, never, 1, 0};
+    BOOST_CHECK_EQUAL_COLLECTIONS(out.begin(), out.end(),
+                                  expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(erlang_b_load_test) {
+    const double a = erlang_b_load(10, 0.01);
+    BOOST_CHECK_CLOSE(erlang_b(a, 10), 0.01, 1e-6);
+    // Known value: 10 servers carry 4.46 Erlangs at 1%
+    BOOST_CHECK_CLOSE(a, 4.46, 0.5);
+
+    BOOST_CHECK_EQUAL(erlang_b_load(0, 0.01), 0);
+}
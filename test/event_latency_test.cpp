@@ -0,0 +1,111 @@
+#define BOOST_TEST_MODULE EventLatencyTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "EventLatency.h"
+#include "Link.h"
+#include "Simulator.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using Histogram = EventLatency::Histogram;
+
+BOOST_AUTO_TEST_CASE(event_latency_bucket_test) {
+    std::size_t last = 0;
+    for (std::uint64_t v = 0; v < 1 << 20; v += 1 + v / 100) {
+        const std::size_t b = Histogram::bucket(v);
+        BOOST_REQUIRE_LT(b, Histogram::NUM_BUCKETS);
+        BOOST_REQUIRE_GE(b, last);
+        last = b;
+        // Within 1/32 of the value
+        BOOST_REQUIRE_GE(Histogram::highest(b), v);
+        BOOST_REQUIRE_LE(Histogram::highest(b) - v, v / 32);
+    }
+    // Small values are exact
+    for (std::uint64_t v = 0; v < 64; v++) {
+        BOOST_CHECK_EQUAL(Histogram::highest(Histogram::bucket(v)), v);
+    }
+    const std::uint64_t largest = ~std::uint64_t{0};
+    BOOST_CHECK_EQUAL(Histogram::bucket(largest), Histogram::NUM_BUCKETS - 1);
+    BOOST_CHECK_EQUAL(Histogram::highest(Histogram::NUM_BUCKETS - 1),
+                      largest);
+}
+
+BOOST_AUTO_TEST_CASE(event_latency_histogram_test) {
+    Histogram h;
+    BOOST_CHECK_EQUAL(h.value_at(0.5), 0);
+    for (std::uint64_t v = 1; v <= 10000; v++) {
+        h.record(v);
+    }
+    BOOST_CHECK_EQUAL(h.count(), 10000);
+    BOOST_CHECK_EQUAL(h.max(), 10000);
+    BOOST_CHECK_CLOSE(h.mean(), 5000.5, 1e-9);
+    BOOST_CHECK_CLOSE(static_cast<double>(h.value_at(0.5)), 5000, 3.2);
+    BOOST_CHECK_CLOSE(static_cast<double>(h.value_at(0.99)), 9900, 3.2);
+    BOOST_CHECK_CLOSE(static_cast<double>(h.value_at(0.999)), 9990, 3.2);
+    BOOST_CHECK_EQUAL(h.value_at(1), 10000);
+    BOOST_CHECK_EQUAL(h.value_at(0), 1);
+
+    // One outlier moves the maximum and the tail but not the median
+    Histogram outlier;
+    outlier.record(1000000);
+    h.merge(outlier);
+    BOOST_CHECK_EQUAL(h.count(), 10001);
+    BOOST_CHECK_EQUAL(h.max(), 1000000);
+    BOOST_CHECK_EQUAL(h.value_at(1), 1000000);
+    BOOST_CHECK_CLOSE(static_cast<double>(h.value_at(0.5)), 5000, 3.2);
+
+    h.reset();
+    BOOST_CHECK_EQUAL(h.count(), 0);
+    BOOST_CHECK_EQUAL(h.max(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(event_latency_clock_test) {
+    EventLatency latency;
+    BOOST_CHECK_EQUAL(latency.ns_per_tick(), 1);
+    latency.start();
+    const std::uint64_t before = EventLatency::ticks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const std::uint64_t after = EventLatency::ticks();
+    latency.stop();
+    BOOST_CHECK_GT(after, before);
+    latency.record(EventLatency::END, after - before);
+
+    // Roughly 20 ms, however fast the counter is
+    BOOST_CHECK_GT(latency.ns_per_tick(), 0);
+    BOOST_CHECK_CLOSE(latency.quantile(EventLatency::END, 1), 20e6, 50);
+}
+
+BOOST_AUTO_TEST_CASE(event_latency_simulator_test) {
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(2), g);
+    boost::add_edge(1, 2, Link(2), g);
+    Advisor advisor{g, 3, 1, 42};
+    Simulator simulator{advisor, 1000, 100};
+
+    EventLatency latency;
+    simulator.use_event_latency(latency);
+    const auto result = simulator.run();
+
+    const std::uint64_t accepted =
+        latency.histogram(EventLatency::START_ACCEPTED).count();
+    const std::uint64_t blocked =
+        latency.histogram(EventLatency::START_BLOCKED).count();
+    // Only measured arrivals
+    BOOST_CHECK_EQUAL(accepted + blocked, result.connections);
+    BOOST_CHECK_GT(blocked, 0);
+    BOOST_CHECK_GT(latency.histogram(EventLatency::END).count(), 0);
+    BOOST_CHECK_GT(latency.ns_per_tick(), 0);
+    BOOST_CHECK_GT(latency.quantile(EventLatency::START_ACCEPTED, 0.5), 0);
+    BOOST_CHECK_LE(latency.quantile(EventLatency::START_ACCEPTED, 0.5),
+                   latency.quantile(EventLatency::START_ACCEPTED, 0.999));
+
+    std::ostringstream oss;
+    latency.write(oss);
+    BOOST_CHECK(oss.str().find("START blocked") != std::string::npos);
+    BOOST_CHECK(oss.str().find("p99.9") != std::string::npos);
+}
@@ -0,0 +1,29 @@
+#define BOOST_TEST_MODULE LadderTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Ladder.h"
+#include "Link.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+BOOST_AUTO_TEST_CASE(ladder_run_test) {
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(1), g);
+
+    const unsigned max_wavelengths = 4;
+    Ladder ladder{g, max_wavelengths, false, 3, 1, 42};
+    auto results = ladder.run(2000);
+    BOOST_REQUIRE_EQUAL(results.size(), max_wavelengths);
+
+    // Every capacity sees exactly the same connections
+    for (const auto& r : results) {
+        BOOST_CHECK_EQUAL(r.connections, 2000);
+    }
+
+    // More wavelengths, less blocking
+    for (unsigned i = 1; i < results.size(); i++) {
+        BOOST_CHECK_LE(results[i].blocked, results[i - 1].blocked);
+    }
+    BOOST_CHECK_GT(results.front().blocked, 0);
+}
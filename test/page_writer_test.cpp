@@ -0,0 +1,53 @@
+#define BOOST_TEST_MODULE PageWriterTest
+#include <boost/test/unit_test.hpp>
+
+#include "PageWriter.h"
+
+#include <numeric>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(page_writer_order_test) {
+    std::vector<int> written;
+    PageWriter writer;
+    writer.start([&written](const void* page, const std::size_t size) {
+        const int* p = static_cast<const int*>(page);
+        written.insert(written.end(), p, p + size);
+        return true;
+    });
+    BOOST_CHECK(writer.running());
+
+    // Two pages filled in turn, as the users of PageWriter do
+    std::vector<int> pages[2] = {std::vector<int>(3), std::vector<int>(3)};
+    unsigned current = 0;
+    for (int i = 0; i < 30; i += 3) {
+        std::iota(pages[current].begin(), pages[current].end(), i);
+        writer.submit(pages[current].data(), pages[current].size());
+        current ^= 1;
+    }
+    BOOST_CHECK(writer.stop());
+    BOOST_CHECK(!writer.running());
+
+    std::vector<int> expected(30);
+    std::iota(expected.begin(), expected.end(), 0);
+    BOOST_CHECK(written == expected);
+}
+
+BOOST_AUTO_TEST_CASE(page_writer_failure_test) {
+    unsigned calls = 0;
+    PageWriter writer;
+    writer.start([&calls](const void*, const std::size_t) {
+        return ++calls != 2;
+    });
+    const char page[4] = {};
+    for (unsigned i = 0; i < 3; i++) {
+        writer.submit(page, sizeof(page));
+    }
+    // A failed page is reported even if later ones are written
+    BOOST_CHECK(!writer.stop());
+    BOOST_CHECK_EQUAL(calls, 3);
+
+    // A new start forgets the failure
+    writer.start([](const void*, const std::size_t) { return true; });
+    writer.submit(page, sizeof(page));
+    BOOST_CHECK(writer.stop());
+}
@@ -0,0 +1,80 @@
+#define BOOST_TEST_MODULE PairStatsTest
+#include <boost/test/unit_test.hpp>
+
+#include "PairStats.h"
+
+BOOST_AUTO_TEST_CASE(pair_stats_record_test) {
+    PairStats stats{3};
+    BOOST_CHECK_EQUAL(stats.num_vertices(), 3);
+    BOOST_CHECK_EQUAL(stats.estimate().pairs, 0);
+
+    stats.record(0, 1, true);
+    stats.record(0, 1, false);
+    stats.record(2, 1, false);
+
+    BOOST_CHECK_EQUAL(stats.attempts(0, 1), 2);
+    BOOST_CHECK_EQUAL(stats.blocked(0, 1), 1);
+    BOOST_CHECK_EQUAL(stats.attempts(1, 0), 0);
+    BOOST_CHECK_EQUAL(stats.attempts(2, 1), 1);
+}
+
+BOOST_AUTO_TEST_CASE(pair_stats_estimate_test) {
+    PairStats stats{2};
+
+    // Pair (0, 1) is sampled much more often than (1, 0), but both pairs
+    // weigh the same in the estimate
+    for (unsigned i = 0; i < 90; i++) {
+        stats.record(0, 1, i % 2 == 0);
+    }
+    for (unsigned i = 0; i < 10; i++) {
+        stats.record(1, 0, false);
+    }
+
+    auto est = stats.estimate();
+    BOOST_CHECK_EQUAL(est.pairs, 2);
+    BOOST_CHECK_CLOSE(est.blocking, 0.25, 1e-9);
+    BOOST_CHECK_GT(est.std_error, 0);
+}
+
+BOOST_AUTO_TEST_CASE(pair_stats_never_blocked_test) {
+    PairStats stats{2};
+    for (unsigned i = 0; i < 50; i++) {
+        stats.record(0, 1, false);
+        stats.record(1, 0, false);
+    }
+
+    // No blocking seen does not mean no uncertainty
+    auto est = stats.estimate();
+    BOOST_CHECK_EQUAL(est.blocking, 0);
+    BOOST_CHECK_GT(est.std_error, 0);
+
+    // Likewise for pairs that always block
+    PairStats always{2};
+    for (unsigned i = 0; i < 50; i++) {
+        always.record(0, 1, true);
+    }
+    est = always.estimate();
+    BOOST_CHECK_EQUAL(est.blocking, 1);
+    BOOST_CHECK_GT(est.std_error, 0);
+    BOOST_CHECK_GT(always.neyman_weights()[0 * 2 + 1], 0);
+}
+
+BOOST_AUTO_TEST_CASE(pair_stats_neyman_weights_test) {
+    PairStats stats{3};
+    for (unsigned i = 0; i < 100; i++) {
+        // Never blocks
+        stats.record(0, 1, false);
+        // Blocks half the time
+        stats.record(0, 2, i % 2 == 0);
+    }
+
+    auto w = stats.neyman_weights();
+    BOOST_REQUIRE_EQUAL(w.size(), 9);
+    // No weight for connecting a node to itself
+    BOOST_CHECK_EQUAL(w[0 * 3 + 0], 0);
+    BOOST_CHECK_EQUAL(w[1 * 3 + 1], 0);
+    // Unobserved and high variance pairs are sampled more often
+    BOOST_CHECK_GT(w[0 * 3 + 2], w[0 * 3 + 1]);
+    BOOST_CHECK_GT(w[1 * 3 + 0], w[0 * 3 + 1]);
+    BOOST_CHECK_GT(w[0 * 3 + 1], 0);
+}
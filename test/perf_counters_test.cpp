@@ -0,0 +1,83 @@
+#define BOOST_TEST_MODULE PerfCountersTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Link.h"
+#include "PerfCounters.h"
+#include "Simulator.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <sstream>
+#include <string>
+
+// Counters may not be available where the tests run, in which case only the
+// fallback is checked
+BOOST_AUTO_TEST_CASE(perf_counters_section_test) {
+    PerfCounters perf;
+    const bool opened = perf.open();
+
+    for (unsigned i = 0; i < 3; i++) {
+        PerfCounters::Scope scope{&perf, PerfCounters::ROUTING};
+        volatile unsigned long sum = 0;
+        for (unsigned long j = 0; j < 1000000; j++) {
+            sum += j;
+        }
+    }
+    // Null scopes do nothing
+    {
+        PerfCounters::Scope scope{nullptr, PerfCounters::QUEUE};
+    }
+
+    if (!opened) {
+        BOOST_CHECK(!perf.error().empty());
+        BOOST_CHECK_EQUAL(perf.calls(PerfCounters::ROUTING), 0);
+        BOOST_CHECK(!perf.available(PerfCounters::TASK_CLOCK));
+        return;
+    }
+    BOOST_CHECK_EQUAL(perf.calls(PerfCounters::ROUTING), 3);
+    BOOST_CHECK_EQUAL(perf.calls(PerfCounters::QUEUE), 0);
+    if (perf.available(PerfCounters::TASK_CLOCK)) {
+        BOOST_CHECK_GT(perf.get(PerfCounters::ROUTING,
+                                PerfCounters::TASK_CLOCK), 0);
+    }
+    if (perf.available(PerfCounters::INSTRUCTIONS)) {
+        BOOST_CHECK_GT(perf.get(PerfCounters::ROUTING,
+                                PerfCounters::INSTRUCTIONS), 3000000);
+    }
+
+    std::ostringstream oss;
+    perf.write(oss);
+    BOOST_CHECK(oss.str().find("\nrouting ") != std::string::npos);
+    BOOST_CHECK(oss.str().find("\nqueue ") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(perf_counters_simulator_test) {
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(2), g);
+    boost::add_edge(1, 2, Link(2), g);
+
+    // The same simulation with and without counters
+    Advisor a1{g, 3, 1, 42};
+    Simulator s1{a1, 1000, 100};
+    const auto r1 = s1.run();
+
+    PerfCounters perf;
+    const bool opened = perf.open();
+    Advisor a2{g, 3, 1, 42};
+    Simulator s2{a2, 1000, 100};
+    s2.use_perf_counters(perf);
+    const auto r2 = s2.run();
+
+    BOOST_CHECK_EQUAL(r1.connections, r2.connections);
+    BOOST_CHECK_EQUAL(r1.blocked, r2.blocked);
+    BOOST_CHECK_EQUAL(r1.events, r2.events);
+    if (opened) {
+        BOOST_CHECK_EQUAL(perf.calls(PerfCounters::RUN), 1);
+        // Every arrival is routed, and every event popped
+        BOOST_CHECK_GE(perf.calls(PerfCounters::ROUTING),
+                       r2.connections);
+        BOOST_CHECK_GE(perf.calls(PerfCounters::QUEUE), 2 * r2.events);
+        BOOST_CHECK_GT(perf.calls(PerfCounters::LOCKING), 0);
+    }
+}
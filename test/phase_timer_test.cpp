@@ -0,0 +1,67 @@
+#define BOOST_TEST_MODULE PhaseTimerTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Link.h"
+#include "PhaseTimer.h"
+#include "Simulator.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+BOOST_AUTO_TEST_CASE(phase_timer_accumulate_test) {
+    PhaseTimer timer;
+    BOOST_CHECK(timer.phases().empty());
+    BOOST_CHECK(timer.find("a") == nullptr);
+
+    timer.start("a");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    timer.start("b");
+    // Busy phase, so that it uses CPU time
+    volatile unsigned long sum = 0;
+    for (unsigned long i = 0; i < 20000000; i++) {
+        sum += i;
+    }
+    timer.start("a");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    timer.stop();
+    // Stopping twice is harmless
+    timer.stop();
+
+    BOOST_REQUIRE_EQUAL(timer.phases().size(), 2);
+    BOOST_CHECK_EQUAL(timer.phases()[0].name, "a");
+    BOOST_CHECK_EQUAL(timer.phases()[1].name, "b");
+    const PhaseTimer::Phase* a = timer.find("a");
+    BOOST_REQUIRE(a != nullptr);
+    BOOST_CHECK_GE(a->wall, 0.04);
+    // Sleeping uses (almost) no CPU
+    BOOST_CHECK_LT(a->cpu, a->wall / 2);
+    BOOST_CHECK_GT(timer.find("b")->cpu, 0);
+
+    std::ostringstream oss;
+    timer.write(oss);
+    BOOST_CHECK_EQUAL(oss.str().find("phase"), 0);
+    BOOST_CHECK(oss.str().find("\nb ") != std::string::npos);
+
+    BOOST_CHECK_GT(PhaseTimer::peak_rss(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(phase_timer_simulator_test) {
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(2), g);
+    Advisor advisor{g, 3, 1, 42};
+    Simulator simulator{advisor, 1000, 100};
+
+    PhaseTimer timer;
+    simulator.use_phase_timer(timer);
+    const auto result = simulator.run();
+
+    BOOST_REQUIRE_EQUAL(timer.phases().size(), 2);
+    BOOST_CHECK_EQUAL(timer.phases()[0].name, "warm-up");
+    BOOST_CHECK_EQUAL(timer.phases()[1].name, "measurement");
+    // A start per connection, and an end or block for most of them
+    BOOST_CHECK_GT(result.events, 3 * (result.connections + 100) / 2);
+}
@@ -0,0 +1,109 @@
+#define BOOST_TEST_MODULE ReducedLoadTest
+#include <boost/test/unit_test.hpp>
+
+#include "Erlang.h"
+#include "Link.h"
+#include "ReducedLoad.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+using Graph = Advisor::Graph;
+
+/* 0 -- 1 -- 2 -- ... -- n - 1 */
+Graph
+make_bus_graph(const unsigned n, const unsigned num_links) {
+    Graph g;
+    for (unsigned i = 0; i + 1 < n; i++) {
+        boost::add_edge(i, i + 1, Link(num_links), g);
+    }
+    return g;
+}
+
+BOOST_AUTO_TEST_CASE(reduced_load_single_link_test) {
+    Graph g;
+    boost::add_edge(0, 1, Link(5), g);
+
+    // Exactly Erlang B with one link
+    ReducedLoad rl{g, ReducedLoad::CONVERSION, 1};
+    BOOST_CHECK_EQUAL(rl.num_routes(), 2);
+    auto sol = rl.solve(5, 1);
+    BOOST_CHECK(sol.converged);
+    BOOST_CHECK_CLOSE(sol.blocking, erlang_b(5, 5), 1e-6);
+    BOOST_REQUIRE_EQUAL(sol.link_load.size(), 1);
+    BOOST_CHECK_CLOSE(sol.link_load[0], 5, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(reduced_load_bus_test) {
+    auto g = make_bus_graph(10, 4);
+
+    ReducedLoad conversion{g, ReducedLoad::CONVERSION, 1};
+    BOOST_CHECK_EQUAL(conversion.num_routes(), 90);
+    BOOST_CHECK_EQUAL(conversion.edges().size(), 9);
+    auto conv = conversion.solve(5, 1);
+    BOOST_CHECK(conv.converged);
+    BOOST_CHECK_GT(conv.blocking, 0);
+    BOOST_CHECK_LT(conv.blocking, 1);
+
+    // Middle links carry the most routes
+    BOOST_CHECK_GT(conv.link_blocking[4], conv.link_blocking[0]);
+
+    // Wavelength continuity only makes things worse
+    ReducedLoad continuity{g, ReducedLoad::CONTINUITY, 1};
+    auto cont = continuity.solve(5, 1);
+    BOOST_CHECK(cont.converged);
+    BOOST_CHECK_GT(cont.blocking, conv.blocking);
+}
+
+BOOST_AUTO_TEST_CASE(reduced_load_threads_test) {
+    auto g = make_bus_graph(30, 8);
+    boost::add_edge(0, 29, Link(8), g);
+    boost::add_edge(5, 20, Link(8), g);
+
+    ReducedLoad one{g, ReducedLoad::CONVERSION, 1};
+    ReducedLoad many{g, ReducedLoad::CONVERSION, 4};
+    auto a = one.solve(20, 1);
+    auto b = many.solve(20, 1);
+    // Same arithmetic in the same order
+    BOOST_CHECK_EQUAL(a.blocking, b.blocking);
+    BOOST_CHECK_EQUAL(a.iterations, b.iterations);
+
+    // Acceleration does not change the fixed point
+    many.set_anderson(0);
+    auto c = many.solve(20, 1);
+    BOOST_CHECK(c.converged);
+    BOOST_CHECK_CLOSE(a.blocking, c.blocking, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(reduced_load_large_threads_test) {
+    // Enough routes to be split across threads
+    auto g = make_bus_graph(300, 8);
+    for (unsigned i = 0; i + 50 < 300; i += 25) {
+        boost::add_edge(i, i + 50, Link(8), g);
+    }
+
+    for (const auto model : {ReducedLoad::CONVERSION,
+                             ReducedLoad::CONTINUITY}) {
+        ReducedLoad one{g, model, 1};
+        ReducedLoad many{g, model, 4};
+        BOOST_REQUIRE_EQUAL(one.num_routes(), 300 * 299);
+        auto a = one.solve(50, 1);
+        auto b = many.solve(50, 1);
+        BOOST_CHECK(a.converged);
+        BOOST_CHECK_EQUAL(a.blocking, b.blocking);
+        BOOST_CHECK_EQUAL(a.iterations, b.iterations);
+        BOOST_CHECK(a.link_load == b.link_load);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reduced_load_unreachable_test) {
+    // Two separate links
+    Graph g;
+    boost::add_edge(0, 1, Link(3), g);
+    boost::add_edge(2, 3, Link(3), g);
+
+    ReducedLoad rl{g, ReducedLoad::CONVERSION, 1};
+    BOOST_CHECK_EQUAL(rl.num_routes(), 4);
+    auto sol = rl.solve(1, 1);
+    // 8 of the 12 ordered pairs can never connect
+    BOOST_CHECK_GT(sol.blocking, 8.0 / 12);
+}
@@ -0,0 +1,108 @@
+#define BOOST_TEST_MODULE ReplayTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Link.h"
+#include "Replay.h"
+#include "Simulator.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+/**
+ * Poisson arrivals between random pairs of a line of `num_vertices' nodes.
+ */
+std::vector<Replay::Arrival>
+make_arrivals(const unsigned count, const unsigned num_vertices) {
+    std::mt19937 rgen{7};
+    std::exponential_distribution<double> interarrival{4};
+    std::exponential_distribution<double> holding{1};
+    std::uniform_int_distribution<unsigned> node{0, num_vertices - 1};
+
+    std::vector<Replay::Arrival> arrivals;
+    double time = 0;
+    while (arrivals.size() < count) {
+        Replay::Arrival a;
+        time += interarrival(rgen);
+        a.time = time;
+        a.src = node(rgen);
+        a.dst = node(rgen);
+        a.holding = holding(rgen);
+        if (a.src != a.dst) {
+            arrivals.push_back(a);
+        }
+    }
+    return arrivals;
+}
+
+Advisor::Graph
+make_line(const unsigned num_vertices, const unsigned num_links,
+          const bool converter) {
+    Advisor::Graph g;
+    for (unsigned v = 0; v + 1 < num_vertices; v++) {
+        boost::add_edge(v, v + 1, Link(num_links, converter), g);
+    }
+    return g;
+}
+}
+
+BOOST_AUTO_TEST_CASE(replay_load_test) {
+    const std::string filename = "replay_test.arrivals";
+    const auto arrivals = make_arrivals(100, 4);
+    BOOST_REQUIRE(Replay::write(filename, arrivals));
+
+    Replay replay;
+    BOOST_REQUIRE(replay.load(filename));
+    BOOST_REQUIRE_EQUAL(replay.size(), arrivals.size());
+    BOOST_CHECK_EQUAL(replay.begin()[42].time, arrivals[42].time);
+    BOOST_CHECK_EQUAL(replay.begin()[42].dst, arrivals[42].dst);
+    BOOST_CHECK(replay.check(4));
+    BOOST_CHECK(!replay.check(3));
+
+    auto unordered = arrivals;
+    std::swap(unordered[10], unordered[11]);
+    BOOST_REQUIRE(Replay::write(filename, unordered));
+    BOOST_REQUIRE(replay.load(filename));
+    BOOST_CHECK(!replay.check(4));
+
+    std::remove(filename.c_str());
+    BOOST_CHECK(!replay.load(filename));
+}
+
+BOOST_AUTO_TEST_CASE(replay_simulator_test) {
+    const std::string filename = "replay_sim_test.arrivals";
+    const unsigned num_vertices = 5;
+    BOOST_REQUIRE(Replay::write(filename, make_arrivals(1500, num_vertices)));
+    Replay replay;
+    BOOST_REQUIRE(replay.load(filename));
+
+    // The same workload gives the same result regardless of the seed
+    auto run = [&replay](const bool converter, const unsigned seed) {
+        Advisor advisor{make_line(num_vertices, 2, converter), 4, 1, seed};
+        Simulator simulator{advisor, 1000, 200};
+        simulator.use_replay(replay);
+        return simulator.run();
+    };
+    const auto a = run(false, 1);
+    const auto b = run(false, 2);
+    BOOST_CHECK_EQUAL(a.connections, b.connections);
+    BOOST_CHECK_EQUAL(a.blocked, b.blocked);
+    BOOST_CHECK_GT(a.blocked, 0);
+
+    // Other settings see exactly the same connections
+    const auto c = run(true, 1);
+    BOOST_CHECK_EQUAL(c.connections, a.connections);
+
+    // Running out of arrivals ends the simulation
+    Advisor advisor{make_line(num_vertices, 2, false), 4, 1, 1};
+    Simulator simulator{advisor, 100000, 200};
+    simulator.use_replay(replay);
+    BOOST_CHECK_LE(simulator.run().connections, 1500 - 200);
+
+    std::remove(filename.c_str());
+}
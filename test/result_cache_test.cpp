@@ -0,0 +1,173 @@
+#define BOOST_TEST_MODULE ResultCacheTest
+#include <boost/test/unit_test.hpp>
+
+#include "ResultCache.h"
+#include "Shard.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+const std::string directory = "result_cache_test.cache";
+const char* COLUMNS[] = {
+    "key.u64", "scenario_end.u64", "scenarios.txt", "replications.u64",
+    "connections.u64", "blocked.u64", "sum_blocking.f64",
+    "sum_blocking_sq.f64", "lock"};
+
+void
+remove_cache() {
+    for (const char* column : COLUMNS) {
+        std::remove((directory + "/" + column).c_str());
+    }
+    std::remove(directory.c_str());
+}
+
+Shard::Partial
+make_partial(const unsigned long blocked) {
+    Shard::Partial partial;
+    partial.replications = 2;
+    partial.connections = 1000;
+    partial.blocked = blocked;
+    partial.sum_blocking = blocked / 500.0;
+    partial.sum_blocking_sq = 0.125;
+    return partial;
+}
+}
+
+BOOST_AUTO_TEST_CASE(result_cache_test) {
+    remove_cache();
+
+    ResultCache cache;
+    BOOST_REQUIRE(cache.open(directory));
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+    Shard::Partial partial;
+    BOOST_CHECK(!cache.find("a 1 2", partial));
+
+    BOOST_REQUIRE(cache.insert("a 1 2", make_partial(10)));
+    BOOST_REQUIRE(cache.insert("a 1 3", make_partial(20)));
+    BOOST_REQUIRE(cache.find("a 1 2", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 10);
+
+    // Another process sees the same results
+    ResultCache other;
+    BOOST_REQUIRE(other.open(directory));
+    BOOST_CHECK_EQUAL(other.size(), 2);
+    BOOST_REQUIRE(other.find("a 1 3", partial));
+    BOOST_CHECK_EQUAL(partial.replications, 2);
+    BOOST_CHECK_EQUAL(partial.connections, 1000);
+    BOOST_CHECK_EQUAL(partial.blocked, 20);
+    BOOST_CHECK_EQUAL(partial.sum_blocking, 20 / 500.0);
+    BOOST_CHECK_EQUAL(partial.sum_blocking_sq, 0.125);
+    BOOST_CHECK(!other.find("a 1 4", partial));
+
+    // ... and picks up results appended by others before appending
+    BOOST_REQUIRE(cache.insert("b", make_partial(30)));
+    BOOST_REQUIRE(other.insert("c", make_partial(40)));
+    ResultCache third;
+    BOOST_REQUIRE(third.open(directory));
+    BOOST_CHECK_EQUAL(third.size(), 4);
+    BOOST_REQUIRE(third.find("b", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 30);
+    BOOST_REQUIRE(third.find("c", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 40);
+
+    remove_cache();
+}
+
+BOOST_AUTO_TEST_CASE(result_cache_version_test) {
+    remove_cache();
+
+    ResultCache cache;
+    BOOST_REQUIRE(cache.open(directory));
+    const std::string scenario = "a 1 2";
+    BOOST_REQUIRE(cache.insert(ResultCache::key(scenario), make_partial(10)));
+    Shard::Partial partial;
+    BOOST_REQUIRE(cache.find(ResultCache::key(scenario), partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 10);
+    BOOST_CHECK(cache.find(ResultCache::key(scenario, ResultCache::VERSION),
+                           partial));
+
+    // Results of another version of the simulator are not found
+    BOOST_CHECK(!cache.find(ResultCache::key(scenario,
+                                             ResultCache::VERSION + 1),
+                            partial));
+    BOOST_CHECK(!cache.find(ResultCache::key(scenario,
+                                             ResultCache::VERSION - 1),
+                            partial));
+    BOOST_CHECK(!cache.find(scenario, partial));
+
+    remove_cache();
+}
+
+BOOST_AUTO_TEST_CASE(result_cache_interrupted_test) {
+    remove_cache();
+
+    ResultCache cache;
+    BOOST_REQUIRE(cache.open(directory));
+    BOOST_REQUIRE(cache.insert("first", make_partial(1)));
+
+    // An append that stopped half way
+    {
+        std::ofstream ofs{directory + "/scenarios.txt",
+                          std::ios::out | std::ios::app};
+        ofs << "second";
+    }
+    {
+        std::ofstream ofs{directory + "/replications.u64",
+                          std::ios::out | std::ios::binary | std::ios::app};
+        ofs.write("\1\0\0\0\0\0\0\0", 8);
+    }
+
+    ResultCache reopened;
+    BOOST_REQUIRE(reopened.open(directory));
+    BOOST_CHECK_EQUAL(reopened.size(), 1);
+    BOOST_REQUIRE(reopened.insert("third", make_partial(3)));
+
+    Shard::Partial partial;
+    ResultCache last;
+    BOOST_REQUIRE(last.open(directory));
+    BOOST_CHECK_EQUAL(last.size(), 2);
+    BOOST_REQUIRE(last.find("third", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 3);
+    BOOST_CHECK_EQUAL(partial.replications, 2);
+    BOOST_CHECK(!last.find("second", partial));
+
+    remove_cache();
+}
+
+BOOST_AUTO_TEST_CASE(result_cache_incremental_test) {
+    remove_cache();
+
+    ResultCache cache;
+    BOOST_REQUIRE(cache.open(directory));
+    BOOST_REQUIRE(cache.insert("a", make_partial(1)));
+    ResultCache other;
+    BOOST_REQUIRE(other.open(directory));
+
+    // Rows already read are not read again: a change to the first row on
+    // disk goes unnoticed by both
+    {
+        std::fstream fs{directory + "/blocked.u64",
+                        std::ios::in | std::ios::out | std::ios::binary};
+        fs.write("\7\0\0\0\0\0\0\0", 8);
+    }
+    BOOST_REQUIRE(cache.insert("b", make_partial(2)));
+    BOOST_REQUIRE(other.insert("c", make_partial(3)));
+
+    Shard::Partial partial;
+    BOOST_CHECK_EQUAL(other.size(), 3);
+    BOOST_REQUIRE(other.find("a", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 1);
+    // ... but the row appended by the other process is
+    BOOST_REQUIRE(other.find("b", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 2);
+    BOOST_REQUIRE(cache.insert("d", make_partial(4)));
+    BOOST_CHECK_EQUAL(cache.size(), 4);
+    BOOST_REQUIRE(cache.find("c", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 3);
+    BOOST_REQUIRE(cache.find("a", partial));
+    BOOST_CHECK_EQUAL(partial.blocked, 1);
+
+    remove_cache();
+}
@@ -0,0 +1,95 @@
+#define BOOST_TEST_MODULE ShardTest
+#include <boost/test/unit_test.hpp>
+
+#include "Shard.h"
+#include "Simulator.h"
+
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_CASE(shard_parse_test) {
+    Shard shard;
+    BOOST_CHECK_EQUAL(shard.count(), 1);
+    BOOST_CHECK(shard.owns(7));
+
+    BOOST_REQUIRE(Shard::parse("2/4", shard));
+    BOOST_CHECK_EQUAL(shard.index(), 2);
+    BOOST_CHECK_EQUAL(shard.count(), 4);
+
+    BOOST_CHECK(!Shard::parse("4/4", shard));
+    BOOST_CHECK(!Shard::parse("1/0", shard));
+    BOOST_CHECK(!Shard::parse("-1/3", shard));
+    BOOST_CHECK(!Shard::parse("1/", shard));
+    BOOST_CHECK(!Shard::parse("/3", shard));
+    BOOST_CHECK(!Shard::parse("13", shard));
+    // Unchanged on failure
+    BOOST_CHECK_EQUAL(shard.index(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(shard_owns_test) {
+    // Every replication is owned by exactly one shard
+    const unsigned count = 3;
+    for (unsigned r = 0; r < 20; r++) {
+        unsigned owners = 0;
+        for (unsigned i = 0; i < count; i++) {
+            owners += Shard(i, count).owns(r) ? 1 : 0;
+        }
+        BOOST_CHECK_EQUAL(owners, 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(shard_partial_merge_test) {
+    Simulator::Result r1, r2, r3;
+    r1.connections = 100;
+    r1.blocked = 10;
+    r2.connections = 300;
+    r2.blocked = 6;
+    r3.connections = 100;
+    r3.blocked = 4;
+
+    Shard::Partial all;
+    all.add(r1);
+    all.add(r2);
+    all.add(r3);
+
+    Shard::Partial a, b;
+    a.add(r1);
+    b.add(r2);
+    b.add(r3);
+    a.merge(b);
+
+    BOOST_CHECK_EQUAL(a.replications, 3);
+    BOOST_CHECK_EQUAL(a.connections, all.connections);
+    BOOST_CHECK_EQUAL(a.blocked, all.blocked);
+    BOOST_CHECK_CLOSE(a.blocking(), 20.0 / 500, 1e-9);
+    BOOST_CHECK_CLOSE(a.std_error(), all.std_error(), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(shard_partial_read_write_test) {
+    Simulator::Result r;
+    r.connections = 12345;
+    r.blocked = 678;
+
+    Shard::Partial p;
+    p.add(r);
+    p.add(r);
+
+    std::stringstream ss;
+    p.write(ss, "1a2b 8 0 5 1 seed 7", Shard(2, 3));
+
+    Shard::Partial q;
+    std::string scenario;
+    Shard shard;
+    BOOST_REQUIRE(Shard::Partial::read(ss, q, scenario, shard));
+    BOOST_CHECK_EQUAL(scenario, "1a2b 8 0 5 1 seed 7");
+    BOOST_CHECK_EQUAL(shard.index(), 2);
+    BOOST_CHECK_EQUAL(shard.count(), 3);
+    BOOST_CHECK_EQUAL(q.replications, p.replications);
+    BOOST_CHECK_EQUAL(q.connections, p.connections);
+    BOOST_CHECK_EQUAL(q.blocked, p.blocked);
+    BOOST_CHECK_EQUAL(q.sum_blocking, p.sum_blocking);
+    BOOST_CHECK_EQUAL(q.sum_blocking_sq, p.sum_blocking_sq);
+
+    std::stringstream bad{"something else"};
+    BOOST_CHECK(!Shard::Partial::read(bad, q, scenario, shard));
+}
@@ -0,0 +1,120 @@
+#define BOOST_TEST_MODULE StatsPageTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Link.h"
+#include "Simulator.h"
+#include "StatsPage.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+BOOST_AUTO_TEST_CASE(stats_page_publish_test) {
+    const std::string filename = "stats_page_test.stats";
+
+    StatsPage writer;
+    BOOST_REQUIRE(writer.create(filename, 3));
+    StatsPage reader;
+    BOOST_REQUIRE(reader.open(filename));
+    const std::uint64_t initial = reader.updates();
+
+    StatsPage::Snapshot s;
+    s.replication = 1;
+    s.events = 1234;
+    s.connections = 100;
+    s.blocked = 7;
+    s.blocking = 0.07;
+    writer.publish(s);
+
+    StatsPage::Snapshot r;
+    BOOST_REQUIRE(reader.read(r));
+    BOOST_CHECK_EQUAL(reader.updates(), initial + 1);
+    BOOST_CHECK_EQUAL(r.pid, static_cast<std::uint32_t>(::getpid()));
+    BOOST_CHECK_EQUAL(r.replication, 1);
+    BOOST_CHECK_EQUAL(r.replications, 3);
+    BOOST_CHECK_EQUAL(r.events, 1234);
+    BOOST_CHECK_EQUAL(r.blocked, 7);
+    BOOST_CHECK_EQUAL(r.finished, 0);
+
+    writer.finish();
+    BOOST_REQUIRE(reader.read(r));
+    BOOST_CHECK_EQUAL(r.finished, 1);
+    BOOST_CHECK_EQUAL(r.events, 1234);
+
+    // Readers never see a snapshot that is half written
+    s.events = s.connections = s.blocked = 0;
+    writer.publish(s);
+    std::atomic<bool> stop{false};
+    std::thread t{[&]() {
+        StatsPage::Snapshot w;
+        for (std::uint64_t i = 0; !stop; i++) {
+            w.events = i;
+            w.connections = i;
+            w.blocked = i;
+            writer.publish(w);
+        }
+    }};
+    unsigned failed = 0, torn = 0;
+    for (unsigned i = 0; i < 100000; i++) {
+        if (!reader.read(r)) {
+            failed++;
+        }
+        else if (r.events != r.connections || r.events != r.blocked) {
+            torn++;
+        }
+    }
+    stop = true;
+    t.join();
+    BOOST_CHECK_EQUAL(failed, 0);
+    BOOST_CHECK_EQUAL(torn, 0);
+
+    reader.close();
+    writer.close();
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(stats_page_invalid_test) {
+    const std::string filename = "stats_page_invalid_test.stats";
+    {
+        std::ofstream ofs{filename};
+        ofs << std::string(4096, 'x');
+    }
+    StatsPage page;
+    BOOST_CHECK(!page.open(filename));
+    BOOST_CHECK(!page.open("stats_page_test.missing"));
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(stats_page_simulator_test) {
+    const std::string filename = "stats_page_sim_test.stats";
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(2), g);
+    Advisor advisor{g, 3, 1, 42};
+    Simulator simulator{advisor, 1000, 100};
+
+    StatsPage page;
+    BOOST_REQUIRE(page.create(filename));
+    simulator.use_stats_page(page, 100, 2);
+    const auto result = simulator.run();
+
+    // The last snapshot matches the result
+    StatsPage::Snapshot s;
+    BOOST_REQUIRE(page.read(s));
+    BOOST_CHECK_GT(page.updates(), result.events / 100);
+    BOOST_CHECK_EQUAL(s.replication, 2);
+    BOOST_CHECK_EQUAL(s.warming_up, 0);
+    BOOST_CHECK_EQUAL(s.events, result.events);
+    BOOST_CHECK_EQUAL(s.connections, result.connections);
+    BOOST_CHECK_EQUAL(s.blocked, result.blocked);
+    BOOST_CHECK_CLOSE(s.blocking, result.blocking(), 1e-3);
+    BOOST_CHECK_GT(s.ci_half_width, 0);
+    BOOST_CHECK_LE(s.active, 2);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,131 @@
+#define BOOST_TEST_MODULE TimelineTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Link.h"
+#include "PhaseTimer.h"
+#include "Simulator.h"
+#include "Timeline.h"
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace {
+using boost::property_tree::ptree;
+
+/**
+ * \return the spans of a timeline (without the metadata events), read back
+ *         with a JSON parser.
+ */
+std::vector<ptree>
+read_spans(const std::string& filename) {
+    ptree root;
+    boost::property_tree::read_json(filename, root);
+    BOOST_CHECK_EQUAL(root.get<std::string>("displayTimeUnit"), "ns");
+    std::vector<ptree> spans;
+    for (const auto& child : root.get_child("traceEvents")) {
+        if (child.second.get<std::string>("ph") == "X") {
+            spans.push_back(child.second);
+        }
+    }
+    return spans;
+}
+}
+
+BOOST_AUTO_TEST_CASE(timeline_sample_test) {
+    const std::string filename = "timeline_test.json";
+
+    Timeline timeline;
+    // Small pages so that both pages are written several times
+    BOOST_REQUIRE(timeline.open(filename, 1000, 10, 4));
+    const std::uint64_t start = Timeline::now();
+    unsigned recorded = 0;
+    for (unsigned i = 0; i < 100; i++) {
+        // Every 7th event is slow
+        const std::uint64_t duration = i % 7 == 0 ? 5000 : 100;
+        recorded += timeline.event("START", start + i * 10000,
+                                   start + i * 10000 + duration,
+                                   i % 3, 3, i % 4, i % 2, 1, i * 0.5);
+    }
+    timeline.phase("measurement", start, start + 100 * 10000);
+    // 15 slow events and 10 sampled ones, of which event 49 is both
+    BOOST_CHECK_EQUAL(recorded, 24);
+    BOOST_CHECK_EQUAL(timeline.slow_events(), 15);
+    BOOST_CHECK_EQUAL(timeline.spans(), 25);
+    BOOST_REQUIRE(timeline.close());
+
+    const std::vector<ptree> spans = read_spans(filename);
+    BOOST_REQUIRE_EQUAL(spans.size(), 25);
+    unsigned slow = 0;
+    for (const ptree& span : spans) {
+        if (span.get<std::string>("cat") == "phase") {
+            BOOST_CHECK_EQUAL(span.get<std::string>("name"), "measurement");
+            BOOST_CHECK_CLOSE(span.get<double>("dur"), 1000, 1e-6);
+            continue;
+        }
+        BOOST_CHECK_EQUAL(span.get<std::string>("name"), "START");
+        BOOST_CHECK_EQUAL(span.get<unsigned>("args.dst"), 3);
+        BOOST_CHECK_EQUAL(span.get<unsigned>("args.replication"), 1);
+        const bool is_slow = span.get<bool>("args.slow");
+        slow += is_slow;
+        // Microseconds
+        BOOST_CHECK_CLOSE(span.get<double>("dur"), is_slow ? 5 : 0.1, 1e-6);
+    }
+    BOOST_CHECK_EQUAL(slow, 15);
+
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(timeline_simulator_test) {
+    const std::string filename = "timeline_simulator_test.json";
+
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(2), g);
+    boost::add_edge(1, 2, Link(2), g);
+    Advisor advisor{g, 3, 1, 42};
+    Simulator simulator{advisor, 1000, 100};
+
+    Timeline timeline;
+    // Every event
+    BOOST_REQUIRE(timeline.open(filename, 1000000000, 1));
+    PhaseTimer timer;
+    timer.use_timeline(timeline);
+    simulator.use_phase_timer(timer);
+    simulator.use_timeline(timeline, 2);
+    const auto result = simulator.run();
+    BOOST_CHECK_EQUAL(timeline.spans(), result.events + 2);
+    BOOST_CHECK_EQUAL(timeline.slow_events(), 0);
+    BOOST_REQUIRE(timeline.close());
+
+    std::map<std::string, unsigned long> names;
+    for (const ptree& span : read_spans(filename)) {
+        const std::string name = span.get<std::string>("name");
+        names[name]++;
+        if (name == "START") {
+            BOOST_CHECK_NE(span.get<unsigned>("args.wavelength"), Link::NONE);
+            BOOST_CHECK_GE(span.get<unsigned>("args.wavelengths_tried"), 1);
+        }
+        if (name == "START (blocked)") {
+            BOOST_CHECK_EQUAL(span.get<unsigned>("args.wavelength"),
+                              Link::NONE);
+        }
+        if (span.get<std::string>("cat") == "event") {
+            BOOST_CHECK_EQUAL(span.get<unsigned>("args.replication"), 2);
+        }
+    }
+    BOOST_CHECK_EQUAL(names["warm-up"], 1);
+    BOOST_CHECK_EQUAL(names["measurement"], 1);
+    // The last arrival is scheduled but not processed
+    BOOST_CHECK_EQUAL(names["START"] + names["START (blocked)"],
+                      result.connections + 100 - 1);
+    BOOST_CHECK_EQUAL(names["START (blocked)"], names["BLOCK"]);
+    BOOST_CHECK_GT(names["START (blocked)"], 0);
+    BOOST_CHECK_GT(names["END"], 0);
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,130 @@
+#define BOOST_TEST_MODULE TopologyGeneratorTest
+#include <boost/test/unit_test.hpp>
+
+#include "Topology.h"
+#include "TopologyGenerator.h"
+
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace {
+std::vector<std::uint32_t>
+generate(TopologyGenerator& generator) {
+    std::vector<std::uint32_t> endpoints;
+    BOOST_REQUIRE(generator.generate(endpoints));
+    return endpoints;
+}
+
+/**
+ * Checks that there are no loops or repeated edges, and that every node is
+ * below `num_vertices'.
+ */
+void
+check_simple(const std::vector<std::uint32_t>& endpoints,
+             const unsigned num_vertices) {
+    std::set<std::pair<std::uint32_t, std::uint32_t>> seen;
+    for (std::size_t i = 0; i < endpoints.size(); i += 2) {
+        BOOST_CHECK_LT(endpoints[i], endpoints[i + 1]);
+        BOOST_CHECK_LT(endpoints[i + 1], num_vertices);
+        seen.emplace(endpoints[i], endpoints[i + 1]);
+    }
+    BOOST_CHECK_EQUAL(seen.size(), endpoints.size() / 2);
+}
+}
+
+BOOST_AUTO_TEST_CASE(topology_generator_erdos_renyi_test) {
+    TopologyGenerator one{TopologyGenerator::ERDOS_RENYI, 1000, 5, 1};
+    one.set_edges(100000);
+    const auto edges = generate(one);
+    BOOST_CHECK_EQUAL(edges.size(), 2 * 100000);
+    check_simple(edges, 1000);
+
+    // Same edges with any number of threads
+    TopologyGenerator many{TopologyGenerator::ERDOS_RENYI, 1000, 5, 4};
+    many.set_edges(100000);
+    BOOST_CHECK(generate(many) == edges);
+
+    TopologyGenerator other{TopologyGenerator::ERDOS_RENYI, 1000, 6, 4};
+    other.set_edges(100000);
+    BOOST_CHECK(generate(other) != edges);
+
+    // Every pair
+    TopologyGenerator complete{TopologyGenerator::ERDOS_RENYI, 10, 1};
+    complete.set_edges(45);
+    check_simple(generate(complete), 10);
+
+    std::vector<std::uint32_t> endpoints;
+    complete.set_edges(46);
+    BOOST_CHECK(!complete.generate(endpoints));
+}
+
+BOOST_AUTO_TEST_CASE(topology_generator_waxman_test) {
+    TopologyGenerator one{TopologyGenerator::WAXMAN, 500, 3, 1};
+    const auto edges = generate(one);
+    BOOST_CHECK_GT(edges.size(), 0);
+    check_simple(edges, 500);
+
+    TopologyGenerator many{TopologyGenerator::WAXMAN, 500, 3, 3};
+    BOOST_CHECK(generate(many) == edges);
+}
+
+BOOST_AUTO_TEST_CASE(topology_generator_regular_test) {
+    TopologyGenerator bus{TopologyGenerator::BUS, 10, 1};
+    std::vector<std::uint32_t> correct;
+    for (std::uint32_t v = 0; v < 9; v++) {
+        correct.push_back(v);
+        correct.push_back(v + 1);
+    }
+    BOOST_CHECK(generate(bus) == correct);
+
+    TopologyGenerator ring{TopologyGenerator::RING, 10, 1};
+    BOOST_CHECK_EQUAL(generate(ring).size(), 2 * 10);
+
+    TopologyGenerator grid{TopologyGenerator::GRID, 12, 1};
+    grid.set_rows(3);
+    const auto g = generate(grid);
+    BOOST_CHECK_EQUAL(g.size(), 2 * (3 * 3 + 2 * 4));
+    check_simple(g, 12);
+
+    TopologyGenerator torus{TopologyGenerator::TORUS, 16, 1};
+    const auto t = generate(torus);
+    BOOST_CHECK_EQUAL(t.size(), 2 * 2 * 16);
+    check_simple(t, 16);
+
+    std::vector<std::uint32_t> endpoints;
+    grid.set_rows(5);
+    BOOST_CHECK(!grid.generate(endpoints));
+}
+
+BOOST_AUTO_TEST_CASE(topology_generator_preferential_test) {
+    TopologyGenerator ba{TopologyGenerator::PREFERENTIAL, 1000, 9, 1};
+    ba.set_attachments(3);
+    const auto edges = generate(ba);
+    // A clique of 4 nodes, then 3 edges with each other node
+    BOOST_CHECK_EQUAL(edges.size(), 2 * (6 + 3 * 996));
+    check_simple(edges, 1000);
+
+    // The first nodes attract most of the links
+    std::vector<unsigned> degree(1000);
+    for (const auto v : edges) {
+        degree[v]++;
+    }
+    BOOST_CHECK_GT(degree[0], 3 * degree[999]);
+}
+
+BOOST_AUTO_TEST_CASE(topology_generator_text_test) {
+    TopologyGenerator bus{TopologyGenerator::BUS, 3, 1};
+    Topology topology;
+    topology.assign(generate(bus));
+    std::ostringstream oss;
+    BOOST_REQUIRE(topology.write_text(oss));
+    BOOST_CHECK_EQUAL(oss.str(), "2\n0 1\n1 2\n");
+
+    Topology parsed;
+    const std::string text = oss.str();
+    BOOST_REQUIRE(parsed.parse(text.data(), text.data() + text.size()));
+    BOOST_CHECK_EQUAL(parsed.hash(), topology.hash());
+}
@@ -0,0 +1,189 @@
+#define BOOST_TEST_MODULE TopologyTest
+#include <boost/test/unit_test.hpp>
+
+#include "Topology.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+bool
+parse(Topology& topology, const std::string& text, unsigned threads = 1) {
+    return topology.parse(text.data(), text.data() + text.size(), threads);
+}
+
+std::vector<unsigned>
+endpoints(const Topology& topology) {
+    return std::vector<unsigned>(
+            topology.endpoints(),
+            topology.endpoints() + 2 * topology.num_edges());
+}
+
+BOOST_AUTO_TEST_CASE(topology_parse_test) {
+    Topology topology;
+    BOOST_REQUIRE(parse(topology, "3\n0 1\n1 2\n 4\t2\r\n"));
+    BOOST_CHECK_EQUAL(topology.num_edges(), 3);
+    BOOST_CHECK_EQUAL(topology.num_vertices(), 5);
+    std::vector<unsigned> correct = {0, 1, 1, 2, 4, 2};
+    BOOST_CHECK(endpoints(topology) == correct);
+
+    // Not necessarily one edge per line
+    BOOST_REQUIRE(parse(topology, "2 0 1\n1\n2"));
+    BOOST_CHECK_EQUAL(topology.num_edges(), 2);
+
+    auto g = topology.make_graph(4, true);
+    BOOST_CHECK_EQUAL(boost::num_vertices(g), 3);
+    BOOST_CHECK_EQUAL(boost::num_edges(g), 2);
+    auto e = *boost::edges(g).first;
+    BOOST_CHECK_EQUAL(g[e].num_wavelengths(), 4);
+    BOOST_CHECK(g[e].has_converter());
+}
+
+BOOST_AUTO_TEST_CASE(topology_error_test) {
+    Topology topology;
+
+    BOOST_CHECK(!parse(topology, ""));
+    BOOST_CHECK(!parse(topology, "2\n0 1\n1 x\n"));
+    BOOST_CHECK_EQUAL(topology.error().substr(0, 2), "3:");
+
+    BOOST_CHECK(!parse(topology, "2\n0 1\n1 -2\n"));
+    BOOST_CHECK_EQUAL(topology.error().substr(0, 2), "3:");
+
+    BOOST_CHECK(!parse(topology, "3\n0 1\n1 2\n"));
+    BOOST_CHECK(!parse(topology, "1\n0 1\n1\n"));
+    BOOST_CHECK(!parse(topology, "1\n0 99999999999\n"));
+    BOOST_CHECK(!parse(topology, "1\n0 1a\n"));
+
+    BOOST_CHECK(!topology.load("/nonexistent/topology.txt"));
+
+    // Vertices that would wrap around or not fit in memory
+    BOOST_CHECK(!parse(topology, "1\n0 4294967295\n"));
+    BOOST_CHECK_EQUAL(topology.error().substr(0, 2), "2:");
+    BOOST_CHECK(!parse(topology, "2\n0 1\n4294967294 1\n"));
+    BOOST_CHECK_EQUAL(topology.error().substr(0, 2), "3:");
+    const unsigned largest = Topology::MAX_VERTICES - 1;
+    BOOST_CHECK(!parse(topology, "1\n0 " + std::to_string(largest + 1)));
+    // The number of edges is not a vertex
+    BOOST_CHECK(!parse(topology, "268435456\n0 1\n"));
+    BOOST_CHECK(topology.error().find("too large") == std::string::npos);
+
+    // A directory opens but cannot be mapped
+    BOOST_CHECK(!topology.load("."));
+    BOOST_CHECK(topology.error().find("cannot open") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(topology_parallel_test) {
+    // Large enough to be split between threads
+    const unsigned num_edges = 200000;
+    std::ostringstream oss;
+    oss << num_edges << "\n";
+    for (unsigned i = 0; i < num_edges; i++) {
+        oss << i << " " << (i * 7 + 3) % 1000 << "\n";
+    }
+    const std::string text = oss.str();
+
+    Topology one, many;
+    BOOST_REQUIRE(parse(one, text, 1));
+    BOOST_REQUIRE(parse(many, text, 4));
+    BOOST_CHECK_EQUAL(many.num_edges(), num_edges);
+    BOOST_CHECK(endpoints(one) == endpoints(many));
+    BOOST_CHECK_EQUAL(one.hash(), many.hash());
+    BOOST_CHECK_EQUAL(one.num_vertices(), many.num_vertices());
+
+    // Line numbers are counted across the parts
+    std::string broken = text;
+    const auto pos = broken.find("\n150000 ");
+    broken[pos + 1] = '?';
+    BOOST_CHECK(!parse(many, broken, 4));
+    BOOST_CHECK_EQUAL(many.error().substr(0, 7), "150002:");
+}
+
+BOOST_AUTO_TEST_CASE(topology_binary_test) {
+    const std::string text_file = "topology_test_edges.txt";
+    const std::string binary_file = "topology_test_edges.bin";
+    {
+        std::ofstream ofs{text_file};
+        ofs << "4\n0 1\n1 2\n2 3\n3 0\n";
+    }
+
+    Topology text;
+    BOOST_REQUIRE(text.load(text_file));
+    BOOST_REQUIRE(text.write_binary(binary_file));
+
+    Topology binary;
+    BOOST_REQUIRE(binary.load(binary_file));
+    BOOST_CHECK(endpoints(binary) == endpoints(text));
+    BOOST_CHECK_EQUAL(binary.num_vertices(), 4);
+    BOOST_CHECK_EQUAL(binary.hash(), text.hash());
+    BOOST_CHECK(binary.capacities() == nullptr);
+
+    // Copies share the mapping and outlive the original
+    Topology copy;
+    {
+        Topology other{binary};
+        copy = other;
+    }
+    BOOST_CHECK(endpoints(copy) == endpoints(text));
+
+    // Stored capacities take precedence over the command line
+    BOOST_REQUIRE(text.write_binary(binary_file, 3));
+    BOOST_REQUIRE(binary.load(binary_file));
+    BOOST_REQUIRE(binary.capacities() != nullptr);
+    BOOST_CHECK(binary.hash() != text.hash());
+    auto g = binary.make_graph(8, false);
+    for (auto e : boost::make_iterator_range(boost::edges(g))) {
+        BOOST_CHECK_EQUAL(g[e].num_wavelengths(), 3);
+    }
+
+    // Corruption is caught by the hash
+    {
+        std::fstream fs{binary_file,
+                        std::ios::in | std::ios::out | std::ios::binary};
+        fs.seekp(48);
+        fs.put(7);
+    }
+    BOOST_CHECK(!binary.load(binary_file));
+
+    std::remove(text_file.c_str());
+    std::remove(binary_file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(topology_binary_validation_test) {
+    const std::string binary_file = "topology_test_validation.bin";
+    Topology topology;
+    topology.assign({0, 1, 1, 2, 2, 3, 3, 0});
+
+    // Offset of the number of vertices in the header
+    const std::streamoff num_vertices_at = 24;
+    auto corrupt = [&](const std::streamoff at, const std::uint64_t value) {
+        BOOST_REQUIRE(topology.write_binary(binary_file));
+        std::fstream fs{binary_file,
+                        std::ios::in | std::ios::out | std::ios::binary};
+        fs.seekp(at);
+        fs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    Topology binary;
+    BOOST_REQUIRE(topology.write_binary(binary_file));
+    BOOST_REQUIRE(binary.load(binary_file));
+    BOOST_CHECK_EQUAL(binary.hash(), topology.hash());
+
+    // The number of vertices is not covered by the hash
+    corrupt(num_vertices_at, 3);
+    BOOST_CHECK(!binary.load(binary_file));
+    BOOST_CHECK(binary.error().find("endpoint 3") != std::string::npos);
+    BOOST_CHECK_EQUAL(binary.num_edges(), 0);
+
+    corrupt(num_vertices_at, Topology::MAX_VERTICES + 1ul);
+    BOOST_CHECK(!binary.load(binary_file));
+
+    // Nor is the number of edges, but the file must then be longer
+    corrupt(num_vertices_at + 8, 5);
+    BOOST_CHECK(!binary.load(binary_file));
+    BOOST_CHECK(binary.error().find("truncated") != std::string::npos);
+
+    std::remove(binary_file.c_str());
+}
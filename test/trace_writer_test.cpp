@@ -0,0 +1,84 @@
+#define BOOST_TEST_MODULE TraceWriterTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Link.h"
+#include "Simulator.h"
+#include "TraceWriter.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_CASE(trace_writer_csv_test) {
+    const std::string filename = "trace_writer_test.trace";
+
+    TraceWriter trace;
+    // Small pages so that both pages are written several times
+    BOOST_REQUIRE(trace.open(filename, 7));
+    const unsigned count = 100;
+    for (unsigned i = 0; i < count; i++) {
+        TraceWriter::Record r;
+        r.arrival = i;
+        r.departure = i + 0.5;
+        r.src = i % 3;
+        r.dst = 3;
+        r.path_length = i % 2 == 0 ? 2 : 0;
+        r.wavelength = i % 2 == 0 ? 5 : Link::NONE;
+        r.flags = i % 2 == 0 ? 0 : TraceWriter::BLOCKED;
+        r.replication = 1;
+        trace.record(r);
+    }
+    BOOST_CHECK_EQUAL(trace.records(), count);
+    BOOST_REQUIRE(trace.close());
+
+    std::ostringstream oss;
+    BOOST_REQUIRE(TraceWriter::write_csv(filename, oss));
+    const std::string csv = oss.str();
+    BOOST_CHECK_EQUAL(std::count(csv.begin(), csv.end(), '\n'), count + 1);
+    BOOST_CHECK(csv.find("\n1,0,0.5,0,3,2,5,0,0\n") != std::string::npos);
+    BOOST_CHECK(csv.find("\n1,99,99.5,0,3,0,,1,0\n") != std::string::npos);
+
+    std::remove(filename.c_str());
+    BOOST_CHECK(!TraceWriter::write_csv(filename, oss));
+}
+
+BOOST_AUTO_TEST_CASE(trace_writer_simulator_test) {
+    const std::string filename = "trace_writer_sim_test.trace";
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(2), g);
+
+    TraceWriter trace;
+    BOOST_REQUIRE(trace.open(filename, 64));
+    Advisor advisor{g, 3, 1, 42};
+    Simulator simulator{advisor, 1000, 100};
+    simulator.use_trace(trace);
+    const auto result = simulator.run();
+    BOOST_REQUIRE(trace.close());
+
+    std::ostringstream oss;
+    BOOST_REQUIRE(TraceWriter::write_csv(filename, oss));
+    std::istringstream iss{oss.str()};
+    std::string line;
+    std::getline(iss, line);
+    unsigned long measured = 0, warm_up = 0, blocked = 0;
+    while (std::getline(iss, line)) {
+        if (line.back() == '1') {
+            warm_up++;
+            continue;
+        }
+        measured++;
+        if (line.substr(line.size() - 4) == ",1,0") {
+            blocked++;
+        }
+    }
+    BOOST_CHECK_EQUAL(measured + warm_up, trace.records());
+    BOOST_CHECK_GT(warm_up, 0);
+    // The measured part of the trace agrees with the counters
+    BOOST_CHECK_EQUAL(measured, result.connections);
+    BOOST_CHECK_EQUAL(blocked, result.blocked);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,108 @@
+#define BOOST_TEST_MODULE UtilizationTest
+#include <boost/test/unit_test.hpp>
+
+#include "Advisor.h"
+#include "Link.h"
+#include "Simulator.h"
+#include "Utilization.h"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_CASE(utilization_sample_test) {
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(3), g);
+    boost::add_edge(1, 2, Link(2), g);
+
+    Utilization u{g, 0.5, 3};
+    BOOST_CHECK_EQUAL(u.num_edges(), 2);
+    BOOST_CHECK_EQUAL(u.num_wavelengths(), 3);
+    BOOST_CHECK_EQUAL(u.size(), 0);
+
+    u.sample(g, 0, 0);
+    Advisor::edge_t e01, e12;
+    std::tie(e01, std::ignore) = boost::edge(0, 1, g);
+    std::tie(e12, std::ignore) = boost::edge(1, 2, g);
+    g[e01].lock(1);
+    g[e01].lock(3);
+    g[e12].lock(1);
+    u.sample(g, 0, 0.5);
+
+    BOOST_REQUIRE_EQUAL(u.size(), 2);
+    BOOST_CHECK_EQUAL(u.edge(0, 0), 0);
+    BOOST_CHECK_EQUAL(u.wavelength(0, 1), 0);
+    BOOST_CHECK_EQUAL(u.time(1), 0.5);
+    BOOST_CHECK_EQUAL(u.edge(1, 0), 2);
+    BOOST_CHECK_EQUAL(u.edge(1, 1), 1);
+    BOOST_CHECK_EQUAL(u.wavelength(1, 1), 2);
+    BOOST_CHECK_EQUAL(u.wavelength(1, 2), 0);
+    BOOST_CHECK_EQUAL(u.wavelength(1, 3), 1);
+
+    std::ostringstream oss;
+    u.write_csv(oss);
+    BOOST_CHECK_EQUAL(oss.str(), "replication,time,0--1,1--2,wl1,wl2,wl3\n"
+                                 "0,0,0,0,0,0,0\n"
+                                 "0,0.5,2,1,2,0,1\n");
+
+    // The oldest samples are overwritten
+    g[e01].release(1);
+    u.sample(g, 1, 1);
+    u.sample(g, 1, 1.5);
+    BOOST_CHECK_EQUAL(u.samples(), 4);
+    BOOST_REQUIRE_EQUAL(u.size(), 3);
+    BOOST_CHECK_EQUAL(u.time(0), 0.5);
+    BOOST_CHECK_EQUAL(u.time(2), 1.5);
+    BOOST_CHECK_EQUAL(u.replication(2), 1);
+    BOOST_CHECK_EQUAL(u.edge(2, 0), 1);
+    BOOST_CHECK_EQUAL(u.wavelength(2, 1), 1);
+}
+
+BOOST_AUTO_TEST_CASE(utilization_binary_test) {
+    const std::string filename = "utilization_test.util";
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(2), g);
+    Utilization u{g, 1, 10};
+    u.sample(g, 0, 0);
+    u.sample(g, 0, 1);
+    BOOST_REQUIRE(u.write_binary(filename));
+
+    std::ifstream ifs{filename, std::ios::binary | std::ios::ate};
+    // Header, endpoints, then two samples of 16 + 4 * (1 + 2) bytes
+    BOOST_CHECK_EQUAL(static_cast<std::size_t>(ifs.tellg()),
+                      32 + 8 + 2 * (16 + 12));
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(utilization_simulator_test) {
+    Advisor::Graph g;
+    boost::add_edge(0, 1, Link(4), g);
+    boost::add_edge(1, 2, Link(4), g);
+    Advisor advisor{g, 3, 1, 42};
+    Simulator simulator{advisor, 1000, 100};
+
+    Utilization u{g, 0.25, 100000};
+    simulator.use_utilization(u, 3);
+    simulator.run();
+
+    BOOST_REQUIRE_GT(u.size(), 100);
+    BOOST_CHECK_EQUAL(u.time(0), 0);
+    BOOST_CHECK_EQUAL(u.replication(0), 3);
+    double mean = 0;
+    for (std::size_t i = 0; i < u.size(); i++) {
+        BOOST_CHECK_CLOSE(u.time(i), 0.25 * i, 1e-9);
+        unsigned by_wavelength = 0;
+        for (Link::wavelength_t wl = 1; wl <= 4; wl++) {
+            by_wavelength += u.wavelength(i, wl);
+        }
+        BOOST_CHECK_EQUAL(by_wavelength, u.edge(i, 0) + u.edge(i, 1));
+        BOOST_CHECK_LE(u.edge(i, 0), 4);
+        mean += u.edge(i, 0) + u.edge(i, 1);
+    }
+    // Some connections were carried
+    BOOST_CHECK_GT(mean, 0);
+}